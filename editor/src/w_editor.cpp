@@ -32,6 +32,7 @@ void EditorLayer::OnDetach() {
 
 void EditorLayer::OnUpdate(float_t delta_time) {
   scene_->OnUpdate(delta_time);
+  scene_->ExtractRenderPacket();
 }
 
 void EditorLayer::OnEvent(Event& event) {
@@ -156,6 +157,51 @@ void EditorLayer::OnBeginPresent() {
                         Engine::GetRenderer()->IsOnlySSAOPtr())) {
       Engine::GetRenderer()->SetRecreatePipeline(true);
     }
+    ImGui::Checkbox(PrefixLabel("Temporal SSAO").c_str(),
+                    Engine::GetRenderer()->IsSSAOTemporalEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Fused Lighting").c_str(),
+                    Engine::GetRenderer()->IsFusedLightingEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Static Passes").c_str(),
+                    Engine::GetRenderer()->IsStaticPassesEnabledPtr());
+    int antiAliasing = static_cast<int>(Engine::GetRenderer()->GetAntiAliasing());
+    if (ImGui::Combo(PrefixLabel("Anti Aliasing").c_str(), &antiAliasing,
+                     "None\0FXAA\0TAA\0")) {
+      Engine::GetRenderer()->SetAntiAliasing(
+          static_cast<AntiAliasing>(antiAliasing));
+    }
+    ImGui::Checkbox(PrefixLabel("Occlusion Culling").c_str(),
+                    Engine::GetRenderer()->IsOcclusionCullingEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Impostors").c_str(),
+                    Engine::GetRenderer()->IsImpostorsEnabledPtr());
+    ImGui::DragFloat(PrefixLabel("Impostor Screen Size").c_str(),
+                     Engine::GetRenderer()->GetImpostorScreenSizePtr(), 0.005f,
+                     0.0f, 1.0f);
+    ImGui::Checkbox(PrefixLabel("Mesh LODs").c_str(),
+                    Engine::GetRenderer()->IsMeshLodsEnabledPtr());
+    ImGui::DragFloat(PrefixLabel("LOD Screen Size").c_str(),
+                     Engine::GetRenderer()->GetLodScreenSizePtr(), 0.01f,
+                     0.0f, 4.0f);
+    ImGui::DragInt(PrefixLabel("Shadow LOD Bias").c_str(),
+                   Engine::GetRenderer()->GetShadowLodBiasPtr(), 0.1f, 0,
+                   WIESEL_MAX_MESH_LODS - 1);
+    ImGui::Checkbox(PrefixLabel("Async Compute").c_str(),
+                    Engine::GetRenderer()->IsAsyncComputeEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Shader Hot Reload").c_str(),
+                    Engine::GetRenderer()->IsShaderHotReloadEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Optimize Imported Meshes").c_str(),
+                    Engine::IsMeshOptimizationEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Generate Mesh LODs").c_str(),
+                    Engine::IsLodGenerationEnabledPtr());
+    ImGui::Checkbox(PrefixLabel("Dynamic Resolution").c_str(),
+                    Engine::GetRenderer()->IsDynamicResolutionEnabledPtr());
+    ImGui::DragFloat(PrefixLabel("Target Frame Time").c_str(),
+                     Engine::GetRenderer()
+                         ->GetResolutionScaleController()
+                         .GetTargetFrameTimePtr(),
+                     0.1f, 1.0f, 100.0f, "%.1f ms");
+    ImGui::Text("GPU %.2f ms, scale %.2f",
+                Engine::GetRenderer()->GetGPUFrameTime(),
+                Engine::GetRenderer()->GetRenderScale());
     if (ImGui::Button("Recreate Pipeline")) {
       Engine::GetRenderer()->SetRecreatePipeline(true);
     }
@@ -230,12 +276,24 @@ void EditorLayer::OnBeginPresent() {
   }
   ImGui::End();
   static bool viewportOpen = true;
-  if (ImGui::Begin("Viewport", &viewportOpen)) {
+#ifdef ID_BUFFER_PASS
+  uint32_t pickedId;
+  if (Engine::GetRenderer()->TakePickResult(pickedId)) {
+    // Clicking empty space clears the selection
+    auto picked = static_cast<entt::entity>(pickedId - 1);
+    has_selected_entity_ = pickedId != 0 && scene_->IsValid(picked);
+    if (has_selected_entity_) {
+      selected_entity_ = picked;
+    }
+  }
+#endif
+  if (ImGui::Begin("Viewport", &viewportOpen) &&
+      Engine::GetRenderer()->GetCameraData()) {
     ImTextureID desc =
-        reinterpret_cast<ImTextureID>(Engine::GetRenderer()->GetCameraData()->composite_output_descriptor->descriptor_set_);
+        reinterpret_cast<ImTextureID>(Engine::GetRenderer()->GetCameraData()->resources->composite_output_descriptor->descriptor_set_);
 
     ImVec2 avail = ImGui::GetContentRegionAvail();
-    float imageAspect = (float)Engine::GetRenderer()->GetCameraData()->composite_color_image->width_ / (float)Engine::GetRenderer()->GetCameraData()->composite_color_image->height_;
+    float imageAspect = (float)Engine::GetRenderer()->GetCameraData()->resources->composite_color_image->width_ / (float)Engine::GetRenderer()->GetCameraData()->resources->composite_color_image->height_;
     float availAspect = avail.x / avail.y;
 
     ImVec2 drawSize;
@@ -251,6 +309,15 @@ void EditorLayer::OnBeginPresent() {
     //ImGui::Image(desc, ImVec2(texture->m_Width, texture->m_Height));
 
     ImVec2 imageMin = ImGui::GetItemRectMin(); // top-left of last item (the image)
+#ifdef ID_BUFFER_PASS
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Left) && !ImGuizmo::IsOver()) {
+      ImVec2 mouse = ImGui::GetMousePos();
+      Engine::GetRenderer()->RequestPick(
+          Engine::GetRenderer()->GetCameraData()->resources,
+          {(mouse.x - imageMin.x) / drawSize.x,
+           (mouse.y - imageMin.y) / drawSize.y});
+    }
+#endif
 
     ImVec2 textPos = ImVec2(imageMin.x + 6, imageMin.y + 6);
     std::string fpsStr = fmt::format("FPS: {}", static_cast<int>(app_.GetFPS()));
@@ -260,7 +327,7 @@ void EditorLayer::OnBeginPresent() {
     ImGuizmo::SetRect(6, 6, drawSize.x, drawSize.y);
 
     if (has_selected_entity_) {
-      Ref<CameraData> cam = Engine::GetRenderer()->GetCameraData();
+      const CameraData* cam = Engine::GetRenderer()->GetCameraData();
       glm::mat4 view = cam->view_matrix;
       glm::mat4 proj = cam->projection;
       proj[1][1] *= -1;
@@ -0,0 +1,167 @@
+#version 450
+
+// Smallest local contrast treated as an edge, and the same relative to the brightest sample
+const float EDGE_THRESHOLD_MIN = 0.0312;
+const float EDGE_THRESHOLD_MAX = 0.125;
+// How much sub-pixel aliasing is removed, 0 keeps it all
+const float SUBPIXEL_QUALITY = 0.75;
+const int ITERATIONS = 12;
+// Step sizes along the edge, grows once the edge turns out to be long
+const float QUALITY[ITERATIONS] = float[](1.0, 1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0);
+
+layout (set = 0, binding = 0) uniform sampler2D samplerColor;
+
+layout(set = 1, binding = 1, std140) uniform Camera {
+    mat4 viewMatrix;
+    mat4 projection;
+    mat4 invProjection;
+    vec3 position;
+    float _pad0;
+    float near;
+    float far;
+    vec4 cascadeSplits;
+    int enableSSAO;
+    int frameIndex;
+    vec2 renderScale;
+    mat4 previousViewProjection;
+} cam;
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out vec4 outColor;
+
+vec2 texelSize;
+vec2 maxUV;
+
+vec4 sampleColor(vec2 uv) {
+    // Keeps the taps inside the rendered area when rendering below full resolution
+    return texture(samplerColor, clamp(uv, vec2(0.0), maxUV));
+}
+
+// Roughly perceptual, the lighting output is linear
+float luma(vec3 color) {
+    return sqrt(dot(color, vec3(0.299, 0.587, 0.114)));
+}
+
+float lumaAt(vec2 uv, float x, float y) {
+    return luma(sampleColor(uv + vec2(x, y) * texelSize).rgb);
+}
+
+void main() {
+    texelSize = 1.0 / vec2(textureSize(samplerColor, 0));
+    maxUV = cam.renderScale - 0.5 * texelSize;
+    vec2 uv = inUV * cam.renderScale;
+
+    vec4 center = sampleColor(uv);
+    float lumaCenter = luma(center.rgb);
+    float lumaN = lumaAt(uv, 0.0, 1.0);
+    float lumaS = lumaAt(uv, 0.0, -1.0);
+    float lumaE = lumaAt(uv, 1.0, 0.0);
+    float lumaW = lumaAt(uv, -1.0, 0.0);
+
+    float lumaMin = min(lumaCenter, min(min(lumaN, lumaS), min(lumaE, lumaW)));
+    float lumaMax = max(lumaCenter, max(max(lumaN, lumaS), max(lumaE, lumaW)));
+    float lumaRange = lumaMax - lumaMin;
+    if (lumaRange < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD_MAX)) {
+        outColor = center;
+        return;
+    }
+
+    float lumaNE = lumaAt(uv, 1.0, 1.0);
+    float lumaNW = lumaAt(uv, -1.0, 1.0);
+    float lumaSE = lumaAt(uv, 1.0, -1.0);
+    float lumaSW = lumaAt(uv, -1.0, -1.0);
+    float lumaNS = lumaN + lumaS;
+    float lumaEW = lumaE + lumaW;
+    float lumaNCorners = lumaNE + lumaNW;
+    float lumaSCorners = lumaSE + lumaSW;
+    float lumaECorners = lumaNE + lumaSE;
+    float lumaWCorners = lumaNW + lumaSW;
+
+    // Picks whether the edge runs horizontally or vertically
+    float edgeHorizontal = abs(-2.0 * lumaW + lumaWCorners) +
+                           abs(-2.0 * lumaCenter + lumaNS) * 2.0 +
+                           abs(-2.0 * lumaE + lumaECorners);
+    float edgeVertical = abs(-2.0 * lumaN + lumaNCorners) +
+                         abs(-2.0 * lumaCenter + lumaEW) * 2.0 +
+                         abs(-2.0 * lumaS + lumaSCorners);
+    bool horizontal = edgeHorizontal >= edgeVertical;
+
+    // Side of the pixel the edge is on
+    float luma1 = horizontal ? lumaS : lumaW;
+    float luma2 = horizontal ? lumaN : lumaE;
+    float gradient1 = luma1 - lumaCenter;
+    float gradient2 = luma2 - lumaCenter;
+    bool steepest1 = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+    float stepLength = horizontal ? texelSize.y : texelSize.x;
+    float lumaLocalAverage;
+    if (steepest1) {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5 * (luma1 + lumaCenter);
+    } else {
+        lumaLocalAverage = 0.5 * (luma2 + lumaCenter);
+    }
+
+    // Walks both ways along the edge, half a pixel towards it, until the contrast ends
+    vec2 edgeUV = uv;
+    if (horizontal) {
+        edgeUV.y += stepLength * 0.5;
+    } else {
+        edgeUV.x += stepLength * 0.5;
+    }
+    vec2 offset = horizontal ? vec2(texelSize.x, 0.0) : vec2(0.0, texelSize.y);
+    vec2 uv1 = edgeUV - offset;
+    vec2 uv2 = edgeUV + offset;
+    float lumaEnd1 = luma(sampleColor(uv1).rgb) - lumaLocalAverage;
+    float lumaEnd2 = luma(sampleColor(uv2).rgb) - lumaLocalAverage;
+    bool reached1 = abs(lumaEnd1) >= gradientScaled;
+    bool reached2 = abs(lumaEnd2) >= gradientScaled;
+    if (!reached1) {
+        uv1 -= offset;
+    }
+    if (!reached2) {
+        uv2 += offset;
+    }
+    for (int i = 2; i < ITERATIONS && !(reached1 && reached2); i++) {
+        if (!reached1) {
+            lumaEnd1 = luma(sampleColor(uv1).rgb) - lumaLocalAverage;
+            reached1 = abs(lumaEnd1) >= gradientScaled;
+            if (!reached1) {
+                uv1 -= offset * QUALITY[i];
+            }
+        }
+        if (!reached2) {
+            lumaEnd2 = luma(sampleColor(uv2).rgb) - lumaLocalAverage;
+            reached2 = abs(lumaEnd2) >= gradientScaled;
+            if (!reached2) {
+                uv2 += offset * QUALITY[i];
+            }
+        }
+    }
+
+    float distance1 = horizontal ? (uv.x - uv1.x) : (uv.y - uv1.y);
+    float distance2 = horizontal ? (uv2.x - uv.x) : (uv2.y - uv.y);
+    bool direction1 = distance1 < distance2;
+    float distanceFinal = min(distance1, distance2);
+    float edgeLength = distance1 + distance2;
+    float pixelOffset = -distanceFinal / edgeLength + 0.5;
+    // Only blend when the closer end of the edge goes the same way as the center
+    bool centerSmaller = lumaCenter < lumaLocalAverage;
+    bool correctVariation = ((direction1 ? lumaEnd1 : lumaEnd2) < 0.0) != centerSmaller;
+    float finalOffset = correctVariation ? pixelOffset : 0.0;
+
+    // Sub-pixel aliasing, single bright or dark pixels
+    float lumaAverage = (1.0 / 12.0) * (2.0 * (lumaNS + lumaEW) + lumaWCorners + lumaECorners);
+    float subPixelOffset = clamp(abs(lumaAverage - lumaCenter) / lumaRange, 0.0, 1.0);
+    subPixelOffset = (-2.0 * subPixelOffset + 3.0) * subPixelOffset * subPixelOffset;
+    finalOffset = max(finalOffset, subPixelOffset * subPixelOffset * SUBPIXEL_QUALITY);
+
+    vec2 finalUV = uv;
+    if (horizontal) {
+        finalUV.y += finalOffset * stepLength;
+    } else {
+        finalUV.x += finalOffset * stepLength;
+    }
+    outColor = vec4(sampleColor(finalUV).rgb, center.a);
+}
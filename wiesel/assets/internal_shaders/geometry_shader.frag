@@ -1,12 +1,12 @@
 #version 450
 
-uint kVertexFlagHasTexture = 1 << 0;
-uint kVertexFlagHasNormalMap = 1 << 1;
-uint kVertexFlagHasSpecularMap = 1 << 2;
-uint kVertexFlagHasHeightMap = 1 << 3;
-uint kVertexFlagHasAlbedoMap = 1 << 4;
-uint kVertexFlagHasRoughnessMap = 1 << 5;
-uint kVertexFlagHasMetallicMap = 1 << 6;
+uint kMaterialFlagHasTexture = 1 << 0;
+uint kMaterialFlagHasNormalMap = 1 << 1;
+uint kMaterialFlagHasSpecularMap = 1 << 2;
+uint kMaterialFlagHasHeightMap = 1 << 3;
+uint kMaterialFlagHasAlbedoMap = 1 << 4;
+uint kMaterialFlagHasRoughnessMap = 1 << 5;
+uint kMaterialFlagHasMetallicMap = 1 << 6;
 
 struct LightBase {
     vec3 position;
@@ -49,6 +49,11 @@ layout (set = 1, binding = 1, std140) uniform Camera {
     vec4 cascadeSplits;
 } cam;
 
+// Same for every fragment of a draw, the branches on it don't diverge
+layout(push_constant) uniform Push {
+    uint materialFlags;
+} push;
+
 layout(set = 0, binding = 1) uniform sampler2D baseTexture; // diffuse
 layout(set = 0, binding = 2) uniform sampler2D normalMap;
 layout(set = 0, binding = 3) uniform sampler2D specularMap;
@@ -63,7 +68,6 @@ layout(location = 2) in vec2 inUV;
 layout(location = 3) in vec3 inNormal;
 layout(location = 4) in vec3 inTangent;
 layout(location = 5) in vec3 inBiTangent;
-layout(location = 6) in flat uint inFlags;
 layout(location = 7) in vec3 inViewDir;
 layout(location = 8) in vec3 inViewPos;
 layout(location = 9) in mat3 inTBN;
@@ -78,7 +82,7 @@ layout(location = 5) out vec4 outMaterial;
 
 vec3 getSurfaceNormal() {
     vec3 normal;
-    if ((inFlags & kVertexFlagHasNormalMap) > 0) {
+    if ((push.materialFlags & kMaterialFlagHasNormalMap) > 0) {
         vec3 localNormal = 2.0 * texture(normalMap, inUV).rgb - 1.0;
         normal = normalize(inTBN * localNormal);
     } else {
@@ -95,7 +99,7 @@ float linearDepth(float depth) {
 
 void main() {
     vec4 baseColor;
-    if ((inFlags & kVertexFlagHasTexture) > 0) {
+    if ((push.materialFlags & kMaterialFlagHasTexture) > 0) {
         baseColor = texture(baseTexture, inUV);
     } else {
         baseColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
@@ -105,19 +109,19 @@ void main() {
     }
 
     float specular;
-    if ((inFlags & kVertexFlagHasSpecularMap) > 0) {
+    if ((push.materialFlags & kMaterialFlagHasSpecularMap) > 0) {
         specular = texture(specularMap, inUV).r;
     } else {
         specular = 0.0f;
     }
     float roughness;
-    if ((inFlags & kVertexFlagHasRoughnessMap) > 0) {
+    if ((push.materialFlags & kMaterialFlagHasRoughnessMap) > 0) {
         roughness = texture(roughnessMap, inUV).r;
     } else {
         roughness = 0.0f;
     }
     float metallic;
-    if ((inFlags & kVertexFlagHasMetallicMap) > 0) {
+    if ((push.materialFlags & kMaterialFlagHasMetallicMap) > 0) {
         metallic = texture(metallicMap, inUV).r;
     } else {
         metallic = 0.0f;
@@ -16,13 +16,12 @@ layout(set = 1, binding = 1, std140) uniform Camera {
     vec4 cascadeSplits;
 } cam;
 
+// PackedVertex3D, normal and tangent arrive as [0, 1] unorm
 layout(location = 0) in vec3 inVertexPosition;
 layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inUV;
-layout(location = 3) in vec3 inVertexNormal;
-layout(location = 4) in vec3 inTangent;
-layout(location = 5) in vec3 inBiTangent;
-layout(location = 6) in uint inFlags;
+layout(location = 3) in vec4 inVertexNormal;
+layout(location = 4) in vec4 inTangent;
 
 layout(location = 0) out vec3 outWorldPos;
 layout(location = 1) out vec3 outColor;
@@ -30,7 +29,6 @@ layout(location = 2) out vec2 outUV;
 layout(location = 3) out vec3 outNormal;
 layout(location = 4) out vec3 outTangent;
 layout(location = 5) out vec3 outBiTangent;
-layout(location = 6) out uint outFlags;
 layout(location = 7) out vec3 outViewDir;
 layout(location = 8) out vec3 outViewPos; // view-space pos
 layout(location = 9) out mat3 outTBN;
@@ -44,13 +42,15 @@ void main() {
     vec4 viewPos4   = cam.viewMatrix * worldPos4;
     outViewPos      = viewPos4.xyz;
 
-    outNormal       = mat3(modelMatrix) * inVertexNormal;
-    outTangent      = mat3(modelMatrix) * inTangent;
-    outBiTangent    = mat3(modelMatrix) * inBiTangent;
+    vec3 normal     = inVertexNormal.xyz * 2.0 - 1.0;
+    vec3 tangent    = inTangent.xyz * 2.0 - 1.0;
+    vec3 biTangent  = cross(normal, tangent) * (inTangent.w > 0.5 ? 1.0 : -1.0);
+    outNormal       = mat3(modelMatrix) * normal;
+    outTangent      = mat3(modelMatrix) * tangent;
+    outBiTangent    = mat3(modelMatrix) * biTangent;
     outTBN          = mat3(outTangent, outBiTangent, outNormal);
     outColor = inColor;
     outUV = inUV;
-    outFlags = inFlags;
     outViewDir = normalize(cam.position - outWorldPos);
 
     gl_Position    = cam.projection * viewPos4;
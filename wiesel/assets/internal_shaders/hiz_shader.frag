@@ -0,0 +1,29 @@
+#version 450
+
+// Should be same as WIESEL_HIZ_DOWNSAMPLE
+const int HIZ_DOWNSAMPLE = 8;
+const float FAR_DEPTH = 3.402823466e+38;
+
+layout (set = 0, binding = 0) uniform sampler2D samplerDepth;
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out float outDepth;
+
+void main() {
+    ivec2 size = textureSize(samplerDepth, 0);
+    ivec2 base = ivec2(gl_FragCoord.xy) * HIZ_DOWNSAMPLE;
+    float result = 0.0;
+    for (int y = 0; y < HIZ_DOWNSAMPLE; y++) {
+        for (int x = 0; x < HIZ_DOWNSAMPLE; x++) {
+            ivec2 coord = min(base + ivec2(x, y), size - 1);
+            float depth = texelFetch(samplerDepth, coord, 0).r;
+            // Geometry pass clears to 0, nothing was drawn there
+            if (depth <= 0.0) {
+                depth = FAR_DEPTH;
+            }
+            result = max(result, depth);
+        }
+    }
+    outDepth = result;
+}
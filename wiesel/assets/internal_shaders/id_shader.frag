@@ -0,0 +1,23 @@
+#version 450
+
+uint kMaterialFlagHasTexture = 1 << 0;
+
+layout(set = 0, binding = 1) uniform sampler2D baseTexture;
+
+layout(push_constant) uniform Push {
+    // Entity id plus one, 0 is cleared where nothing is drawn
+    uint id;
+    uint materialFlags;
+} push;
+
+layout(location = 2) in vec2 inUV;
+
+layout(location = 0) out uint outID;
+
+void main() {
+    // Same cutout as the geometry pass so the pick matches what is visible
+    if ((push.materialFlags & kMaterialFlagHasTexture) > 0 && texture(baseTexture, inUV).a < 0.5) {
+        discard;
+    }
+    outID = push.id;
+}
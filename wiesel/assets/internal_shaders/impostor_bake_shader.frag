@@ -0,0 +1,45 @@
+#version 450
+
+uint kMaterialFlagHasTexture = 1 << 0;
+uint kMaterialFlagHasNormalMap = 1 << 1;
+
+layout(push_constant) uniform Push {
+    mat4 viewProjection;
+    uint materialFlags;
+} push;
+
+layout(set = 0, binding = 1) uniform sampler2D baseTexture; // diffuse
+layout(set = 0, binding = 2) uniform sampler2D normalMap;
+
+layout(location = 0) in vec3 inColor;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) in vec3 inNormal;
+layout(location = 4) in mat3 inTBN;
+
+layout(location = 0) out vec4 outAlbedo;
+layout(location = 1) out vec4 outNormalDepth;
+
+void main() {
+    vec4 baseColor;
+    if ((push.materialFlags & kMaterialFlagHasTexture) > 0) {
+        baseColor = texture(baseTexture, inUV);
+    } else {
+        baseColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    }
+    if (baseColor.a < 0.5) {
+        discard;
+    }
+
+    vec3 normal;
+    if ((push.materialFlags & kMaterialFlagHasNormalMap) > 0) {
+        vec3 localNormal = 2.0 * texture(normalMap, inUV).rgb - 1.0;
+        normal = normalize(inTBN * localNormal);
+    } else {
+        normal = normalize(inNormal);
+    }
+
+    // Alpha is coverage, the atlas is cleared to zero
+    outAlbedo = vec4(inColor * baseColor.rgb, 1.0);
+    // The orthographic projection maps the bounding sphere to [0, 1] depth
+    outNormalDepth = vec4(normal * 0.5 + 0.5, gl_FragCoord.z);
+}
@@ -0,0 +1,31 @@
+#version 450
+
+layout(push_constant) uniform Push {
+    mat4 viewProjection;
+    uint materialFlags;
+};
+
+// PackedVertex3D, normal and tangent arrive as [0, 1] unorm
+layout(location = 0) in vec3 inVertexPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inUV;
+layout(location = 3) in vec4 inVertexNormal;
+layout(location = 4) in vec4 inTangent;
+
+layout(location = 0) out vec3 outColor;
+layout(location = 1) out vec2 outUV;
+layout(location = 2) out vec3 outNormal;
+layout(location = 4) out mat3 outTBN;
+
+// Baked in object space, the model matrix is applied when the impostor is drawn
+void main() {
+    outColor = inColor;
+    outUV = inUV;
+    vec3 normal = inVertexNormal.xyz * 2.0 - 1.0;
+    vec3 tangent = inTangent.xyz * 2.0 - 1.0;
+    vec3 biTangent = cross(normal, tangent) * (inTangent.w > 0.5 ? 1.0 : -1.0);
+    outNormal = normal;
+    outTBN = mat3(tangent, biTangent, normal);
+
+    gl_Position = viewProjection * vec4(inVertexPosition, 1.0);
+}
@@ -0,0 +1,56 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform sampler2D albedoAtlas;
+layout(set = 0, binding = 1) uniform sampler2D normalDepthAtlas;
+
+layout(set = 1, binding = 1, std140) uniform Camera {
+    mat4 viewMatrix;
+    mat4 projection;
+    mat4 invProjection;
+    vec3 position;
+    float _pad0;
+    float near;
+    float far;
+    vec4 cascadeSplits;
+} cam;
+
+layout(location = 0) in vec2 inUV;
+layout(location = 1) in vec3 inWorldPos;
+layout(location = 2) in vec3 inDepthAxis;
+layout(location = 3) in flat mat3 inNormalMatrix;
+
+layout(location = 0) out vec4 outViewPos;
+layout(location = 1) out vec4 outWorldPos;
+layout(location = 2) out float outDepth;
+layout(location = 3) out vec4 outNormal;
+layout(location = 4) out vec4 outAlbedo;
+layout(location = 5) out vec4 outMaterial;
+
+float linearDepth(float depth) {
+    float z = depth * 2.0f - 1.0f;
+    return (2.0f * cam.near * cam.far) / (cam.far + cam.near - z * (cam.far - cam.near));
+}
+
+void main() {
+    vec4 albedo = texture(albedoAtlas, inUV);
+    if (albedo.a < 0.5) {
+        discard;
+    }
+    vec4 normalDepth = texture(normalDepthAtlas, inUV);
+    vec3 normal = normalize(inNormalMatrix * (normalDepth.rgb * 2.0 - 1.0));
+
+    // The quad sits at the center of the bounding sphere, at baked depth 0.5.
+    // Moving the fragment to the baked surface lets the impostor intersect
+    // and get lit like the model would.
+    vec3 worldPos = inWorldPos + inDepthAxis * (normalDepth.a - 0.5);
+    vec4 viewPos = cam.viewMatrix * vec4(worldPos, 1.0);
+    vec4 clipPos = cam.projection * viewPos;
+    gl_FragDepth = clipPos.z / clipPos.w;
+
+    outViewPos = viewPos;
+    outDepth = linearDepth(gl_FragDepth);
+    outWorldPos = vec4(worldPos, 1.0);
+    outNormal = vec4(normal, 1.0);
+    outAlbedo = vec4(albedo.rgb, 1.0);
+    outMaterial = vec4(0.0);
+}
@@ -0,0 +1,81 @@
+#version 450
+
+// Has to match WIESEL_IMPOSTOR_GRID
+const float kImpostorGrid = 8.0;
+
+layout(set = 1, binding = 1, std140) uniform Camera {
+    mat4 viewMatrix;
+    mat4 projection;
+    mat4 invProjection;
+    vec3 position;
+    float _pad0;
+    float near;
+    float far;
+    vec4 cascadeSplits;
+} cam;
+
+layout(location = 0) in mat4 inModelMatrix;
+layout(location = 4) in vec4 inBounds;
+
+layout(location = 0) out vec2 outUV;
+layout(location = 1) out vec3 outWorldPos;
+layout(location = 2) out vec3 outDepthAxis;
+layout(location = 3) out mat3 outNormalMatrix;
+
+const vec2 kCorners[6] = vec2[](
+    vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0),
+    vec2(1.0, 1.0), vec2(-1.0, 1.0), vec2(-1.0, -1.0)
+);
+
+vec2 signNotZero(vec2 v) {
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// Same mapping as OctahedralEncode and OctahedralDecode, y is up
+vec2 octahedralEncode(vec3 dir) {
+    dir /= abs(dir.x) + abs(dir.y) + abs(dir.z);
+    vec2 p = dir.xz;
+    if (dir.y < 0.0) {
+        p = (1.0 - abs(p.yx)) * signNotZero(p);
+    }
+    return p * 0.5 + 0.5;
+}
+
+vec3 octahedralDecode(vec2 uv) {
+    vec2 p = uv * 2.0 - 1.0;
+    vec3 dir = vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+    if (dir.y < 0.0) {
+        dir.xz = (1.0 - abs(dir.zx)) * signNotZero(dir.xz);
+    }
+    return normalize(dir);
+}
+
+void main() {
+    vec3 center = inBounds.xyz;
+    float radius = inBounds.w;
+    mat3 model = mat3(inModelMatrix);
+    vec3 worldCenter = (inModelMatrix * vec4(center, 1.0)).xyz;
+
+    // Picks the baked view closest to the direction of the camera
+    vec3 toCamera = normalize(inverse(model) * (cam.position - worldCenter));
+    vec2 cell = clamp(floor(octahedralEncode(toCamera) * kImpostorGrid),
+                      0.0, kImpostorGrid - 1.0);
+    vec3 viewDir = octahedralDecode((cell + 0.5) / kImpostorGrid);
+
+    // Same basis the view was baked with, see Renderer::CreateImpostor
+    vec3 up = abs(viewDir.y) > 0.99 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 side = normalize(cross(-viewDir, up));
+    up = cross(side, -viewDir);
+
+    vec2 corner = kCorners[gl_VertexIndex];
+    vec3 position = center + (side * corner.x + up * corner.y) * radius;
+    vec4 worldPos = inModelMatrix * vec4(position, 1.0);
+
+    outUV = (cell + vec2(0.5 + 0.5 * corner.x, 0.5 - 0.5 * corner.y)) / kImpostorGrid;
+    outWorldPos = worldPos.xyz;
+    // Front to back of the bounding sphere along the baked view
+    outDepthAxis = model * (-viewDir * 2.0 * radius);
+    outNormalMatrix = transpose(inverse(model));
+
+    gl_Position = cam.projection * cam.viewMatrix * worldPos;
+}
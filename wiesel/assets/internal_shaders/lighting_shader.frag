@@ -1,7 +1,19 @@
 #version 450
 
 #define SHADOW_MAP_CASCADE_COUNT 4
-
+// Should be same as WIESEL_CLUSTER_GRID_*
+#define CLUSTER_GRID_X 16
+#define CLUSTER_GRID_Y 9
+#define CLUSTER_GRID_Z 24
+
+#ifdef INPUT_ATTACHMENTS
+// Second subpass of the fused geometry lighting pass, SSAO is never enabled here
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput inputViewPos;
+layout(input_attachment_index = 1, set = 0, binding = 1) uniform subpassInput inputWorldPos;
+layout(input_attachment_index = 2, set = 0, binding = 2) uniform subpassInput inputNormal;
+layout(input_attachment_index = 3, set = 0, binding = 3) uniform subpassInput inputAlbedo;
+layout(input_attachment_index = 4, set = 0, binding = 4) uniform subpassInput inputMaterial;
+#else
 layout(set = 0, binding = 0) uniform sampler2D samplerViewPos;
 layout(set = 0, binding = 1) uniform sampler2D samplerWorldPos;
 layout(set = 0, binding = 2) uniform sampler2D samplerDepth;
@@ -9,6 +21,7 @@ layout(set = 0, binding = 3) uniform sampler2D samplerNormal;
 layout(set = 0, binding = 4) uniform sampler2D samplerAlbedo;
 layout(set = 0, binding = 5) uniform sampler2D samplerMaterial;
 layout(set = 1, binding = 0) uniform sampler2D samplerSSAO;
+#endif
 
 struct LightBase {
     vec3 position;
@@ -33,6 +46,7 @@ struct LightPoint {
     float constant;
     float linear;
     float exp;
+    float radius;
 };
 
 const int MAX_LIGHTS = 16;
@@ -40,7 +54,6 @@ layout(set = 2, binding = 0) uniform LightsBufferObject {
     int directLightCount;
     int pointLightCount;
     LightDirect directLights[MAX_LIGHTS];
-    LightPoint pointLights[MAX_LIGHTS];
 } lights;
 
 layout(set = 2, binding = 1, std140) uniform Camera {
@@ -53,6 +66,8 @@ layout(set = 2, binding = 1, std140) uniform Camera {
     float far;
     vec4 cascadeSplits;
     int enableSSAO;
+    int frameIndex;
+    vec2 renderScale;
 } cam;
 
 layout(set = 2, binding = 2) uniform ShadowMapMatrices {
@@ -61,7 +76,21 @@ layout(set = 2, binding = 2) uniform ShadowMapMatrices {
 } shadowMatrices;
 
 
-layout(set = 2, binding = 3) uniform sampler2DArray shadowMap;
+// Compare sampler, texture() returns the filtered lit fraction
+layout(set = 2, binding = 3) uniform sampler2DArrayShadow shadowMap;
+
+layout(set = 2, binding = 4, std430) readonly buffer PointLights {
+    LightPoint pointLights[];
+};
+
+// x = offset into lightIndices, y = light count
+layout(set = 2, binding = 5, std430) readonly buffer LightClusters {
+    uvec2 clusters[];
+};
+
+layout(set = 2, binding = 6, std430) readonly buffer LightIndices {
+    uint lightIndices[];
+};
 
 layout(location = 0) in vec2 inUV;
 
@@ -75,6 +104,24 @@ const mat4 biasMat = mat4(
 0.5, 0.5, 0.0, 1.0
 );
 
+// Poisson disk in texel units, each tap is a hardware filtered 2x2 comparison
+const int SHADOW_SAMPLE_COUNT = 8;
+const vec2 shadowPoissonDisk[SHADOW_SAMPLE_COUNT] = vec2[](
+    vec2(-0.326212, -0.405810),
+    vec2(-0.840144, -0.073580),
+    vec2(-0.695914, 0.457137),
+    vec2(-0.203345, 0.620716),
+    vec2(0.962340, -0.194983),
+    vec2(0.473434, -0.480026),
+    vec2(0.519456, 0.767022),
+    vec2(0.185461, -0.893124)
+);
+const float SHADOW_FILTER_RADIUS = 1.5;
+
+float interleavedGradientNoise(vec2 position) {
+    return fract(52.9829189 * fract(dot(position, vec2(0.06711056, 0.00583715))));
+}
+
 float calculateShadow(vec4 shadowCoord, uint cascadeIndex, float ambient, vec3 normal, vec3 lightDir) {
     shadowCoord /= shadowCoord.w;
 
@@ -85,67 +132,77 @@ float calculateShadow(vec4 shadowCoord, uint cascadeIndex, float ambient, vec3 n
     }
 
     float bias = max(0.005 * dot(normal, -lightDir), 0.0005);
-    ivec2 smSize = textureSize(shadowMap, 0).xy;
-    vec2 texelSize = 1.0 / vec2(smSize);
-    #ifdef USE_GATHER
-    // gather four neighbours’ depth in one call
-    vec4 depths = textureGather(shadowMap, vec3(shadowCoord.xy, cascadeIndex));
-    // compare each
-    float sum = 0.0;
-    sum += (shadowCoord.z - bias > depths.x) ? 1.0 - ambient : 0.0;
-    sum += (shadowCoord.z - bias > depths.y) ? 1.0 - ambient : 0.0;
-    sum += (shadowCoord.z - bias > depths.z) ? 1.0 - ambient : 0.0;
-    sum += (shadowCoord.z - bias > depths.w) ? 1.0 - ambient : 0.0;
-    return 1.0 - sum * 0.25;
-    #else
-    float shadow = 0.0;
-    int count  = 0;
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            vec2 off = shadowCoord.xy + vec2(x, y) * texelSize;
-            float d = texture(shadowMap, vec3(off, cascadeIndex)).r;
-            shadow += (shadowCoord.z - bias > d) ? 1.0 - ambient : 0.0;
-            count++;
-        }
+    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0).xy);
+    // Rotate the disk per pixel so the few taps don't band
+    float angle = interleavedGradientNoise(gl_FragCoord.xy) * 6.2831853;
+    mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+    float lit = 0.0;
+    for (int i = 0; i < SHADOW_SAMPLE_COUNT; i++) {
+        vec2 offset = rotation * shadowPoissonDisk[i] * SHADOW_FILTER_RADIUS * texelSize;
+        lit += texture(shadowMap, vec4(shadowCoord.xy + offset, float(cascadeIndex), shadowCoord.z - bias));
     }
-    return 1.0 - (shadow / float(count));
-    #endif
-    /*
-    float shadow = 0.0;
-    int count = 0;
-
-    vec2 texelSize = 1.0 / vec2(textureSize(shadowMap, 0));
-    for (int x = -1; x <= 1; ++x) {
-        for (int y = -1; y <= 1; ++y) {
-            vec2 pcfOffset = vec2(x, y) * texelSize;
-            float pcfDepth = texture(shadowMap, vec3(shadowCoord.xy + pcfOffset, cascadeIndex)).r;
-            shadow += (shadowCoord.z - bias > pcfDepth) ? 1.0 - ambient : 0.0;
-            count++;
+    lit /= float(SHADOW_SAMPLE_COUNT);
+    return 1.0 - (1.0 - lit) * (1.0 - ambient);
+}
+
+#ifndef INPUT_ATTACHMENTS
+// Half resolution SSAO stores (occlusion, linear depth), taps with a depth
+// far from this pixel's are weighted down so occlusion doesn't bleed over edges.
+float upsampleSSAO(vec2 uv, float depth) {
+    vec2 size = vec2(textureSize(samplerSSAO, 0));
+    vec2 coord = uv * size - 0.5;
+    ivec2 base = ivec2(floor(coord));
+    vec2 f = fract(coord);
+    float sum = 0.0;
+    float wsum = 0.0;
+    for (int y = 0; y < 2; y++) {
+        for (int x = 0; x < 2; x++) {
+            ivec2 texel = clamp(base + ivec2(x, y), ivec2(0), ivec2(size * cam.renderScale) - 1);
+            vec2 s = texelFetch(samplerSSAO, texel, 0).rg;
+            float bilinear = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y);
+            float w = bilinear / (abs(s.g - depth) + 0.0001);
+            sum += s.r * w;
+            wsum += w;
         }
     }
-
-    shadow /= count;
-    return 1.0 - shadow;*/
+    return wsum > 0.0 ? sum / wsum : 1.0;
 }
+#endif
 
 void main() {
-    vec4 viewData = texture(samplerViewPos, inUV);
-    vec3 viewPos = viewData.rgb;
-    float linearDepth = viewData.w;
-
-    vec3 worldPos = texture(samplerWorldPos, inUV).rgb;
-    vec3 normal = normalize(texture(samplerNormal, inUV).rgb * 2.0 - 1.0);
-    vec4 albedo = texture(samplerAlbedo, inUV);
+    // Deferred passes only fill the top left part of the attachments
+    // when rendering below full resolution
+#ifdef INPUT_ATTACHMENTS
+    vec4 albedo = subpassLoad(inputAlbedo);
+#else
+    vec2 uv = inUV * cam.renderScale;
+    vec4 albedo = texture(samplerAlbedo, uv);
+#endif
     if (albedo.a < 0.5) {
         discard;
     }
-    vec3 material = texture(samplerMaterial, inUV).rgb; // specular, roughnes, metallic
+#ifdef INPUT_ATTACHMENTS
+    vec4 viewData = subpassLoad(inputViewPos);
+    vec3 worldPos = subpassLoad(inputWorldPos).rgb;
+    vec3 normal = normalize(subpassLoad(inputNormal).rgb * 2.0 - 1.0);
+    vec3 material = subpassLoad(inputMaterial).rgb; // specular, roughnes, metallic
+    float ambientOcclusion = 1.0f;
+#else
+    vec4 viewData = texture(samplerViewPos, uv);
+    vec3 worldPos = texture(samplerWorldPos, uv).rgb;
+    vec3 normal = normalize(texture(samplerNormal, uv).rgb * 2.0 - 1.0);
+    vec3 material = texture(samplerMaterial, uv).rgb; // specular, roughnes, metallic
     float ambientOcclusion;
-    if (cam.enableSSAO != 0) {
-        ambientOcclusion = texture(samplerSSAO, inUV).r;
+    if (cam.enableSSAO == 2) {
+        ambientOcclusion = upsampleSSAO(uv, texture(samplerDepth, uv).r);
+    } else if (cam.enableSSAO != 0) {
+        ambientOcclusion = texture(samplerSSAO, uv).r;
     } else {
         ambientOcclusion = 1.0f;
     }
+#endif
+    vec3 viewPos = viewData.rgb;
+    float linearDepth = viewData.w;
     vec3 viewDir = normalize(cam.position - viewPos);
 
     vec3 result = vec3(0.0f, 0.0f, 0.0f);
@@ -179,11 +236,20 @@ void main() {
         result += (lightAmbient * albedo.rgb * ambientOcclusion + lightDiffuse * albedo.rgb + lightSpecular * specularColor) * light.base.color * light.base.density;
         break;
     }
-    for (int i = 0; i < lights.pointLightCount; i++) {
-        LightPoint light = lights.pointLights[i];
+    // Exponential depth slices, same as LightClusterGrid::Build
+    float viewDepth = max(-viewPos.z, cam.near);
+    uint slice = uint(log(viewDepth / cam.near) / log(cam.far / cam.near) * float(CLUSTER_GRID_Z));
+    uvec3 clusterCoord = min(uvec3(uvec2(inUV * vec2(CLUSTER_GRID_X, CLUSTER_GRID_Y)), slice),
+                             uvec3(CLUSTER_GRID_X - 1, CLUSTER_GRID_Y - 1, CLUSTER_GRID_Z - 1));
+    uvec2 cluster = clusters[clusterCoord.x + clusterCoord.y * CLUSTER_GRID_X + clusterCoord.z * CLUSTER_GRID_X * CLUSTER_GRID_Y];
+    for (uint i = 0; i < cluster.y; i++) {
+        LightPoint light = pointLights[lightIndices[cluster.x + i]];
         // Calculate light direction and distance
-        vec3 lightDir = normalize(light.base.position - worldPos);
         float distance = length(light.base.position - worldPos);
+        if (distance > light.radius) {
+            continue;
+        }
+        vec3 lightDir = normalize(light.base.position - worldPos);
         float attenuation = 1.0 / (light.constant + light.linear * distance + light.exp * distance * distance);
 
         float lightAmbient = light.base.ambient;
@@ -6,6 +6,18 @@ layout(location = 0) in vec2 fragUV;
 
 layout(location = 0) out vec4 fragColor;
 
+#ifdef RENDER_SCALE
+// Source only covers the top left part of the texture, see Renderer::render_size_
+layout(push_constant) uniform PushConstants {
+    vec2 uvScale;
+} pc;
+#endif
+
 void main() {
+#ifdef RENDER_SCALE
+    vec2 uv = min(fragUV * pc.uvScale, pc.uvScale - 0.5 / vec2(textureSize(texSampler, 0)));
+    fragColor = texture(texSampler, uv);
+#else
     fragColor = texture(texSampler, fragUV);
+#endif
 }
@@ -3,6 +3,20 @@
 layout (set = 0, binding = 0) uniform sampler2D samplerSSAO;
 layout (set = 0, binding = 1) uniform sampler2D samplerDepth;
 
+layout(set = 1, binding = 1, std140) uniform Camera {
+    mat4 viewMatrix;
+    mat4 projection;
+    mat4 invProjection;
+    vec3 position;
+    float _pad0;
+    float near;
+    float far;
+    vec4 cascadeSplits;
+    int enableSSAO;
+    int frameIndex;
+    vec2 renderScale;
+} cam;
+
 layout (location = 0) in vec2 inUV;
 
 layout (location = 0) out float outFragColor;
@@ -23,7 +37,9 @@ void main() {
     outFragColor = result / (float(n));*/
 
     // Edge aware Bilateral blur
-    float centerDepth = texture(samplerDepth, inUV).r;
+    // Inputs only cover the top left part when rendering below full resolution
+    vec2 uv = inUV * cam.renderScale;
+    float centerDepth = texture(samplerDepth, uv).r;
     float sum = 0, wsum = 0;
     for (int i = -4; i <= 4; i++) {
         #ifdef BLUR_VERTICAL
@@ -31,8 +47,9 @@ void main() {
         #else
         vec2 off = vec2(texelSize.x * float(i), 0);
         #endif
-        float s = texture(samplerSSAO, inUV + off).r;
-        float d = texture(samplerDepth, inUV + off).r;
+        vec2 sampleUV = clamp(uv + off, vec2(0.0), cam.renderScale);
+        float s = texture(samplerSSAO, sampleUV).r;
+        float d = texture(samplerDepth, sampleUV).r;
         float w_spatial = exp(-0.5 * (i * i) / 9.0);
         float rangeSigma = 0.1;
         float diff = d - centerDepth;
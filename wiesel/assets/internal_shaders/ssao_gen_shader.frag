@@ -1,6 +1,9 @@
 #version 450
 
-layout(constant_id = 0) const int SSAO_KERNEL_SIZE = 64;
+// Should be same as WIESEL_SSAO_KERNEL_SIZE
+layout(constant_id = 0) const int SSAO_KERNEL_SIZE = 24;
+// Should be same as WIESEL_SSAO_TEMPORAL_FRAMES
+const int SSAO_TEMPORAL_FRAMES = 4;
 layout(constant_id = 1) const float SSAO_RADIUS = 0.5;
 
 layout(set = 0, binding = 0) uniform sampler2D samplerViewPos;
@@ -21,6 +24,9 @@ layout(set = 1, binding = 1, std140) uniform Camera {
     float near;
     float far;
     vec4 cascadeSplits;
+    int enableSSAO;
+    int frameIndex;
+    vec2 renderScale;
 } cam;
 
 layout (location = 0) in vec2 inUV;
@@ -51,7 +57,9 @@ vec3 getNoiseLookup(vec2 uv) {
 
 void main() {
     //vec3 viewPos = texture(samplerViewPos, inUV).rgb;
-    float linearDepth = texture(samplerDepth, inUV).r;
+    // G-buffer only covers the top left part when rendering below full resolution
+    vec2 uv = inUV * cam.renderScale;
+    float linearDepth = texture(samplerDepth, uv).r;
     //float linearDepth = texture(samplerViewPos, inUV).w;
     vec2 ndc = inUV * 2.0 - 1.0;
     vec4 clip = vec4(ndc, 1.0, 1.0);
@@ -60,9 +68,20 @@ void main() {
     vec3 viewPos = viewDir * linearDepth;
 
     // Get G-Buffer values
-    vec3 normal = normalize(texture(samplerNormal, inUV).rgb * 2.0 - 1.0);
+    vec3 normal = normalize(texture(samplerNormal, uv).rgb * 2.0 - 1.0);
 
-    vec3 randomVec = getNoise(inUV);
+    // When accumulating over frames only a part of the kernel is used each frame,
+    // noise is also offset so the rotation changes every frame.
+    int sampleCount = SSAO_KERNEL_SIZE;
+    int kernelOffset = 0;
+    vec2 noiseOffset = vec2(0.0);
+    if (cam.enableSSAO == 2) {
+        sampleCount = SSAO_KERNEL_SIZE / SSAO_TEMPORAL_FRAMES;
+        kernelOffset = (cam.frameIndex % SSAO_TEMPORAL_FRAMES) * sampleCount;
+        noiseOffset = vec2(float(cam.frameIndex % 64) * 0.618034);
+    }
+
+    vec3 randomVec = getNoise(inUV + noiseOffset);
 
     // Create TBN matrix
     vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
@@ -73,8 +92,8 @@ void main() {
     float occlusion = 0.0f;
     // remove banding
     const float bias = 0.025f * linearDepth;
-    for(int i = 0; i < SSAO_KERNEL_SIZE; i++) {
-        vec3 sampleOffset = TBN * ssaoKernel.samples[i].xyz * SSAO_RADIUS;
+    for(int i = 0; i < sampleCount; i++) {
+        vec3 sampleOffset = TBN * ssaoKernel.samples[kernelOffset + i].xyz * SSAO_RADIUS;
         vec3 samplePos    = viewPos + sampleOffset;
 
         // project
@@ -84,17 +103,17 @@ void main() {
         offset.xyz = offset.xyz * 0.5f + 0.5f;
 
         float sampleDist  = length(samplePos);                   // distance from camera
-        float actualDepth = texture(samplerDepth, offset.xy).r;  // positive linear
+        float actualDepth = texture(samplerDepth, clamp(offset.xy, 0.0, 1.0) * cam.renderScale).r;  // positive linear
         float rangeCheck  = smoothstep(0.0, 1.0,
                                        SSAO_RADIUS / abs(linearDepth - sampleDist));
         if (actualDepth + bias < sampleDist) {
             occlusion += rangeCheck;
         }
-        if (occlusion > float(SSAO_KERNEL_SIZE)*0.9) {
+        if (occlusion > float(sampleCount)*0.9) {
             break;
         }
     }
     float strength = 1.0f;
-    occlusion = 1.0 - (occlusion / float(SSAO_KERNEL_SIZE));
+    occlusion = 1.0 - (occlusion / float(sampleCount));
     outFragColor = pow(occlusion, strength);
 }
\ No newline at end of file
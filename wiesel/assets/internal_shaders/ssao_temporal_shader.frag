@@ -0,0 +1,82 @@
+#version 450
+
+// Weight of the reprojected history, higher is smoother but slower to react
+const float HISTORY_WEIGHT = 0.9;
+// Relative depth difference allowed before the history is treated as disoccluded
+const float DEPTH_REJECT = 0.05;
+
+layout (set = 0, binding = 0) uniform sampler2D samplerSSAO;
+// (occlusion, linear depth) written by this pass last frame
+layout (set = 0, binding = 1) uniform sampler2D samplerHistory;
+layout (set = 0, binding = 2) uniform sampler2D samplerWorldPos;
+layout (set = 0, binding = 3) uniform sampler2D samplerDepth;
+
+layout(set = 1, binding = 1, std140) uniform Camera {
+    mat4 viewMatrix;
+    mat4 projection;
+    mat4 invProjection;
+    vec3 position;
+    float _pad0;
+    float near;
+    float far;
+    vec4 cascadeSplits;
+    int enableSSAO;
+    int frameIndex;
+    vec2 renderScale;
+    mat4 previousViewProjection;
+} cam;
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out vec2 outSSAO;
+
+// Same as linearDepth in geometry_shader.frag
+float linearDepth(float depth) {
+    float z = depth * 2.0 - 1.0;
+    return (2.0 * cam.near * cam.far) / (cam.far + cam.near - z * (cam.far - cam.near));
+}
+
+void main() {
+    // Inputs only cover the top left part when rendering below full resolution,
+    // history is thrown away whenever the scale changes so it shares the scale.
+    vec2 uv = inUV * cam.renderScale;
+    float centerDepth = texture(samplerDepth, uv).r;
+    // Geometry pass clears to 0, nothing was drawn there
+    if (centerDepth <= 0.0) {
+        outSSAO = vec2(1.0, 0.0);
+        return;
+    }
+
+    // Small edge aware blur of this frame's samples, replaces the full resolution blur passes
+    vec2 texelSize = 1.0 / vec2(textureSize(samplerSSAO, 0));
+    float sum = 0, wsum = 0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec2 sampleUV = clamp(uv + vec2(float(x), float(y)) * texelSize, vec2(0.0), cam.renderScale);
+            float s = texture(samplerSSAO, sampleUV).r;
+            float d = texture(samplerDepth, sampleUV).r;
+            float diff = (d - centerDepth) / centerDepth;
+            float w = exp(-0.5 * float(x * x + y * y)) * exp(-diff * diff * 400.0);
+            sum += s * w;
+            wsum += w;
+        }
+    }
+    float current = sum / wsum;
+
+    // Reproject into last frame, previousViewProjection is all zeros when there is no history
+    vec3 worldPos = texture(samplerWorldPos, uv).rgb;
+    vec4 prevClip = cam.previousViewProjection * vec4(worldPos, 1.0);
+    float result = current;
+    if (prevClip.w > 0.0) {
+        vec3 prevNdc = prevClip.xyz / prevClip.w;
+        vec2 prevUV = prevNdc.xy * 0.5 + 0.5;
+        if (all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)))) {
+            vec2 history = texture(samplerHistory, prevUV * cam.renderScale).rg;
+            float expectedDepth = linearDepth(prevNdc.z);
+            if (abs(history.g - expectedDepth) < expectedDepth * DEPTH_REJECT) {
+                result = mix(current, history.r, HISTORY_WEIGHT);
+            }
+        }
+    }
+    outSSAO = vec2(result, centerDepth);
+}
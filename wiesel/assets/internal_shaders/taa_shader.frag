@@ -0,0 +1,78 @@
+#version 450
+
+// Weight of the reprojected history, higher is smoother but ghosts longer
+const float HISTORY_WEIGHT = 0.9;
+
+layout (set = 0, binding = 0) uniform sampler2D samplerColor;
+// Resolved color written by this pass last frame
+layout (set = 0, binding = 1) uniform sampler2D samplerHistory;
+layout (set = 0, binding = 2) uniform sampler2D samplerDepth;
+
+layout(set = 1, binding = 1, std140) uniform Camera {
+    mat4 viewMatrix;
+    mat4 projection;
+    mat4 invProjection;
+    vec3 position;
+    float _pad0;
+    float near;
+    float far;
+    vec4 cascadeSplits;
+    int enableSSAO;
+    int frameIndex;
+    vec2 renderScale;
+    mat4 previousViewProjection;
+} cam;
+
+layout (location = 0) in vec2 inUV;
+
+layout (location = 0) out vec4 outColor;
+
+// Inverse of linearDepth in geometry_shader.frag, gives the depth buffer value
+float depthFromLinear(float linear) {
+    float z = (cam.far + cam.near - 2.0 * cam.near * cam.far / linear) / (cam.far - cam.near);
+    return z * 0.5 + 0.5;
+}
+
+void main() {
+    // Inputs only cover the top left part when rendering below full resolution,
+    // history is thrown away whenever the scale changes so it shares the scale.
+    vec2 uv = inUV * cam.renderScale;
+    vec4 current = texture(samplerColor, uv);
+
+    // Range of this frame's neighbourhood, history outside of it is stale
+    vec2 texelSize = 1.0 / vec2(textureSize(samplerColor, 0));
+    vec4 neighbourMin = current;
+    vec4 neighbourMax = current;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec2 sampleUV = clamp(uv + vec2(float(x), float(y)) * texelSize, vec2(0.0), cam.renderScale);
+            vec4 s = texture(samplerColor, sampleUV);
+            neighbourMin = min(neighbourMin, s);
+            neighbourMax = max(neighbourMax, s);
+        }
+    }
+
+    // The fused path keeps no world positions, rebuild them from linear depth.
+    // Geometry pass clears to 0, the sky is reprojected as a direction.
+    float linear = texture(samplerDepth, uv).r;
+    bool sky = linear <= 0.0;
+    vec4 viewPos = cam.invProjection * vec4(inUV * 2.0 - 1.0, sky ? 1.0 : depthFromLinear(linear), 1.0);
+    viewPos /= viewPos.w;
+    // The view matrix is rigid, its inverse is the transposed rotation
+    mat3 invRotation = transpose(mat3(cam.viewMatrix));
+    vec4 worldPos = sky ? vec4(invRotation * viewPos.xyz, 0.0)
+                        : vec4(invRotation * (viewPos.xyz - cam.viewMatrix[3].xyz), 1.0);
+
+    // previousViewProjection is all zeros when there is no history
+    vec4 prevClip = cam.previousViewProjection * worldPos;
+    vec4 result = current;
+    if (prevClip.w > 0.0) {
+        vec2 prevUV = prevClip.xy / prevClip.w * 0.5 + 0.5;
+        if (all(greaterThanEqual(prevUV, vec2(0.0))) && all(lessThanEqual(prevUV, vec2(1.0)))) {
+            vec4 history = texture(samplerHistory, prevUV * cam.renderScale);
+            history = clamp(history, neighbourMin, neighbourMax);
+            result = mix(current, history, HISTORY_WEIGHT);
+        }
+    }
+    outColor = result;
+}
@@ -17,7 +17,9 @@ namespace Wiesel {
 enum MemoryType {
   MemoryTypeVertexBuffer,
   MemoryTypeIndexBuffer,
-  MemoryTypeUniformBuffer
+  MemoryTypeUniformBuffer,
+  MemoryTypeStorageBuffer,
+  MemoryTypeReadbackBuffer
 };
 
 class MemoryBuffer {
@@ -47,4 +49,22 @@ class UniformBuffer : public MemoryBuffer {
   void* data_;
 };
 
+// Host visible storage buffer, written by the cpu every frame
+class StorageBuffer : public MemoryBuffer {
+ public:
+  StorageBuffer();
+  ~StorageBuffer() override;
+
+  void* data_;
+};
+
+// Host visible buffer that stays mapped, used to copy images back to the cpu
+class ReadbackBuffer : public MemoryBuffer {
+ public:
+  ReadbackBuffer();
+  ~ReadbackBuffer() override;
+
+  void* data_;
+};
+
 }  // namespace Wiesel
\ No newline at end of file
@@ -14,7 +14,10 @@
 #include <scene/w_components.hpp>
 #include "events/w_appevents.hpp"
 #include "util/w_uuid.hpp"
+#include "w_buffer.hpp"
+#include "w_command.hpp"
 #include "w_framebuffer.hpp"
+#include "w_occlusion.hpp"
 #include "w_pch.hpp"
 #include "w_texture.hpp"
 
@@ -22,6 +25,9 @@ namespace Wiesel {
 
 struct FrustumPlanes {
   glm::vec4 Left, Right, Bottom, Top, Near, Far;
+
+  WIESEL_GETTER_FN bool IntersectsSphere(const glm::vec3& center,
+                                         float radius) const;
 };
 
 struct Cascade {
@@ -29,21 +35,21 @@ struct Cascade {
   glm::mat4 ViewProjMatrix;
 };
 
-struct CameraComponent {
-  CameraComponent() = default;
-  CameraComponent(const CameraComponent&) = default;
-  ~CameraComponent() = default;
-
-  float field_of_view = 60;
-  float near_plane = 0.01f;
-  float far_plane = 400.0f;
-  float aspect_ratio = 1.0;
-
-  glm::mat4 view_matrix;
-  glm::mat4 projection;
-  glm::mat4 inv_projection;
-  glm::vec2 viewport_size;
-  glm::mat4 inv_view_matrix;
+// GPU side of a camera: render targets, descriptors and the history that
+// persists between frames. Owned by the camera component, the renderer only
+// ever sees it through CameraData::resources.
+struct CameraResources {
+  // Written by Renderer::UpdateUniformData, each camera reads its own lights
+  // and clusters
+  Ref<UniformBuffer> lights_uniform_buffer;
+  Ref<UniformBuffer> camera_uniform_buffer;
+  Ref<UniformBuffer> shadow_camera_uniform_buffer;
+  Ref<StorageBuffer> point_lights_storage_buffer;
+  Ref<StorageBuffer> light_clusters_storage_buffer;
+  Ref<StorageBuffer> light_indices_storage_buffer;
+  // What the light buffers above were built from
+  uint64_t uploaded_lights_version = 0;
+  glm::mat4 uploaded_view_projection{0.0f};
 
 #ifdef ID_BUFFER_PASS
   Ref<AttachmentTexture> id_image;
@@ -52,7 +58,7 @@ struct CameraComponent {
 
   Ref<AttachmentTexture> geometry_normal_image;
   Ref<AttachmentTexture> geometry_normal_resolve_image;
-  Ref<AttachmentTexture> GeometryDepthImage;
+  Ref<AttachmentTexture> geometry_depth_image;
   Ref<AttachmentTexture> geometry_depth_resolve_image;
   Ref<AttachmentTexture> geometry_albedo_image;
   Ref<AttachmentTexture> geometry_albedo_resolve_image;
@@ -63,14 +69,34 @@ struct CameraComponent {
   Ref<AttachmentTexture> geometry_material_image;
   Ref<AttachmentTexture> geometry_material_resolve_image;
   Ref<AttachmentTexture> geometry_depth_stencil;
+  // G-buffer of the fused geometry lighting pass, only lives in tile memory
+  Ref<AttachmentTexture> transient_view_pos_image;
+  Ref<AttachmentTexture> transient_world_pos_image;
+  Ref<AttachmentTexture> transient_normal_image;
+  Ref<AttachmentTexture> transient_albedo_image;
+  Ref<AttachmentTexture> transient_material_image;
+  Ref<AttachmentTexture> transient_depth_stencil;
+
+  Ref<AttachmentTexture> hiz_image;
+  Ref<ReadbackBuffer> hiz_readback_buffer;
+  Ref<HiZPyramid> hiz_pyramid;
 
   Ref<AttachmentTexture> ssao_color_image;
   Ref<AttachmentTexture> ssao_blur_horz_color_image;
   Ref<AttachmentTexture> ssao_blur_vert_color_image;
+  // Half resolution (occlusion, linear depth), written alternately
+  std::array<Ref<AttachmentTexture>, 2> ssao_history_images;
+  uint32_t ssao_history_index = 0;
+  glm::mat4 previous_view_projection{0.0f};
 
   Ref<AttachmentTexture> lighting_color_image;
   Ref<AttachmentTexture> lighting_color_resolve_image;
 
+  // FXAA output, and TAA resolved color written alternately
+  Ref<AttachmentTexture> fxaa_color_image;
+  std::array<Ref<AttachmentTexture>, 2> taa_history_images;
+  uint32_t taa_history_index = 0;
+
   Ref<AttachmentTexture> sprite_color_image;
 
   Ref<AttachmentTexture> composite_color_image;
@@ -80,32 +106,90 @@ struct CameraComponent {
   Ref<Framebuffer> id_framebuffer;
 #endif
   Ref<Framebuffer> geometry_framebuffer;
+  Ref<Framebuffer> geometry_lighting_framebuffer;
+  Ref<Framebuffer> hiz_framebuffer;
   Ref<Framebuffer> ssao_gen_framebuffer;
   Ref<Framebuffer> ssao_blur_horz_framebuffer;
   Ref<Framebuffer> ssao_blur_vert_framebuffer;
+  std::array<Ref<Framebuffer>, 2> ssao_history_framebuffers;
   Ref<Framebuffer> lighting_framebuffer;
+  Ref<Framebuffer> fxaa_framebuffer;
+  std::array<Ref<Framebuffer>, 2> taa_history_framebuffers;
   Ref<Framebuffer> sprite_framebuffer;
   Ref<Framebuffer> composite_framebuffer;
-  Ref<DescriptorSet> global_descriptor;
-  Ref<DescriptorSet> shadow_descriptor;
-
-  Ref<DescriptorSet> geometry_output_descriptor;
-  Ref<DescriptorSet> ssao_output_descriptor;
-  Ref<DescriptorSet> ssao_blur_horz_output_descriptor;
-  Ref<DescriptorSet> ssao_blur_vert_output_descriptor;
-  Ref<DescriptorSet> lighting_output_descriptor;
-  Ref<DescriptorSet> sprite_output_descriptor;
-  Ref<DescriptorSet> composite_output_descriptor;
-  Ref<DescriptorSet> ssao_gen_descriptor;
-  FrustumPlanes planes;
+  Ref<DescriptorSet> global_descriptor; // to draw geometry
+  Ref<DescriptorSet> shadow_descriptor; // to draw geometry to shadow pass
+  Ref<DescriptorSet> geometry_output_descriptor; // to draw geometry pass output
+  Ref<DescriptorSet> geometry_input_descriptor; // to read the g-buffer in the fused lighting subpass
+  Ref<DescriptorSet> hiz_input_descriptor; // to downsample geometry pass depth
+  Ref<DescriptorSet> hiz_compute_descriptor; // same but on the compute queue
+  Ref<DescriptorSet> ssao_output_descriptor; // to draw ssao pass output
+  Ref<DescriptorSet> ssao_blur_horz_output_descriptor; // to draw ssao blur horz pass output
+  Ref<DescriptorSet> ssao_blur_vert_output_descriptor; // to draw ssao blur vert pass output
+  std::array<Ref<DescriptorSet>, 2> ssao_temporal_descriptors; // to accumulate ssao into history
+  std::array<Ref<DescriptorSet>, 2> ssao_history_output_descriptors; // to draw accumulated ssao
+  Ref<DescriptorSet> lighting_output_descriptor; // to draw lighting pass output
+  Ref<DescriptorSet> fxaa_output_descriptor; // to draw fxaa pass output
+  std::array<Ref<DescriptorSet>, 2> taa_descriptors; // to accumulate lighting into history
+  std::array<Ref<DescriptorSet>, 2> taa_history_output_descriptors; // to draw accumulated lighting
+  Ref<DescriptorSet> sprite_output_descriptor; // to draw sprite pass output
+  Ref<DescriptorSet> composite_output_descriptor; // to draw composite pass output
+  Ref<DescriptorSet> ssao_gen_descriptor; // used to render geometry pass output to ssao pass
+
+  // Recorded fullscreen passes, cleared whenever the attachments above are
+  // recreated. Passes reading temporal SSAO or TAA have one per history image.
+  StaticPassCommands ssao_gen_commands;
+  std::array<StaticPassCommands, 2> ssao_temporal_commands;
+  StaticPassCommands ssao_blur_horz_commands;
+  StaticPassCommands ssao_blur_vert_commands;
+  std::array<StaticPassCommands, 2> lighting_commands;
+  StaticPassCommands fxaa_commands;
+  std::array<StaticPassCommands, 2> taa_commands;
+  std::array<StaticPassCommands, 2> composite_commands;
 
-  // Shadow stuff
-  bool does_shadow_pass = false;
-  std::array<Cascade, WIESEL_SHADOW_CASCADE_COUNT> shadow_map_cascades;
   Ref<AttachmentTexture> shadow_depth_stencil;
   std::array<Ref<ImageView>, WIESEL_SHADOW_CASCADE_COUNT> shadow_depth_views;
   Ref<ImageView> shadow_depth_view_array;
   std::array<Ref<Framebuffer>, WIESEL_SHADOW_CASCADE_COUNT> shadow_framebuffers;
+  // Cascades shadow_depth_stencil was last rendered with, cameras sharing it
+  // sample it with these
+  std::array<Cascade, WIESEL_SHADOW_CASCADE_COUNT> shadow_map_cascades{};
+  // Shadow map global_descriptor currently samples, another camera's when
+  // sharing or the renderer's blank one without shadows. Held so it outlives
+  // a resize of the camera it came from.
+  Ref<AttachmentTexture> bound_shadow_image;
+  Ref<ImageView> bound_shadow_view;
+
+  // Level of detail this camera last drew each model with, keyed by
+  // RenderTransform::id. Kept for the LOD hysteresis.
+  std::unordered_map<uint32_t, uint32_t> model_lods;
+};
+
+struct CameraComponent {
+  CameraComponent() = default;
+  CameraComponent(const CameraComponent&) = default;
+  ~CameraComponent() = default;
+
+  float field_of_view = 60;
+  float near_plane = 0.01f;
+  float far_plane = 400.0f;
+  float aspect_ratio = 1.0;
+  // Part of the viewport the deferred passes render at, set from the renderer
+  float render_scale = 1.0f;
+
+  glm::mat4 view_matrix;
+  glm::mat4 projection;
+  glm::mat4 inv_projection;
+  glm::vec2 viewport_size;
+  glm::mat4 inv_view_matrix;
+
+  // Created by Renderer::SetupCameraComponent and kept across resizes
+  Ref<CameraResources> resources;
+  FrustumPlanes planes;
+
+  // Shadow stuff
+  bool does_shadow_pass = false;
+  std::array<Cascade, WIESEL_SHADOW_CASCADE_COUNT> shadow_map_cascades;
 
   glm::vec3 previous_light_dir;
   bool force_light_reset = false;
@@ -114,6 +198,23 @@ struct CameraComponent {
   bool any_changed = true;
   bool enabled = true;
 
+  // Lets secondary views like monitors or UI widgets cost a fraction of the
+  // main view, frames a camera skips keep showing its last image.
+  // Renders every Nth frame
+  uint32_t render_interval = 1;
+  // Upper limit of renders per second, 0 for no limit
+  float max_render_rate = 0.0f;
+  // Applied on top of the render scale of the renderer
+  float render_scale_factor = 1.0f;
+  bool enable_ssao = true;
+  bool enable_shadows = true;
+  // Samples the cascades of the main camera instead of rendering its own.
+  // Cascades are picked with the main camera's splits, so this is meant for
+  // views close to it.
+  bool share_main_shadows = false;
+  uint32_t frames_until_render = 0;
+  float next_render_time = 0.0f;
+
   void UpdateProjection();
   void UpdateView(const glm::mat4& worldTransform);
   void UpdateAll();
@@ -123,13 +224,9 @@ struct CameraComponent {
 
 };
 
+// Per frame view of a camera, extracted into the render packet. Only plain
+// values, the resources are borrowed from the camera component.
 struct CameraData {
-  CameraData() = default;
-  CameraData(glm::vec3 position, glm::mat4 view_matrix, glm::mat4 projection)
-      : position(position), view_matrix(view_matrix), projection(projection){}
-  CameraData(const CameraData&) = default;
-  ~CameraData() = default;
-
   glm::vec3 position;
   glm::mat4 view_matrix;
   glm::mat4 projection;
@@ -137,121 +234,19 @@ struct CameraData {
   glm::vec2 viewport_size;
   float near_plane = 0.01f;
   float far_plane = 1000.0f;
-
-  Ref<AttachmentTexture> geometry_normal_image;
-  Ref<AttachmentTexture> geometry_normal_resolve_image;
-  Ref<AttachmentTexture> geometry_albedo_image;
-  Ref<AttachmentTexture> geometry_albedo_resolve_image;
-  Ref<AttachmentTexture> geometry_view_pos_image;
-  Ref<AttachmentTexture> geometry_view_pos_resolve_image;
-  Ref<AttachmentTexture> geometry_world_pos_image;
-  Ref<AttachmentTexture> geometry_world_pos_resolve_image;
-  Ref<AttachmentTexture> geometry_depth_image;
-  Ref<AttachmentTexture> geometry_depth_resolve_image;
-  Ref<AttachmentTexture> geometry_depth_stencil;
-  Ref<AttachmentTexture> geometry_material_image;
-  Ref<AttachmentTexture> geometry_material_resolve_image;
-
-  Ref<AttachmentTexture> ssao_color_image;
-  Ref<AttachmentTexture> ssao_blur_horz_color_image;
-  Ref<AttachmentTexture> ssao_blur_vert_color_image;
-
-  Ref<AttachmentTexture> lighting_color_image;
-  Ref<AttachmentTexture> lighting_color_resolve_image;
-
-  Ref<AttachmentTexture> sprite_color_image;
-
-  Ref<AttachmentTexture> composite_color_image;
-  Ref<AttachmentTexture> composite_color_resolve_image;
-
-  Ref<Framebuffer> geometry_framebuffer;
-  Ref<Framebuffer> ssao_gen_framebuffer;
-  Ref<Framebuffer> ssao_blur_horz_framebuffer;
-  Ref<Framebuffer> ssao_blur_vert_framebuffer;
-  Ref<Framebuffer> lighting_framebuffer;
-  Ref<Framebuffer> sprite_framebuffer;
-  Ref<Framebuffer> composite_framebuffer;
-  Ref<DescriptorSet> global_descriptor; // to draw geometry
-  Ref<DescriptorSet> shadow_descriptor; // to draw geometry to shadow pass
-  Ref<DescriptorSet> geometry_output_descriptor; // to draw geometry pass output
-  Ref<DescriptorSet> ssao_output_descriptor; // to draw ssao pass output
-  Ref<DescriptorSet> ssao_blur_horz_output_descriptor; // to draw ssao blur horz pass output
-  Ref<DescriptorSet> ssao_blur_vert_output_descriptor; // to draw ssao blur vert pass output
-  Ref<DescriptorSet> lighting_output_descriptor; // to draw lighting pass output
-  Ref<DescriptorSet> sprite_output_descriptor; // to draw sprite pass output
-  Ref<DescriptorSet> composite_output_descriptor; // to draw composite pass output
-  Ref<DescriptorSet> ssao_gen_descriptor; // used to render geometry pass output to ssao pass
+  float render_scale = 1.0f;
   FrustumPlanes planes;
 
+  bool enable_ssao = true;
+
   // Shadow stuff
   bool does_shadow_pass = false;
   std::array<Cascade, WIESEL_SHADOW_CASCADE_COUNT> shadow_map_cascades;
-  Ref<AttachmentTexture> shadow_depth_stencil;
-  std::array<Ref<Framebuffer>, WIESEL_SHADOW_CASCADE_COUNT> shadow_framebuffers;
-
-  void TransferFrom(CameraComponent& camera, TransformComponent& transform) {
-    // Perhaps we could do this differently?
-    // At first, we had 3 variables to update, but now we have a lot more...
-
-    position = transform.position;
-    view_matrix = camera.view_matrix;
-    projection = camera.projection;
-    inv_projection = camera.inv_projection;
-    viewport_size = camera.viewport_size;
-    near_plane = camera.near_plane;
-    far_plane = camera.far_plane;
-
-    geometry_normal_image = camera.geometry_normal_image;
-    geometry_normal_resolve_image = camera.geometry_normal_resolve_image;
-    geometry_albedo_image = camera.geometry_albedo_image;
-    geometry_albedo_resolve_image = camera.geometry_albedo_resolve_image;
-    geometry_view_pos_image = camera.geometry_view_pos_image;
-    geometry_view_pos_resolve_image = camera.geometry_view_pos_resolve_image;
-    geometry_world_pos_image = camera.geometry_world_pos_image;
-    geometry_world_pos_resolve_image = camera.geometry_world_pos_resolve_image;
-    geometry_depth_image = camera.GeometryDepthImage;
-    geometry_depth_resolve_image = camera.geometry_depth_resolve_image;
-    geometry_depth_stencil = camera.geometry_depth_stencil;
-    geometry_material_image = camera.geometry_material_image;
-    geometry_material_resolve_image = camera.geometry_material_resolve_image;
-
-    ssao_color_image = camera.ssao_color_image;
-    ssao_blur_horz_color_image = camera.ssao_blur_horz_color_image;
-    ssao_blur_vert_color_image = camera.ssao_blur_vert_color_image;
-
-    lighting_color_image = camera.lighting_color_image;
-    lighting_color_resolve_image = camera.lighting_color_resolve_image;
-
-    sprite_color_image = camera.sprite_color_image;
-
-    composite_color_image = camera.composite_color_image;
-    composite_color_resolve_image = camera.composite_color_resolve_image;
-
-    geometry_framebuffer = camera.geometry_framebuffer;
-    ssao_gen_framebuffer = camera.ssao_gen_framebuffer;
-    ssao_blur_horz_framebuffer = camera.ssao_blur_horz_framebuffer;
-    ssao_blur_vert_framebuffer = camera.ssao_blur_vert_framebuffer;
-    lighting_framebuffer = camera.lighting_framebuffer;
-    sprite_framebuffer = camera.sprite_framebuffer;
-    composite_framebuffer = camera.composite_framebuffer;
-    global_descriptor = camera.global_descriptor;
-    shadow_descriptor = camera.shadow_descriptor;
-    geometry_output_descriptor = camera.geometry_output_descriptor;
-    ssao_output_descriptor = camera.ssao_output_descriptor;
-    ssao_blur_horz_output_descriptor = camera.ssao_blur_horz_output_descriptor;
-    ssao_blur_vert_output_descriptor = camera.ssao_blur_vert_output_descriptor;
-    lighting_output_descriptor = camera.lighting_output_descriptor;
-    sprite_output_descriptor = camera.sprite_output_descriptor;
-    composite_output_descriptor = camera.composite_output_descriptor;
-    ssao_gen_descriptor = camera.ssao_gen_descriptor;
-    planes = camera.planes;
-
-    does_shadow_pass = camera.does_shadow_pass;
-    shadow_map_cascades = camera.shadow_map_cascades;
-    shadow_depth_stencil = camera.shadow_depth_stencil;
-    shadow_framebuffers = camera.shadow_framebuffers;
-  }
+  // Shadow map the camera samples, its own or the main camera's. Null
+  // renders without shadows.
+  CameraResources* shadow_source = nullptr;
 
+  CameraResources* resources = nullptr;
 };
 
 }  // namespace Wiesel
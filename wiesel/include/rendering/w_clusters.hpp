@@ -0,0 +1,53 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "scene/w_lights.hpp"
+#include "util/w_utils.hpp"
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// Should match the layout in lighting_shader.frag
+struct LightCluster {
+  uint32_t offset;
+  uint32_t count;
+};
+
+// Splits the view frustum into WIESEL_CLUSTER_GRID_X * Y screen tiles and
+// WIESEL_CLUSTER_GRID_Z exponential depth slices, then bins point lights
+// into every cluster their range sphere touches.
+class LightClusterGrid {
+ public:
+  LightClusterGrid();
+  ~LightClusterGrid() = default;
+
+  void Build(std::span<const LightPoint> lights, const glm::mat4& view_matrix,
+             const glm::mat4& projection, float near_plane, float far_plane);
+
+  WIESEL_GETTER_FN const std::vector<LightCluster>& GetClusters() const {
+    return clusters_;
+  }
+  WIESEL_GETTER_FN const std::vector<uint32_t>& GetLightIndices() const {
+    return light_indices_;
+  }
+
+ private:
+  std::vector<LightCluster> clusters_;
+  std::vector<uint32_t> light_indices_;
+  // Reused between frames to avoid allocating
+  std::vector<std::vector<uint32_t>> bins_;
+  // Overflowing the index buffer is only logged the first time
+  bool warned_overflow_ = false;
+};
+
+}  // namespace Wiesel
@@ -14,33 +14,51 @@ class CommandBuffer;
 
 class CommandPool {
  public:
-  CommandPool();
+  explicit CommandPool(uint32_t queue_family_index);
   ~CommandPool();
 
-  Ref<CommandBuffer> CreateBuffer();
+  Ref<CommandBuffer> CreateBuffer(
+      VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 
   VkCommandPool handle_{};
  private:
   friend class CommandBuffer;
-  void ReturnBuffer(VkCommandBuffer buffer);
+  void ReturnBuffer(VkCommandBuffer buffer, VkCommandBufferLevel level);
 
   std::list<VkCommandBuffer> free_buffers_;
+  std::list<VkCommandBuffer> free_secondary_buffers_;
 };
 
 class CommandBuffer {
  public:
-  CommandBuffer(CommandPool& pool, VkCommandBuffer m_CommandBuffer);
+  CommandBuffer(CommandPool& pool, VkCommandBuffer m_CommandBuffer,
+                VkCommandBufferLevel level = VK_COMMAND_BUFFER_LEVEL_PRIMARY);
   ~CommandBuffer();
 
   void Reset();
   void Begin();
+  // Secondary buffers only, records commands to be executed inside the given
+  // subpass of a render pass that was begun with secondary contents
+  void Begin(VkRenderPass render_pass, uint32_t subpass,
+             VkFramebuffer framebuffer);
   void End();
 
   VkCommandBuffer handle_;
+  VkCommandBufferLevel level_;
  private:
   CommandPool& pool_;
 
 };
+
+// Commands of a pass that are the same every frame, recorded once into a
+// secondary buffer and replayed until the state they depend on changes.
+// See Renderer::ExecuteStaticPass.
+struct StaticPassCommands {
+  Ref<CommandBuffer> buffer;
+  uint64_t version = 0;
+  VkExtent2D extent{};
+  glm::vec2 render_size{};
+};
 }
 
 #endif  //WIESEL_COMMAND_CONTEXT_HPP
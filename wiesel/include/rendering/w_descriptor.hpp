@@ -45,6 +45,22 @@ class DescriptorSet {
     });
   }
 
+  // Image has to be an attachment of the subpass reading it
+  void AddInputAttachment(uint32_t dst_binding, Ref<ImageView> view) {
+    input_attachments_.push_back({
+        .dst_binding = dst_binding,
+        .image_view = view
+    });
+  }
+
+  // Image has to be in VK_IMAGE_LAYOUT_GENERAL when it's accessed
+  void AddStorageImage(uint32_t dst_binding, Ref<ImageView> view) {
+    storage_images_.push_back({
+        .dst_binding = dst_binding,
+        .image_view = view
+    });
+  }
+
   void Bake();
 
   bool allocated_;
@@ -61,7 +77,13 @@ class DescriptorSet {
     uint32_t dst_binding;
     Ref<UniformBuffer> ubo;
   };
+  struct InputAttachmentData {
+    uint32_t dst_binding;
+    Ref<ImageView> image_view;
+  };
   std::vector<CombinedImageSamplerData> combined_image_samplers_;
   std::vector<UniformBufferData> uniform_buffer_data_;
+  std::vector<InputAttachmentData> input_attachments_;
+  std::vector<InputAttachmentData> storage_images_;
 };
 }  // namespace Wiesel
\ No newline at end of file
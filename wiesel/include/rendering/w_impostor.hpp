@@ -0,0 +1,84 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "rendering/w_descriptor.hpp"
+#include "rendering/w_texture.hpp"
+#include "util/w_attributes.hpp"
+#include "util/w_utils.hpp"
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// Views of a model baked into a WIESEL_IMPOSTOR_GRID x WIESEL_IMPOSTOR_GRID
+// atlas, one orthographic view per cell. Cells are laid out with an
+// octahedral mapping of the view direction so every direction around the
+// model has a cell close to it. Drawn as a single camera facing quad in
+// place of the model once it's small on screen.
+struct Impostor {
+  // Object space bounding sphere of the model, every view fits it
+  glm::vec3 center{0.0f};
+  float radius = 0.0f;
+  // Albedo with coverage in alpha
+  Ref<AttachmentTexture> albedo_image;
+  // Object space normal in rgb, depth through the bounding sphere in alpha
+  Ref<AttachmentTexture> normal_depth_image;
+  Ref<DescriptorSet> descriptor;
+
+  // Size of the bounding sphere on screen as a fraction of the screen
+  // height, compared against Renderer::GetImpostorScreenSize.
+  WIESEL_GETTER_FN float GetScreenSize(const glm::mat4& transform_matrix,
+                                       const glm::vec3& camera_position,
+                                       const glm::mat4& projection) const;
+};
+
+// Maps a unit direction to [0, 1]^2 and back, y is up. Has to match the
+// functions in impostor_shader.vert.
+glm::vec2 OctahedralEncode(glm::vec3 direction);
+glm::vec3 OctahedralDecode(glm::vec2 uv);
+
+// Per instance vertex data of the impostor pipeline, the quad corners come
+// from the vertex index.
+struct ImpostorInstance {
+  glm::mat4 TransformMatrix;
+  // Object space center in xyz, radius in w
+  glm::vec4 Bounds;
+
+  static VkVertexInputBindingDescription GetBindingDescription() {
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(ImpostorInstance);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    return bindingDescription;
+  }
+
+  static std::vector<VkVertexInputAttributeDescription>
+  GetAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    // A mat4 takes one location per column
+    for (uint32_t i = 0; i < 4; i++) {
+      attributeDescriptions.push_back(
+          {i, 0, VK_FORMAT_R32G32B32A32_SFLOAT,
+           (uint32_t) (offsetof(ImpostorInstance, TransformMatrix) +
+                       sizeof(glm::vec4) * i)});
+    }
+    attributeDescriptions.push_back(
+        {4, 0, VK_FORMAT_R32G32B32A32_SFLOAT,
+         (uint32_t) offsetof(ImpostorInstance, Bounds)});
+
+    return attributeDescriptions;
+  }
+};
+
+}  // namespace Wiesel
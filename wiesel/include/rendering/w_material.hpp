@@ -19,6 +19,18 @@
 namespace Wiesel {
 static constexpr int kMaterialTextureCount = 7;
 
+// Textures a material has, pushed once per draw instead of being stored in
+// every vertex. Has to match the kMaterialFlag constants in the shaders.
+enum MaterialFlag {
+  MaterialFlagHasTexture = BIT(0),
+  MaterialFlagHasNormalMap = BIT(1),
+  MaterialFlagHasSpecularMap = BIT(2),
+  MaterialFlagHasHeightMap = BIT(3),
+  MaterialFlagHasAlbedoMap = BIT(4),
+  MaterialFlagHasRoughnessMap = BIT(5),
+  MaterialFlagHasMetallicMap = BIT(6),
+};
+
 struct Material {
   Material();
   ~Material();
@@ -35,6 +47,8 @@ struct Material {
   Ref<Texture> albedo_map;
   Ref<Texture> roughness_map;
   Ref<Texture> metallic_map;
+  // MaterialFlag bits of the textures above, kept up to date by Set
+  uint32_t flags = 0;
 
   static void Set(Ref<Material> material, Ref<Texture> texture,
                   TextureType type);
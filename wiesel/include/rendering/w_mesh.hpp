@@ -19,12 +19,37 @@
 
 #include "rendering/w_buffer.hpp"
 #include "rendering/w_descriptor.hpp"
+#include "rendering/w_impostor.hpp"
 #include "rendering/w_material.hpp"
 #include "rendering/w_texture.hpp"
 #include "scene/w_components.hpp"
+#include "util/w_handle.hpp"
 #include "w_pch.hpp"
 
 namespace Wiesel {
+// Index range of one level of detail in the mesh's index buffer
+struct MeshLodRange {
+  uint32_t first_index = 0;
+  uint32_t index_count = 0;
+};
+
+// Everything a draw reads from a mesh, kept densely in the renderer's mesh
+// pool so drawing doesn't go through the shared_ptrs of the mesh.
+struct MeshDrawData {
+  VkBuffer vertex_buffer = VK_NULL_HANDLE;
+  VkBuffer shadow_vertex_buffer = VK_NULL_HANDLE;
+  VkBuffer index_buffer = VK_NULL_HANDLE;
+  VkIndexType index_type = VK_INDEX_TYPE_UINT32;
+  std::array<MeshLodRange, WIESEL_MAX_MESH_LODS> lods{};
+  uint32_t lod_count = 1;
+  uint32_t material_flags = 0;
+  VkDescriptorSet geometry_descriptor = VK_NULL_HANDLE;
+  VkDescriptorSet shadow_descriptor = VK_NULL_HANDLE;
+  void* uniform_data = nullptr;
+};
+
+using MeshHandle = Handle<MeshDrawData>;
+
 struct Mesh {
   Mesh();
   Mesh(const std::vector<Vertex3D>& vertices, const std::vector<Index>& indices);
@@ -36,11 +61,20 @@ struct Mesh {
 
   std::vector<Vertex3D> vertices;
   std::vector<Index> indices;
+  // Coarser levels of detail, LOD1 first, indexing the same vertices. Put in
+  // the index buffer after indices on Allocate.
+  std::vector<std::vector<Index>> lod_indices;
   std::string model_path;
+  // Object space bounds, computed on Allocate
+  glm::vec3 bounds_min{0.0f};
+  glm::vec3 bounds_max{0.0f};
 
   bool allocated_;
+  // Valid while allocated, owns nothing, the buffers below do
+  MeshHandle handle;
   // Render Data
   Ref<MemoryBuffer> vertex_buffer;
+  // ShadowVertex3D, only what the shadow pass reads
   Ref<MemoryBuffer> shadow_vertex_buffer;
   Ref<IndexBuffer> index_buffer;
   Ref<UniformBuffer> uniform_buffer;
@@ -60,6 +94,11 @@ struct Model {
   std::map<std::string, Ref<Texture>> textures;
   bool receive_shadows = true;
   bool enable_rendering = true;
+  // Drawn with a baked impostor when it's small on screen. The impostor is
+  // baked by Engine::LoadModel or when this is turned on in the editor, and
+  // is shared by every model loaded from the same path.
+  bool enable_impostor = false;
+  Ref<Impostor> impostor;
 };
 
 struct ModelComponent : public IComponent {
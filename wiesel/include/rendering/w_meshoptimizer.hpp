@@ -0,0 +1,59 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "util/w_utils.hpp"
+#include "w_pch.hpp"
+
+// Import time processing of triangle lists, run by Engine::ProcessMesh
+namespace Wiesel::MeshOptimizer {
+
+// Average cache miss ratio, vertex shader invocations per triangle with a
+// FIFO post-transform cache of WIESEL_VERTEX_CACHE_SIZE entries. 0.5 is the
+// best a large grid gets, 3 means no reuse at all.
+float AnalyzeACMR(const std::vector<Index>& indices, size_t vertexCount);
+
+// Merges vertices that are bit identical
+void DeduplicateVertices(std::vector<Vertex3D>& vertices,
+                         std::vector<Index>& indices);
+// Reorders triangles for the post-transform cache, Tom Forsyth's linear speed
+// vertex cache optimization
+void OptimizeVertexCache(std::vector<Index>& indices, size_t vertexCount);
+// Splits cache ordered triangles into clusters, keeping the ACMR within
+// threshold of the input, and draws outward facing clusters first since they
+// tend to occlude the rest
+void OptimizeOverdraw(std::vector<Index>& indices,
+                      const std::vector<Vertex3D>& vertices,
+                      float threshold = 1.05f);
+// Orders vertices by first use so vertex fetch walks the buffer linearly,
+// unreferenced vertices are dropped
+void OptimizeVertexFetch(std::vector<Vertex3D>& vertices,
+                         std::vector<Index>& indices);
+
+// All of the above in order, logs the ACMR before and after
+void Optimize(std::vector<Vertex3D>& vertices, std::vector<Index>& indices);
+
+// Quadric error edge collapse down to target_index_count indices, or as far
+// as it gets without going over target_error, a fraction of the mesh extent.
+// Only existing vertices are collapsed onto each other so the result indexes
+// the same vertices. Borders and UV or normal seams are kept in place.
+std::vector<Index> Simplify(const std::vector<Vertex3D>& vertices,
+                            const std::vector<Index>& indices,
+                            size_t target_index_count, float target_error);
+// Simplifies LOD0 to about half the triangles per level, until
+// WIESEL_MAX_MESH_LODS levels or simplification stops paying off. Levels are
+// appended to lods, LOD1 first.
+void GenerateLods(const std::vector<Vertex3D>& vertices,
+                  const std::vector<Index>& indices,
+                  std::vector<std::vector<Index>>& lods);
+
+}  // namespace Wiesel::MeshOptimizer
@@ -0,0 +1,72 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// Hierarchical depth pyramid built from the previous frame's depth.
+// The gpu writes a max-reduced (WIESEL_HIZ_DOWNSAMPLE x) linear depth image
+// which is copied to a readback buffer, the rest of the chain is built here.
+// Since we wait for the frame fence before starting the next frame,
+// the readback of frame N is ready when we record frame N+1 without stalling.
+class HiZPyramid {
+ public:
+  HiZPyramid() = default;
+  ~HiZPyramid() = default;
+
+  // Called when the downsample + copy is recorded, these are the matrices
+  // the depth in the readback buffer will belong to. Width and height is the
+  // area that was rendered, which is smaller than the image when the render
+  // scale is below 1.
+  void OnRecorded(const glm::mat4& view_projection, float near_plane,
+                  float far_plane, uint32_t width, uint32_t height);
+  // Rebuilds the pyramid from the readback buffer if a copy was recorded,
+  // stride is the width of the whole image in texels.
+  void Update(const float* data, uint32_t stride);
+  void Invalidate();
+
+  // Returns false if the pyramid is missing or the camera moved too much
+  // since it was captured (i.e. a camera cut), culling would just pop then.
+  WIESEL_GETTER_FN bool IsUsableFor(const glm::mat4& view_projection) const;
+
+  // Tests the object space bounds transformed by model against the pyramid,
+  // conservative, returns false whenever it's not sure.
+  WIESEL_GETTER_FN bool IsOccluded(const glm::vec3& bounds_min,
+                                   const glm::vec3& bounds_max,
+                                   const glm::mat4& model) const;
+
+ private:
+  float LinearDepth(float depth) const;
+
+  struct Level {
+    uint32_t width;
+    uint32_t height;
+    std::vector<float> depths;
+  };
+
+  std::vector<Level> levels_;
+  glm::mat4 view_projection_{1.0f};
+  float near_plane_ = 0.01f;
+  float far_plane_ = 1000.0f;
+  bool valid_ = false;
+
+  glm::mat4 pending_view_projection_{1.0f};
+  float pending_near_plane_ = 0.01f;
+  float pending_far_plane_ = 1000.0f;
+  uint32_t pending_width_ = 0;
+  uint32_t pending_height_ = 0;
+  bool pending_ = false;
+};
+
+}  // namespace Wiesel
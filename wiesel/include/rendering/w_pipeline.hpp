@@ -36,16 +36,19 @@ struct PushConstant {
   Ref<void> ref;
 };
 
-struct Pipeline {
+struct Pipeline : public std::enable_shared_from_this<Pipeline> {
   explicit Pipeline(PipelineProperties properties);
   ~Pipeline();
 
-  void SetRenderPass(Ref<RenderPass> pass);
+  // Not needed for compute pipelines, a pipeline with a single compute
+  // shader is baked as a compute pipeline
+  void SetRenderPass(Ref<RenderPass> pass, uint32_t subpass = 0);
   void AddInputLayout(Ref<DescriptorSetLayout> layout);
   void AddDynamicState(VkDynamicState state);
   void AddShader(Ref<Shader> shader);
   template<typename T>
   void AddShader(Ref<Shader> shader, T* data, std::vector<VkSpecializationMapEntry> mapEntries) {
+    shader->pipelines_.push_back(weak_from_this());
     shaders_.push_back({
         .shader = shader,
         .specialization = {
@@ -69,9 +72,6 @@ struct Pipeline {
     });
   }
 
-  void Bake();
-
-  void Bind(PipelineBindPoint bind_point);
   struct SpecializationData {
     std::vector<VkSpecializationMapEntry> map_entries;
     size_t data_size;
@@ -81,10 +81,37 @@ struct Pipeline {
     Ref<Shader> shader;
     SpecializationData specialization;
   };
+  // Copy of everything CreateHandles reads. Holding it keeps the render pass
+  // and the descriptor layouts alive, and the pipeline can be changed and
+  // baked again while handles are created from it on another thread.
+  struct CreateState {
+    PipelineProperties properties;
+    std::vector<ShaderInfo> shaders;
+    std::vector<VkDynamicState> dynamic_states;
+    Ref<RenderPass> render_pass;
+    uint32_t subpass;
+    std::vector<Ref<DescriptorSetLayout>> descriptor_layouts;
+    bool has_vertex_binding;
+    std::vector<VkVertexInputBindingDescription> vertex_input_binding_descriptions;
+    std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions;
+    std::vector<PushConstant> push_constants;
+  };
+
+  void Bake();
+  WIESEL_GETTER_FN CreateState GetCreateState() const;
+  // Creates new handles from state without touching any baked ones, modules
+  // are used in place of the shaders' in shaders order. The shader hot reload
+  // worker calls it with a state taken on the main thread.
+  static void CreateHandles(const CreateState& state,
+                            const std::vector<VkShaderModule>& modules,
+                            VkPipelineLayout& layout, VkPipeline& pipeline);
+
+  void Bind(PipelineBindPoint bind_point);
   PipelineProperties properties_;
   std::vector<ShaderInfo> shaders_;
   std::vector<VkDynamicState> dynamic_states_;
   Ref<RenderPass> m_RenderPass;
+  uint32_t subpass_ = 0;
   std::vector<Ref<DescriptorSetLayout>> descriptor_layouts_;
   VkPipelineLayout layout_{};
   VkPipeline pipeline_{};
@@ -93,6 +120,9 @@ struct Pipeline {
   std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions_;
   std::vector<PushConstant> push_constants_;
   bool is_allocated_ = false;
+  // Incremented by every Bake, hot reloaded handles baked against an older
+  // version are thrown away
+  uint32_t bake_version_ = 0;
 };
 
 }  // namespace Wiesel
\ No newline at end of file
@@ -19,10 +19,15 @@
 
 #include "rendering/w_buffer.hpp"
 #include "rendering/w_camera.hpp"
+#include "rendering/w_clusters.hpp"
 #include "rendering/w_command.hpp"
 #include "rendering/w_descriptor.hpp"
 #include "rendering/w_framebuffer.hpp"
+#include "rendering/w_impostor.hpp"
 #include "rendering/w_mesh.hpp"
+#include "rendering/w_resolution_scale.hpp"
+#include "rendering/w_shaderlibrary.hpp"
+#include "rendering/w_shaderreloader.hpp"
 #include "rendering/w_texture.hpp"
 #include "rendering/w_sprite.hpp"
 #include "scene/w_components.hpp"
@@ -38,12 +43,56 @@
 
 namespace Wiesel {
 
+// Mesh pipelines push the MaterialFlag bits of each draw's material
+struct GeometryPipelinePushConstant {
+  uint32_t material_flags;
+};
+
 struct ShadowPipelinePushConstant {
   int cascade_index;
+  uint32_t material_flags;
+};
+
+struct ImpostorBakePushConstant {
+  glm::mat4 view_projection;
+  uint32_t material_flags;
+};
+
+struct CompositePipelinePushConstant {
+  glm::vec2 uv_scale;
 };
 
+#ifdef ID_BUFFER_PASS
+struct IDPipelinePushConstant {
+  uint32_t id;
+  uint32_t material_flags;
+};
+#endif
+
 struct RendererProperties {};
 
+// Post-process anti-aliasing of the lighting output, lets the g-buffer stay
+// at 1x msaa.
+enum class AntiAliasing { None, FXAA, TAA };
+
+// Swap chain resources replaced by a recreation. Kept alive until the frames
+// that may still present from or render into them are finished.
+struct RetiredSwapChain {
+  VkSwapchainKHR swap_chain;
+  Ref<AttachmentTexture> texture;
+  Ref<AttachmentTexture> color_image;
+  Ref<AttachmentTexture> depth_stencil;
+  std::vector<Ref<Framebuffer>> framebuffers;
+  uint32_t retired_frame;
+};
+
+// Render targets, framebuffers and descriptors of a camera that
+// Renderer::SetupCameraComponent replaced, released like a retired swap chain
+struct RetiredCameraResources {
+  CameraResources resources;
+  uint32_t retired_frame;
+};
+
 class Renderer {
  public:
   explicit Renderer(Ref<AppWindow> window);
@@ -62,6 +111,16 @@ class Renderer {
   Ref<UniformBuffer> CreateUniformBuffer(VkDeviceSize size);
   void DestroyUniformBuffer(UniformBuffer& buffer);
 
+  // Usage can be changed to read the same host visible memory as something
+  // else, like per instance vertex data
+  Ref<StorageBuffer> CreateStorageBuffer(
+      VkDeviceSize size,
+      VkBufferUsageFlags usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT);
+  void DestroyStorageBuffer(StorageBuffer& buffer);
+
+  Ref<ReadbackBuffer> CreateReadbackBuffer(VkDeviceSize size);
+  void DestroyReadbackBuffer(ReadbackBuffer& buffer);
+
   void SetupCameraComponent(CameraComponent& component);
 
   Ref<Texture> CreateBlankTexture();
@@ -93,6 +152,15 @@ class Renderer {
 
   Ref<DescriptorSet> CreateShadowMeshDescriptors(
       Ref<UniformBuffer> uniformBuffer, Ref<Material> material);
+  // Registers the buffers and descriptors of an allocated mesh for drawing
+  MeshHandle CreateMeshHandle(const Mesh& mesh);
+  void DestroyMeshHandle(MeshHandle handle);
+  // Renders the views of an impostor atlas for the allocated meshes of the
+  // model, waits for the gpu. Returns null if the model has no meshes.
+  Ref<Impostor> CreateImpostor(const Model& model);
+  // Same as CreateImpostor but models loaded from the same path share one
+  // atlas, it's only baked for the first of them.
+  Ref<Impostor> GetOrCreateImpostor(const Model& model);
 
   Ref<DescriptorSet> CreateGlobalDescriptors(CameraComponent& camera);
   Ref<DescriptorSet> CreateShadowGlobalDescriptors(CameraComponent& camera);
@@ -104,7 +172,12 @@ class Renderer {
 
   void RecreatePipeline(Ref<Pipeline> pipeline);
 
+  // Takes the permutation from the shader library when it's baked there,
+  // glslang only runs for shaders missing from it
   Ref<Shader> CreateShader(ShaderProperties properties);
+  WIESEL_GETTER_FN const ShaderLibrary& GetShaderLibrary() const {
+    return *shader_library_;
+  }
 
   void SetClearColor(float r, float g, float b, float a = 1.0f);
   void SetClearColor(const Colorf& color);
@@ -124,6 +197,102 @@ class Renderer {
   WIESEL_GETTER_FN bool* IsSSAOEnabledPtr() { return &enable_ssao_; }
   WIESEL_GETTER_FN bool IsOnlySSAO() { return only_ssao_; }
   WIESEL_GETTER_FN bool* IsOnlySSAOPtr() { return &only_ssao_; }
+  // Accumulates half resolution SSAO over frames instead of blurring it
+  // at full resolution every frame.
+  void SetSSAOTemporalEnabled(bool value) { enable_ssao_temporal_ = value; }
+  WIESEL_GETTER_FN bool IsSSAOTemporalEnabled() const {
+    return enable_ssao_temporal_;
+  }
+  WIESEL_GETTER_FN bool* IsSSAOTemporalEnabledPtr() {
+    return &enable_ssao_temporal_;
+  }
+  // Renders lighting as a second subpass of the geometry pass so the g-buffer
+  // never leaves tile memory. Needs 1x msaa and is skipped while the camera
+  // draws SSAO, SSAO has to sample the g-buffer between the two passes.
+  void SetFusedLightingEnabled(bool value) { enable_fused_lighting_ = value; }
+  WIESEL_GETTER_FN bool IsFusedLightingEnabled() const { return enable_fused_lighting_; }
+  WIESEL_GETTER_FN bool* IsFusedLightingEnabledPtr() { return &enable_fused_lighting_; }
+  WIESEL_GETTER_FN bool IsFusedLightingActive() const {
+    return enable_fused_lighting_ && geometry_lighting_render_pass_ &&
+           camera_ && !(enable_ssao_ && camera_->enable_ssao) &&
+           camera_->resources &&
+           camera_->resources->geometry_lighting_framebuffer;
+  }
+  // Lets a single on screen camera composite into the swapchain image in the
+  // present pass instead of going through composite_color_image.
+  void SetDirectCompositeEnabled(bool value) { enable_direct_composite_ = value; }
+  WIESEL_GETTER_FN bool IsDirectCompositeEnabled() const { return enable_direct_composite_; }
+  WIESEL_GETTER_FN bool* IsDirectCompositeEnabledPtr() { return &enable_direct_composite_; }
+  // Decided by the scene every frame, reset in BeginRender
+  void SetCompositeInPresent(bool value) { composite_in_present_ = value; }
+  WIESEL_GETTER_FN bool IsCompositeInPresent() const { return composite_in_present_; }
+  // Records the fullscreen passes into secondary command buffers once and
+  // replays them every frame, see ExecuteStaticPass.
+  void SetStaticPassesEnabled(bool value) { enable_static_passes_ = value; }
+  WIESEL_GETTER_FN bool IsStaticPassesEnabled() const { return enable_static_passes_; }
+  WIESEL_GETTER_FN bool* IsStaticPassesEnabledPtr() { return &enable_static_passes_; }
+  // Forces every recorded pass to be recorded again, for changes the
+  // renderer can't see such as a new skybox
+  void InvalidateStaticPasses() { static_pass_version_++; }
+  // Builds Hi-Z on a separate compute queue so it overlaps the rest of the
+  // frame. Needs a second queue and timeline semaphores, the fragment pass
+  // is used otherwise.
+  void SetAsyncComputeEnabled(bool value) { enable_async_compute_ = value; }
+  WIESEL_GETTER_FN bool IsAsyncComputeEnabled() const { return enable_async_compute_; }
+  WIESEL_GETTER_FN bool* IsAsyncComputeEnabledPtr() { return &enable_async_compute_; }
+  // Recompiles internal shaders when their sources change, applied in BeginRender
+  void SetShaderHotReloadEnabled(bool value) { enable_shader_hot_reload_ = value; }
+  WIESEL_GETTER_FN bool IsShaderHotReloadEnabled() const { return enable_shader_hot_reload_; }
+  WIESEL_GETTER_FN bool* IsShaderHotReloadEnabledPtr() { return &enable_shader_hot_reload_; }
+  WIESEL_GETTER_FN bool IsAsyncComputeActive() const {
+    return enable_async_compute_ && compute_queue_ != VK_NULL_HANDLE;
+  }
+  void SetOcclusionCullingEnabled(bool value) { enable_occlusion_culling_ = value; }
+  WIESEL_GETTER_FN bool IsOcclusionCullingEnabled() const { return enable_occlusion_culling_; }
+  WIESEL_GETTER_FN bool* IsOcclusionCullingEnabledPtr() { return &enable_occlusion_culling_; }
+  // Draws models that are smaller than the screen size on screen with their
+  // impostor, see Model::enable_impostor.
+  // TAA jitters the projection every frame and accumulates the lighting
+  // output over frames, FXAA blurs the edges it finds in a single frame.
+  void SetAntiAliasing(AntiAliasing value);
+  WIESEL_GETTER_FN AntiAliasing GetAntiAliasing() const { return anti_aliasing_; }
+  void SetImpostorsEnabled(bool value) { enable_impostors_ = value; }
+  WIESEL_GETTER_FN bool IsImpostorsEnabled() const { return enable_impostors_; }
+  WIESEL_GETTER_FN bool* IsImpostorsEnabledPtr() { return &enable_impostors_; }
+  void SetImpostorScreenSize(float value) { impostor_screen_size_ = value; }
+  WIESEL_GETTER_FN float GetImpostorScreenSize() const { return impostor_screen_size_; }
+  WIESEL_GETTER_FN float* GetImpostorScreenSizePtr() { return &impostor_screen_size_; }
+  // Draws coarser levels of detail of a model as it gets smaller on screen.
+  // LOD1 starts below the LOD screen size, every further level at half the
+  // size of the previous one. Shadow cascades draw the level picked for the
+  // view plus the shadow LOD bias.
+  void SetMeshLodsEnabled(bool value) { enable_mesh_lods_ = value; }
+  WIESEL_GETTER_FN bool IsMeshLodsEnabled() const { return enable_mesh_lods_; }
+  WIESEL_GETTER_FN bool* IsMeshLodsEnabledPtr() { return &enable_mesh_lods_; }
+  void SetLodScreenSize(float value) { lod_screen_size_ = value; }
+  WIESEL_GETTER_FN float GetLodScreenSize() const { return lod_screen_size_; }
+  WIESEL_GETTER_FN float* GetLodScreenSizePtr() { return &lod_screen_size_; }
+  void SetShadowLodBias(int value) { shadow_lod_bias_ = value; }
+  WIESEL_GETTER_FN int GetShadowLodBias() const { return shadow_lod_bias_; }
+  WIESEL_GETTER_FN int* GetShadowLodBiasPtr() { return &shadow_lod_bias_; }
+  // Level of detail for a screen size, only moves away from current_lod once
+  // the size is past the switch point by WIESEL_LOD_HYSTERESIS
+  WIESEL_GETTER_FN uint32_t SelectLod(float screen_size,
+                                      uint32_t current_lod) const;
+
+  // Scales the deferred passes down when the gpu frame time goes over the
+  // target, attachments stay at full size and only the viewport shrinks.
+  void SetDynamicResolutionEnabled(bool value) { enable_dynamic_resolution_ = value; }
+  WIESEL_GETTER_FN bool IsDynamicResolutionEnabled() const { return enable_dynamic_resolution_; }
+  WIESEL_GETTER_FN bool* IsDynamicResolutionEnabledPtr() { return &enable_dynamic_resolution_; }
+  WIESEL_GETTER_FN float GetRenderScale() const {
+    return enable_dynamic_resolution_ ? resolution_scale_controller_.GetScale() : 1.0f;
+  }
+  WIESEL_GETTER_FN ResolutionScaleController& GetResolutionScaleController() {
+    return resolution_scale_controller_;
+  }
+  // Measured with timestamp queries, 0 if they aren't supported
+  WIESEL_GETTER_FN float GetGPUFrameTime() const { return gpu_frame_time_ms_; }
   void SetRecreatePipeline(bool value) { recreate_pipeline_ = value; }
   WIESEL_GETTER_FN bool IsRecreatePipeline() const { return recreate_pipeline_; }
 
@@ -148,7 +317,8 @@ class Renderer {
     return swap_chain_image_format_;
   }
 
-  WIESEL_GETTER_FN const Ref<CameraData> GetCameraData()
+  // Camera of the last rendered view, null if the scene had no camera
+  WIESEL_GETTER_FN const CameraData* GetCameraData()
       const {
     return camera_;
   }
@@ -177,10 +347,34 @@ class Renderer {
     return ssao_blur_vert_pipeline_;
   }
 
+  WIESEL_GETTER_FN const Ref<Pipeline> GetSSAOTemporalPipeline() const {
+    return ssao_temporal_pipeline_;
+  }
+
+  WIESEL_GETTER_FN const Ref<Pipeline> GetHiZPipeline() const {
+    return hiz_pipeline_;
+  }
+
   WIESEL_GETTER_FN const Ref<Pipeline> GetLightingPipeline() const {
     return lighting_pipeline_;
   }
 
+  WIESEL_GETTER_FN const Ref<Pipeline> GetFusedSkyboxPipeline() const {
+    return fused_skybox_pipeline_;
+  }
+
+  WIESEL_GETTER_FN const Ref<Pipeline> GetFusedLightingPipeline() const {
+    return fused_lighting_pipeline_;
+  }
+
+  WIESEL_GETTER_FN const Ref<Pipeline> GetFXAAPipeline() const {
+    return fxaa_pipeline_;
+  }
+
+  WIESEL_GETTER_FN const Ref<Pipeline> GetTAAPipeline() const {
+    return taa_pipeline_;
+  }
+
   WIESEL_GETTER_FN const Ref<Pipeline> GetSpritePipeline() const {
     return sprite_pipeline_;
   }
@@ -193,6 +387,10 @@ class Renderer {
     return present_pipeline_;
   }
 
+  WIESEL_GETTER_FN const Ref<Pipeline> GetPresentCompositePipeline() const {
+    return present_composite_pipeline_;
+  }
+
   WIESEL_GETTER_FN const Ref<Sampler> GetDefaultLinearSampler() const {
     return default_linear_sampler_;
   }
@@ -218,29 +416,87 @@ class Renderer {
 
   void DrawModel(ModelComponent& model, const TransformComponent& transform,
                  bool shadowPass);
-  void DrawMesh(std::shared_ptr<Mesh> mesh, const TransformComponent& transform, bool shadowPass);
-  void DrawSprite(SpriteComponent& sprite, const TransformComponent& transform);
-  void DrawSkybox(std::shared_ptr<Skybox> skybox);
+  // lod is clamped to the levels the mesh has
+  void DrawMesh(Mesh& mesh, const glm::mat4& transform_matrix,
+                const glm::mat3& normal_matrix, bool shadowPass,
+                uint32_t lod = 0);
+  void DrawMesh(MeshHandle handle, const glm::mat4& transform_matrix,
+                const glm::mat3& normal_matrix, bool shadowPass,
+                uint32_t lod = 0);
+  void DrawSprite(SpriteAsset& sprite, uint32_t frame_index,
+                  const glm::mat4& transform_matrix);
+  // Impostors are batched, queued ones are drawn with one instanced draw per
+  // atlas by DrawImpostors. Should be called inside the geometry pass.
+  void QueueImpostor(Impostor& impostor, const glm::mat4& transform_matrix);
+  void DrawImpostors();
+  void DrawSkybox(Skybox& skybox);
   void DrawFullscreen(std::shared_ptr<Pipeline> pipeline, std::initializer_list<std::shared_ptr<DescriptorSet>> descriptors);
+  // Has to be called right after beginning one of the SSAO, lighting or
+  // composite passes. Calls record to fill commands if they are stale and
+  // executes them, or calls it inline if static passes are disabled.
+  void ExecuteStaticPass(StaticPassCommands& commands,
+                         const std::function<void()>& record);
 
   void BeginRender();
+  // Should be called after lights_uniform_data_ or point_lights_ are modified
+  void MarkLightsChanged() { lights_version_++; }
   void UpdateUniformData();
   void BeginShadowPass(uint32_t cascade);
   void EndShadowPass();
 #ifdef ID_BUFFER_PASS
+  // GPU picking. The next rendered frame of the given camera draws mesh ids
+  // into a WIESEL_PICK_REGION_SIZE square around uv, which is in [0, 1] over
+  // the camera's image. The region is copied to a readback buffer and read
+  // after the frame fence, TakePickResult returns it a frame later.
+  void RequestPick(const CameraResources* camera, glm::vec2 uv);
+  WIESEL_GETTER_FN const CameraResources* GetPickCamera() const {
+    return pick_requested_ ? pick_camera_ : nullptr;
+  }
+  // Returns true once when a pick finished, id is RenderTransform::id of the
+  // hit closest to the cursor or 0 if there was none
+  bool TakePickResult(uint32_t& id);
   void BeginIDPass();
+  void DrawMeshID(MeshHandle handle, const glm::mat4& transform_matrix,
+                  const glm::mat3& normal_matrix, uint32_t id);
   void EndIDPass();
 #endif
   void BeginGeometryPass();
   void EndGeometryPass();
+  void BeginHiZPass();
+  void EndHiZPass();
+  // Submits everything recorded so far and builds the current camera's Hi-Z
+  // on the compute queue. Should be called after the last pass of the camera
+  // that reads the linear depth.
+  void SubmitHiZCompute();
   void BeginSSAOGenPass();
   void EndSSAOGenPass();
   void BeginSSAOBlurHorzPass();
   void EndSSAOBlurHorzPass();
   void BeginSSAOBlurVertPass();
   void EndSSAOBlurVertPass();
+  // Area of the current camera's attachments the deferred passes render into
+  VkExtent2D GetRenderExtent(uint32_t divisor = 1) const;
+  VkExtent2D GetHiZExtent() const;
+
+  void BeginSSAOTemporalPass();
+  void EndSSAOTemporalPass();
+
+  // Final SSAO output of the current camera, depends on the temporal toggle
+  Ref<AttachmentTexture> GetSSAOResultImage();
+  Ref<DescriptorSet> GetSSAOResultDescriptor();
   void BeginLightingPass();
   void EndLightingPass();
+  // Fused path, geometry is drawn before NextLightingSubpass and lighting after
+  void BeginGeometryLightingPass();
+  void NextLightingSubpass();
+  void EndGeometryLightingPass();
+  void BeginAntiAliasingPass();
+  void EndAntiAliasingPass();
+
+  // Lighting output of the current camera after anti-aliasing, what the
+  // composite reads
+  Ref<AttachmentTexture> GetSceneColorImage();
+  Ref<DescriptorSet> GetSceneColorDescriptor();
   void BeginSpritePass();
   void EndSpritePass();
   void BeginCompositePass();
@@ -249,7 +505,7 @@ class Renderer {
   bool BeginPresent();
   void EndPresent();
 
-  void SetCameraData(Ref<CameraData> camera);
+  void SetCameraData(const CameraData* camera);
 
   void RecreateSwapChain();
   void Cleanup();
@@ -296,19 +552,42 @@ class Renderer {
   void PickPhysicalDevice();
   void CreateLogicalDevice();
   void CreateDescriptorLayouts();
-  void CreateSwapChain();
+  void CreateSwapChain(VkSwapchainKHR old_swap_chain = VK_NULL_HANDLE);
   void CreateGeometryRenderPass();
   void CreateGeometryGraphicsPipelines();
   void CreatePresentGraphicsPipelines();
   void CreateCommandPools();
   void CreateCommandBuffers();
   void CreatePermanentResources();
+  // Ends and submits command_buffer_ and begins a new one, returns the
+  // graphics timeline value the submitted work signals
+  uint64_t SubmitGraphicsCommands();
+  void CopyHiZToReadback(VkCommandBuffer command_buffer);
+  void CopyImageToReadback(VkCommandBuffer command_buffer,
+                           const AttachmentTexture& image,
+                           const ReadbackBuffer& buffer);
+  void BeginStaticPass(Ref<RenderPass> pass, Ref<Framebuffer> framebuffer,
+                       const Colorf& clear_color, VkExtent2D render_area,
+                       VkExtent2D viewport);
   void CreateSyncObjects();
+  void CreateTimestampQueries();
+  void ReadTimestampQueries();
+#ifdef ID_BUFFER_PASS
+  void ReadPickResult();
+#endif
   void CreateGlobalUniformBuffers();
   void CleanupGeometryGraphics();
   void CleanupPresentGraphics();
+  void DestroyRetiredResources(bool force);
   void CleanupDescriptorLayouts();
   void CleanupGlobalUniformBuffers();
+  // Points binding 3 of the camera's global descriptor at a shadow map
+  void BindShadowMap(CameraResources& camera,
+                     const Ref<AttachmentTexture>& image,
+                     const Ref<ImageView>& view);
+  void CreateBlankShadowMap();
+  void TransitionBoundShadowMap(VkImageLayout old_layout,
+                                VkImageLayout new_layout);
   int32_t RateDeviceSuitability(VkPhysicalDevice device);
   bool IsDeviceSuitable(VkPhysicalDevice device);
   VkSurfaceFormatKHR ChooseSwapSurfaceFormat(
@@ -322,6 +601,7 @@ class Renderer {
   void EndSingleTimeCommands(VkCommandBuffer commandBuffer);
   uint32_t FindMemoryType(uint32_t typeFilter,
                           VkMemoryPropertyFlags properties);
+  bool HasMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
 
   std::vector<const char*> GetRequiredExtensions();
   QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
@@ -372,6 +652,8 @@ class Renderer {
   bool initialized_;
   Ref<AppWindow> window_;
   VkInstance instance_{};
+  // Version the instance was created with, at most 1.2
+  uint32_t instance_api_version_ = VK_API_VERSION_1_0;
   VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
   VkDevice logical_device_{};
   VkSurfaceKHR surface_{};
@@ -383,38 +665,101 @@ class Renderer {
   uint32_t image_index_;
   VkFormat swap_chain_image_format_;
   Ref<AttachmentTexture> swap_chain_texture_;
+  std::vector<RetiredSwapChain> retired_swap_chains_;
+  std::vector<RetiredCameraResources> retired_camera_resources_;
+  // Retired resources are only released once their frames are done, so the
+  // idle wait in DestroyAttachmentTexture and DestroyReadbackBuffer is skipped
+  // for them
+  bool destroying_retired_ = false;
 
   VkExtent2D extent_{};
 
   Ref<CommandPool> command_pool_;
   Ref<CommandBuffer> command_buffer_;
+  // Primaries a frame records into, reused every frame. The frame starts in
+  // the first one and SubmitGraphicsCommands moves on to the next, so one
+  // camera with async Hi-Z uses a pair and more cameras grow the list.
+  std::vector<Ref<CommandBuffer>> frame_command_buffers_;
+  uint32_t frame_command_buffer_index_ = 0;
+
+  bool enable_async_compute_;
+  bool enable_shader_hot_reload_;
+  VkQueue compute_queue_ = VK_NULL_HANDLE;
+  Ref<CommandPool> compute_command_pool_;
+  std::vector<Ref<CommandBuffer>> compute_command_buffers_;
+  VkSemaphore graphics_timeline_semaphore_ = VK_NULL_HANDLE;
+  VkSemaphore compute_timeline_semaphore_ = VK_NULL_HANDLE;
+  uint64_t graphics_timeline_value_ = 0;
+  uint64_t compute_timeline_value_ = 0;
+  // Compute work the next graphics submit has to wait for
+  uint64_t graphics_wait_compute_value_ = 0;
+  // Released by the compute queue, acquired back at the start of the frame
+  std::vector<Ref<AttachmentTexture>> hiz_acquire_images_;
 
   VkSemaphore image_available_semaphore_;
   VkSemaphore render_finished_semaphore_;
   VkFence fence_;
 
+  VkQueryPool timestamp_query_pool_ = VK_NULL_HANDLE;
+  // Bits of a timestamp the graphics queue actually writes
+  uint64_t timestamp_valid_mask_ = ~0ull;
+  float gpu_frame_time_ms_ = 0.0f;
+  bool enable_dynamic_resolution_;
+  ResolutionScaleController resolution_scale_controller_;
+
   float_t aspect_ratio_;
   WindowSize window_size_;
   VkSampleCountFlagBits msaa_samples_;
   VkSampleCountFlagBits previous_msaa_samples_;
   Colorf clear_color_;
   bool enable_vsync_;
-  Ref<UniformBuffer> lights_uniform_buffer_;
   LightsUniformData lights_uniform_data_;
-  Ref<UniformBuffer> camera_uniform_buffer_;
-  Ref<UniformBuffer> shadow_camera_uniform_buffer_;
+  std::vector<LightPoint> point_lights_;
+  // Point lights whose range intersects the current camera's frustum
+  std::vector<LightPoint> visible_point_lights_;
+  HandlePool<MeshDrawData> mesh_pool_;
+  uint64_t lights_version_ = 1;
+  LightClusterGrid light_cluster_grid_;
   Ref<UniformBuffer> ssao_kernel_uniform_buffer_;
   CameraUniformData camera_uniform_data_;
   ShadowMapMatricesUniformData shadow_camera_uniform_data_;
   SSAOKernelUniformData ssao_kernel_uniform_data_;
   bool enable_wireframe_;
   bool enable_ssao_;
+  bool enable_ssao_temporal_;
   bool only_ssao_;
+  // Used to rotate the SSAO kernel between frames
+  uint32_t frame_index_ = 0;
+  bool enable_occlusion_culling_;
+  bool enable_impostors_;
+  float impostor_screen_size_;
+  bool enable_mesh_lods_;
+  float lod_screen_size_;
+  int shadow_lod_bias_;
+  AntiAliasing anti_aliasing_;
+  bool enable_fused_lighting_;
+  bool enable_static_passes_;
+  // Recorded passes older than this are recorded again
+  uint64_t static_pass_version_;
+  // Settings the recorded passes depend on, checked every frame since the
+  // editor writes them through pointers
+  bool static_pass_ssao_temporal_;
+  bool static_pass_only_ssao_;
+  // Pass begun by BeginStaticPass
+  VkRenderPass static_pass_render_pass_;
+  VkFramebuffer static_pass_framebuffer_;
+  VkExtent2D static_pass_viewport_;
+  bool enable_direct_composite_;
+  bool composite_in_present_;
   bool recreate_pipeline_;
   bool recreate_swap_chain_;
 
-  Ref<CameraData> camera_;
+  const CameraData* camera_ = nullptr;
+  CameraData camera_data_;
   glm::vec2 viewport_size_;
+  // viewport_size_ scaled by the camera's render scale, deferred passes
+  // render into the top left area of this size.
+  glm::vec2 render_size_;
 
   Ref<DescriptorSetLayout> geometry_mesh_descriptor_layout_;
   Ref<DescriptorSetLayout> shadow_mesh_descriptor_layout_;
@@ -423,26 +768,66 @@ class Renderer {
   Ref<DescriptorSetLayout> ssao_gen_descriptor_layout_;
   Ref<DescriptorSetLayout> ssao_blur_descriptor_layout_;
   Ref<DescriptorSetLayout> ssao_output_descriptor_layout_;
+  Ref<DescriptorSetLayout> ssao_temporal_descriptor_layout_;
+  Ref<DescriptorSetLayout> taa_descriptor_layout_;
   Ref<DescriptorSetLayout> geometry_output_descriptor_layout_;
+  Ref<DescriptorSetLayout> geometry_input_descriptor_layout_;
   Ref<DescriptorSetLayout> sprite_draw_descriptor_layout_;
+  Ref<DescriptorSetLayout> impostor_descriptor_layout_;
 
 #ifdef ID_BUFFER_PASS
   Ref<RenderPass> id_render_pass_;
   Ref<Pipeline> id_pipeline_;
+  Ref<IDPipelinePushConstant> id_pipeline_push_constant_;
+  Ref<ReadbackBuffer> pick_readback_buffer_;
+  const CameraResources* pick_camera_ = nullptr;
+  glm::vec2 pick_uv_{0.0f};
+  // Waiting for the camera to render
+  bool pick_requested_ = false;
+  // Copy recorded, read once the frame fence passed
+  bool pick_in_flight_ = false;
+  bool pick_ready_ = false;
+  uint32_t pick_result_ = 0;
 #endif
 
   Ref<RenderPass> geometry_render_pass_;
   Ref<Pipeline> geometry_pipeline_;
+  Ref<GeometryPipelinePushConstant> geometry_pipeline_push_constant_;
 
   Ref<RenderPass> shadow_render_pass_;
   Ref<Pipeline> shadow_pipeline_;
   Ref<ShadowPipelinePushConstant> shadow_pipeline_push_constant_;
+  Ref<CompositePipelinePushConstant> composite_pipeline_push_constant_;
 
   Ref<RenderPass> lighting_render_pass_;
   Ref<DescriptorSetLayout> skybox_descriptor_layout_;
   Ref<Pipeline> skybox_pipeline_;
   Ref<Pipeline> lighting_pipeline_;
 
+  // Only created with 1x msaa
+  Ref<RenderPass> geometry_lighting_render_pass_;
+  Ref<Pipeline> fused_geometry_pipeline_;
+  Ref<Pipeline> fused_skybox_pipeline_;
+  Ref<Pipeline> fused_lighting_pipeline_;
+
+  Ref<RenderPass> impostor_bake_render_pass_;
+  Ref<Pipeline> impostor_bake_pipeline_;
+  Ref<ImpostorBakePushConstant> impostor_bake_push_constant_;
+  Ref<Pipeline> impostor_pipeline_;
+  Ref<Pipeline> fused_impostor_pipeline_;
+  Ref<StorageBuffer> impostor_instance_buffer_;
+  std::vector<std::pair<Impostor*, glm::mat4>> queued_impostors_;
+  // Keyed by Model::model_path
+  std::unordered_map<std::string, Ref<Impostor>> impostor_cache_;
+  // Instances written to impostor_instance_buffer_ this frame, every camera
+  // appends after the last one. Reset in BeginRender.
+  uint32_t impostor_instance_count_ = 0;
+
+  Ref<RenderPass> hiz_render_pass_;
+  Ref<Pipeline> hiz_pipeline_;
+  Ref<Pipeline> hiz_compute_pipeline_;
+  Ref<DescriptorSetLayout> hiz_compute_descriptor_layout_;
+
   Ref<RenderPass> ssao_gen_render_pass_;
   Ref<Pipeline> ssao_gen_pipeline_;
 
@@ -450,6 +835,12 @@ class Renderer {
   Ref<Pipeline> ssao_blur_horz_pipeline_;
   Ref<RenderPass> ssao_blur_vert_render_pass_;
   Ref<Pipeline> ssao_blur_vert_pipeline_;
+  Ref<RenderPass> ssao_temporal_render_pass_;
+  Ref<Pipeline> ssao_temporal_pipeline_;
+
+  Ref<RenderPass> anti_aliasing_render_pass_;
+  Ref<Pipeline> fxaa_pipeline_;
+  Ref<Pipeline> taa_pipeline_;
 
   Ref<RenderPass> sprite_render_pass_;
   Ref<Pipeline> sprite_pipeline_;
@@ -460,13 +851,18 @@ class Renderer {
   Ref<RenderPass> present_render_pass_;
   Ref<DescriptorSetLayout> present_descriptor_layout_;
   Ref<Pipeline> present_pipeline_;
+  Ref<Pipeline> present_composite_pipeline_;
   Ref<AttachmentTexture> present_color_image_;
   Ref<AttachmentTexture> present_depth_stencil_;
   std::vector<Ref<Framebuffer>> present_framebuffers_;
 
   Ref<Sampler> default_linear_sampler_;
   Ref<Sampler> default_nearest_sampler_;
+  Ref<Sampler> shadow_compare_sampler_;
   Ref<Texture> blank_texture_;
+  // Bound to binding 3 of the global descriptor when a camera has no shadows
+  Ref<AttachmentTexture> blank_shadow_map_;
+  Ref<ImageView> blank_shadow_view_;
   Ref<MemoryBuffer> quad_vertex_buffer_;
   Ref<IndexBuffer> quad_index_buffer_;
   Ref<AttachmentTexture> ssao_noise_;
@@ -475,7 +871,10 @@ class Renderer {
   SwapChainSupportDetails swap_chain_details_;
   VkPhysicalDeviceProperties physical_device_properties_;
   VkPhysicalDeviceFeatures physical_device_features_;
-  std::vector<std::string> shader_features_;
+  Ref<ShaderLibrary> shader_library_;
+  // Everything CreateShader made, handed to the reloader when it starts
+  std::vector<std::weak_ptr<Shader>> shaders_;
+  Ref<ShaderReloader> shader_reloader_;
 
   TracyVkCtx tracy_ctx_;
 };
@@ -0,0 +1,90 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "rendering/w_camera.hpp"
+#include "rendering/w_mesh.hpp"
+#include "rendering/w_skybox.hpp"
+#include "rendering/w_sprite.hpp"
+#include "scene/w_lights.hpp"
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+struct RenderTransform {
+  glm::mat4 transform_matrix;
+  glm::mat3 normal_matrix;
+  // Entity the transform belongs to plus one, written to the ID buffer where
+  // 0 means nothing was hit
+  uint32_t id;
+};
+
+struct RenderMesh {
+  MeshHandle mesh;
+  // Object space, copied so culling doesn't touch the mesh
+  glm::vec3 bounds_min;
+  glm::vec3 bounds_max;
+  uint32_t transform_index;
+  bool casts_shadows;
+};
+
+// Meshes of a model are the [first_mesh, first_mesh + mesh_count) range of
+// RenderPacket::meshes
+struct RenderModel {
+  // Null if the model has no impostor
+  Impostor* impostor;
+  uint32_t transform_index;
+  uint32_t first_mesh;
+  uint32_t mesh_count;
+  // Object space bounding sphere of the meshes, picks the level of detail
+  glm::vec3 center;
+  float radius;
+};
+
+struct RenderSprite {
+  SpriteAsset* sprite;
+  uint32_t frame_index;
+  uint32_t transform_index;
+};
+
+// Everything the renderer needs for a frame, extracted from the scene after
+// OnUpdate. Rendering only reads this, so it never touches the registry.
+// Pointers stay valid until the destroy queue is processed after present.
+struct RenderPacket {
+  std::vector<CameraData> cameras;
+  // Cameras that are not due this frame, they keep their last image
+  uint32_t skipped_cameras = 0;
+  std::vector<RenderTransform> transforms;
+  std::vector<RenderMesh> meshes;
+  std::vector<RenderModel> models;
+  std::vector<RenderSprite> sprites;
+  Skybox* skybox = nullptr;
+
+  // Only rebuilt when a light changes, lights_changed is cleared once the
+  // renderer has taken them.
+  LightsUniformData lights;
+  std::vector<LightPoint> point_lights;
+  bool lights_changed = false;
+
+  // Keeps the capacity so extraction doesn't allocate every frame
+  void Clear() {
+    cameras.clear();
+    skipped_cameras = 0;
+    transforms.clear();
+    meshes.clear();
+    models.clear();
+    sprites.clear();
+    skybox = nullptr;
+  }
+};
+
+}  // namespace Wiesel
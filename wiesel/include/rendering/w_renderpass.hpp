@@ -27,7 +27,10 @@ enum class PassType {
   PostProcess,
   Lighting,
   Shadow,
-  Present
+  Present,
+  // Geometry in the first subpass, lighting reads the g-buffer as input
+  // attachments in the second one. Last color attachment is the lighting output.
+  GeometryLighting
 };
 
 enum PipelineBindPoint {
@@ -53,8 +56,19 @@ class RenderPass {
   void Bake();
 
   void Begin(Ref<Framebuffer> framebuffer, const Colorf& clear_color);
+  // Only clears, renders and resolves the given top left area of the framebuffer
+  void Begin(Ref<Framebuffer> framebuffer, const Colorf& clear_color,
+             VkExtent2D render_area,
+             VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+  // One clear color for each color attachment, in attachment order
+  void Begin(Ref<Framebuffer> framebuffer, std::span<const Colorf> clear_colors,
+             VkExtent2D render_area,
+             VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE);
+  void NextSubpass();
   void End();
 
+  WIESEL_GETTER_FN uint32_t GetColorAttachmentCount(uint32_t subpass) const;
+
   Ref<Framebuffer> CreateFramebuffer(uint32_t index, std::span<AttachmentTexture*> output_attachments, glm::vec2 extent);
   Ref<Framebuffer> CreateFramebuffer(uint32_t index, std::span<ImageView*> output_views, glm::vec2 extent);
   Ref<Framebuffer> CreateFramebuffer(uint32_t index, std::initializer_list<Ref<ImageView>> output_views, glm::vec2 extent);
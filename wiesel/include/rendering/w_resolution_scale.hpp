@@ -0,0 +1,52 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// Picks the render scale of the deferred passes from the measured gpu frame
+// time. Scale moves in fixed steps and waits for the frame time to settle
+// after every change, so history based effects aren't reset every frame.
+class ResolutionScaleController {
+ public:
+  ResolutionScaleController() = default;
+  ~ResolutionScaleController() = default;
+
+  void Update(float gpu_frame_time_ms);
+  void Reset();
+
+  void SetTargetFrameTime(float ms) { target_frame_time_ms_ = ms; }
+  WIESEL_GETTER_FN float GetTargetFrameTime() const {
+    return target_frame_time_ms_;
+  }
+  WIESEL_GETTER_FN float* GetTargetFrameTimePtr() {
+    return &target_frame_time_ms_;
+  }
+  void SetMinScale(float scale) { min_scale_ = scale; }
+  WIESEL_GETTER_FN float GetMinScale() const { return min_scale_; }
+
+  WIESEL_GETTER_FN float GetScale() const { return scale_; }
+  WIESEL_GETTER_FN float GetAverageFrameTime() const {
+    return average_frame_time_ms_;
+  }
+
+ private:
+  float target_frame_time_ms_ = 16.6f;
+  float min_scale_ = 0.5f;
+  float scale_ = 1.0f;
+  float average_frame_time_ms_ = 0.0f;
+  uint32_t frames_since_change_ = 0;
+};
+
+}  // namespace Wiesel
@@ -20,6 +20,9 @@ struct SamplerProps {
   float MaxAnisotropy = -1.0f;
   VkSamplerAddressMode AddressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
   VkBorderColor BorderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+  // Depth comparison for sampler*Shadow, linear filtering then gives 2x2 PCF
+  bool EnableCompare = false;
+  VkCompareOp CompareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
 };
 
 class Sampler {
@@ -13,9 +13,15 @@
 
 namespace Wiesel {
 // todo
-enum ShaderType { ShaderTypeVertex, ShaderTypeFragment };
-
-enum ShaderSource { ShaderSourcePrecompiled, ShaderSourceSource };
+enum ShaderType { ShaderTypeVertex, ShaderTypeFragment, ShaderTypeCompute };
+
+// ShaderSourceSource is served from the renderer's shader library when it
+// has the permutation, see Renderer::CreateShader
+enum ShaderSource {
+  ShaderSourcePrecompiled,
+  ShaderSourceSource,
+  ShaderSourceLibrary
+};
 
 enum ShaderLang { ShaderLangGLSL, ShaderLangHLSL };
 
@@ -30,12 +36,16 @@ struct ShaderProperties {
   std::vector<std::string> defines;
 };
 
+struct Pipeline;
+
 struct Shader {
   Shader(ShaderProperties properties);
   ~Shader();
 
   VkShaderModule shader_module_;
   ShaderProperties properties_;
+  // Pipelines created with this shader, rebuilt when it's hot reloaded
+  std::vector<std::weak_ptr<Pipeline>> pipelines_;
 };
 
 }  // namespace Wiesel
\ No newline at end of file
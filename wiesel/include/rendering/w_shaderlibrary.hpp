@@ -0,0 +1,55 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "util/w_utils.hpp"
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// SPIR-V of every internal shader permutation, baked at build time by
+// wiesel-shaderpack (see target_include_engine_assets) so pipelines are
+// created without running glslang.
+//
+// File layout, little endian:
+//   char[4] "WSHL", uint32 version, uint32 entry count
+//   per entry: uint32 key length, key, uint32 offset, uint32 size
+//   SPIR-V words of all entries, offset and size are in words from here
+class ShaderLibrary {
+ public:
+  // Stays empty when the file is missing or malformed, every lookup misses
+  // and shaders are compiled from source instead.
+  explicit ShaderLibrary(const std::string& path);
+  ~ShaderLibrary() = default;
+
+  WIESEL_GETTER_FN bool IsLoaded() const { return !entries_.empty(); }
+  WIESEL_GETTER_FN bool Contains(const std::string& path,
+                                 const std::vector<std::string>& defines) const;
+  bool Find(const std::string& path, const std::vector<std::string>& defines,
+            std::vector<uint32_t>& code) const;
+
+  // Shader path followed by the sorted defines, each prefixed with '|'.
+  // Has to match the keys built in target_include_engine_assets.
+  static std::string MakeKey(const std::string& path,
+                             std::vector<std::string> defines);
+
+ private:
+  struct Entry {
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  std::unordered_map<std::string, Entry> entries_;
+  std::vector<uint32_t> code_;
+};
+
+}  // namespace Wiesel
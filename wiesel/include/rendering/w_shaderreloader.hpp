@@ -0,0 +1,99 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include <atomic>
+
+#include "rendering/w_pipeline.hpp"
+#include "rendering/w_shader.hpp"
+#include "util/w_utils.hpp"
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// Watches a shader source directory (inotify on Linux, polling elsewhere)
+// and rebuilds whatever uses a changed file without stopping the renderer.
+// A worker thread compiles the tracked shaders of that file and then creates
+// new handles for the pipelines using them, Apply swaps both in at the start
+// of a frame. A shader that fails to compile is logged and the last good
+// version stays in use.
+class ShaderReloader {
+ public:
+  explicit ShaderReloader(const std::string& directory);
+  ~ShaderReloader();
+
+  void Track(const Ref<Shader>& shader);
+
+  // Called at the start of a frame once the previous frame's fence passed.
+  // Returns true when pipeline handles were swapped, anything recorded with
+  // the old ones has to be recorded again.
+  bool Apply();
+
+  // Source of a shader that was reloaded, the baked library and the copied
+  // assets are out of date for it. Empty if it wasn't reloaded.
+  WIESEL_GETTER_FN std::string GetReloadedPath(const std::string& path) const;
+
+ private:
+  struct CompiledShader {
+    Ref<Shader> shader;
+    VkShaderModule module;
+  };
+  struct PipelineJob {
+    Ref<Pipeline> pipeline;
+    uint32_t bake_version;
+    // Taken when the job is queued, the worker never reads the pipeline
+    Pipeline::CreateState state;
+    std::vector<VkShaderModule> modules;
+  };
+  struct BakedPipeline {
+    Ref<Pipeline> pipeline;
+    uint32_t bake_version;
+    VkPipelineLayout layout;
+    VkPipeline handle;
+  };
+  struct RetiredPipeline {
+    VkPipelineLayout layout;
+    VkPipeline handle;
+  };
+
+  void Run();
+  // Blocks for a short while, returns the names of the files that changed
+  void WaitForChanges(std::set<std::string>& changed);
+  void Compile(const std::set<std::string>& changed);
+  void BuildPipelines();
+
+  std::filesystem::path directory_;
+  VkDevice device_;
+  std::thread thread_;
+  std::atomic<bool> running_ = true;
+#ifdef WIESEL_PLATFORM_LINUX
+  int inotify_fd_ = -1;
+#else
+  std::map<std::string, std::filesystem::file_time_type> write_times_;
+#endif
+
+  // Guards everything below that the worker touches
+  std::mutex mutex_;
+  std::vector<std::weak_ptr<Shader>> shaders_;
+  std::vector<CompiledShader> compiled_;
+  std::vector<PipelineJob> jobs_;
+  std::vector<BakedPipeline> baked_;
+  bool building_ = false;
+
+  // Main thread only
+  std::vector<RetiredPipeline> retired_pipelines_;
+  // Pending jobs may still be creating pipelines with these
+  std::vector<VkShaderModule> retired_modules_;
+  std::set<std::string> reloaded_;
+};
+
+}  // namespace Wiesel
@@ -202,6 +202,13 @@ struct AttachmentTextureProps {
   bool sampled = false;
   uint32_t layer_count = 1;
   bool transfer_dest = false;
+  // Never leaves the render pass, backed by lazily allocated memory when the
+  // device has it so tiled gpus can keep it in tile memory
+  bool transient = false;
+  // Read by a later subpass of the same render pass
+  bool input_attachment = false;
+  // Written by compute shaders
+  bool storage = false;
 };
 
 class DescriptorSet;
@@ -210,6 +217,10 @@ struct AttachmentTextureInfo {
   AttachmentTextureType type;
   VkFormat format;
   VkSampleCountFlagBits msaa_samples;
+  // Contents are discarded at the end of the render pass
+  bool transient = false;
+  // Read as an input attachment by the next subpass
+  bool input = false;
   /*VkAttachmentLoadOp LoadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
   VkAttachmentStoreOp StoreOp = VK_ATTACHMENT_STORE_OP_STORE;
   VkAttachmentLoadOp StencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
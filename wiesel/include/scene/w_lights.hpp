@@ -13,6 +13,7 @@
 
 #include "scene/w_entity.hpp"
 #include "util/w_color.hpp"
+#include "util/w_utils.hpp"
 #include "w_pch.hpp"
 
 namespace Wiesel {
@@ -55,14 +56,16 @@ struct alignas(16) LightPoint {
       : base({}),
         constant(1.0f),
         linear(0.09f),
-        exp(0.032f) {}
+        exp(0.032f),
+        radius(0.0f) {}
 
   LightPoint(glm::vec3 position, LightBase base, float constant, float linear,
              float exp)
       : base(base),
         constant(constant),
         linear(linear),
-        exp(exp) {}
+        exp(exp),
+        radius(0.0f) {}
 
   ~LightPoint() = default;
 
@@ -70,30 +73,37 @@ struct alignas(16) LightPoint {
   float constant;
   float linear;
   float exp;
+  // Distance where the light stops contributing, computed in UpdateLight
+  float radius;
 };
 
 static const int MAX_LIGHTS = 16;
 
+// Point lights live in a storage buffer and are culled per cluster,
+// only direct lights are kept here.
 struct alignas(16) LightsUniformData {
   LightsUniformData() : direct_light_count(0), point_light_count(0){};
 
   uint32_t direct_light_count;
   uint32_t point_light_count;
   LightDirect direct_lights[MAX_LIGHTS];
-  LightPoint point_lights[MAX_LIGHTS];
 };
 
 void UpdateLight(LightsUniformData& lights, const LightDirect& light,
                  const TransformComponent& transform);
 
-void UpdateLight(LightsUniformData& lights, const LightPoint& light,
+void UpdateLight(std::vector<LightPoint>& lights, const LightPoint& light,
                  const TransformComponent& transform);
 
+float ComputeLightRadius(const LightPoint& light);
+
 struct LightDirectComponent {
   LightDirectComponent() = default;
   LightDirectComponent(const LightDirectComponent&) = default;
 
   LightDirect light_data;
+  // Set when light_data is modified, so the scene rebuilds the light data
+  bool is_changed = true;
 };
 
 struct LightPointComponent {
@@ -101,6 +111,7 @@ struct LightPointComponent {
   LightPointComponent(const LightPointComponent&) = default;
 
   LightPoint light_data;
+  bool is_changed = true;
 };
 
 }  // namespace Wiesel
\ No newline at end of file
@@ -23,6 +23,7 @@
 namespace Wiesel {
 class Entity;
 class CanvasSystem;
+struct RenderPacket;
 
 class Scene {
  public:
@@ -49,7 +50,7 @@ class Scene {
 
   void SetPaused(bool paused) { is_paused_ = paused; }
 
-  void SetSkybox(Ref<Skybox> skybox) { skybox_ = skybox; }
+  void SetSkybox(Ref<Skybox> skybox);
 
   template <typename T, typename... Args>
   T& AddComponent(entt::entity handle, Args&&... args) {
@@ -68,6 +69,10 @@ class Scene {
     return registry_.get<T>(handle);
   }
 
+  WIESEL_GETTER_FN bool IsValid(entt::entity handle) const {
+    return registry_.valid(handle);
+  }
+
   template <typename T>
   bool HasComponent(entt::entity handle) const {
     return registry_.any_of<T>(handle);
@@ -97,13 +102,23 @@ class Scene {
   void UnlinkEntities(entt::entity parent, entt::entity child);
 
   void ProcessDestroyQueue();
-  bool Render();
+  // Fills the render packet from the registry, should be called after
+  // OnUpdate. Render only reads the packet.
+  void ExtractRenderPacket();
+  WIESEL_GETTER_FN const RenderPacket& GetRenderPacket() const {
+    return *render_packet_;
+  }
+  // present_directly lets a single camera composite straight into the
+  // swapchain image, the output has to be drawn in the present pass then.
+  bool Render(bool present_directly = false);
 
  private:
   bool OnWindowResizeEvent(WindowResizeEvent& event);
   glm::mat4 MakeLocal(const TransformComponent& transform);
   glm::mat4 GetWorldMatrix(entt::entity entity);
   void UpdateMatrices(entt::entity entity);
+  void UpdateLights();
+  void OnLightComponentChanged(entt::registry& registry, entt::entity entity);
   void DestroyEntity(entt::entity handle);
 
  private:
@@ -112,10 +127,13 @@ class Scene {
   bool is_running_ = false;
   bool is_paused_ = false;
   bool first_update_ = true;
+  bool lights_dirty_ = true;
   std::vector<entt::entity> scene_hierarchy_;
   std::vector<entt::entity> destroy_queue_;
-  // this camera is used to render the scene to the current camera
-  Ref<CameraData> current_camera_;
+  Scope<RenderPacket> render_packet_;
+  // Level of detail of every RenderPacket::meshes entry for the camera being
+  // rendered, kept to not allocate every frame
+  std::vector<uint32_t> mesh_lods_;
   Ref<Skybox> skybox_;
 };
 }  // namespace Wiesel
\ No newline at end of file
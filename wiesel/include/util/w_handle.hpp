@@ -0,0 +1,84 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#pragma once
+
+#include "util/w_attributes.hpp"
+#include "w_pch.hpp"
+
+namespace Wiesel {
+
+// Slot index plus the generation the slot had when the handle was created.
+// A handle to a released slot resolves to null, even after the slot is
+// reused for another item.
+template <typename T>
+struct Handle {
+  uint32_t index = UINT32_MAX;
+  uint32_t generation = 0;
+
+  WIESEL_GETTER_FN bool IsNull() const { return index == UINT32_MAX; }
+
+  bool operator==(const Handle& other) const = default;
+};
+
+// Dense storage addressed by Handle<T>, released slots are reused through a
+// free list. Pointers returned by Get are invalidated by the next Create.
+// Not thread safe, only touched from the render thread.
+template <typename T>
+class HandlePool {
+ public:
+  Handle<T> Create(T item) {
+    uint32_t index;
+    if (!free_indices_.empty()) {
+      index = free_indices_.back();
+      free_indices_.pop_back();
+      items_[index] = std::move(item);
+    } else {
+      index = static_cast<uint32_t>(items_.size());
+      items_.push_back(std::move(item));
+      generations_.push_back(0);
+    }
+    return {index, generations_[index]};
+  }
+
+  void Release(Handle<T> handle) {
+    if (!IsValid(handle)) {
+      return;
+    }
+    generations_[handle.index]++;
+    items_[handle.index] = T{};
+    free_indices_.push_back(handle.index);
+  }
+
+  WIESEL_GETTER_FN bool IsValid(Handle<T> handle) const {
+    return handle.index < items_.size() &&
+           generations_[handle.index] == handle.generation;
+  }
+
+  WIESEL_GETTER_FN T* Get(Handle<T> handle) {
+    return IsValid(handle) ? &items_[handle.index] : nullptr;
+  }
+
+  WIESEL_GETTER_FN const T* Get(Handle<T> handle) const {
+    return IsValid(handle) ? &items_[handle.index] : nullptr;
+  }
+
+  WIESEL_GETTER_FN uint32_t GetLiveCount() const {
+    return static_cast<uint32_t>(items_.size() - free_indices_.size());
+  }
+
+ private:
+  std::vector<T> items_;
+  std::vector<uint32_t> generations_;
+  std::vector<uint32_t> free_indices_;
+};
+
+}  // namespace Wiesel
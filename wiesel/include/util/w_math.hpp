@@ -16,4 +16,10 @@
 namespace Wiesel::Math {
 bool DecomposeTransform(const glm::mat4& transform, glm::vec3& translation,
                         glm::vec3& rotation, glm::vec3& scale);
+// Size of an object space bounding sphere on screen as a fraction of the
+// screen height, max float when the camera is inside it
+float GetScreenSize(const glm::vec3& center, float radius,
+                    const glm::mat4& transform_matrix,
+                    const glm::vec3& camera_position,
+                    const glm::mat4& projection);
 }
\ No newline at end of file
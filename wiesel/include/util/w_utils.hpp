@@ -14,6 +14,7 @@
 #define PI 3.14
 #define BIT(x) (1 << x)
 
+#include <glm/gtc/packing.hpp>
 #include <glm/gtx/hash.hpp>
 
 #include "w_pch.hpp"
@@ -24,13 +25,58 @@ namespace Wiesel {
 #define WIESEL_SSAO_KERNEL_SIZE 24
 #define WIESEL_SSAO_RADIUS 0.5
 #define WIESEL_SSAO_NOISE_DIM 8
+// Kernel is split in this many parts when temporal accumulation is enabled
+#define WIESEL_SSAO_TEMPORAL_FRAMES 4
 #define WIESEL_SHADOWMAP_DIM 4096
+#define WIESEL_HIZ_DOWNSAMPLE 8
+#define WIESEL_MAX_POINT_LIGHTS 4096
+// Descriptor sets a single DrawFullscreen call can bind
+#define WIESEL_MAX_FULLSCREEN_DESCRIPTOR_SETS 4
+#define WIESEL_CLUSTER_GRID_X 16
+#define WIESEL_CLUSTER_GRID_Y 9
+#define WIESEL_CLUSTER_GRID_Z 24
+#define WIESEL_CLUSTER_COUNT \
+  (WIESEL_CLUSTER_GRID_X * WIESEL_CLUSTER_GRID_Y * WIESEL_CLUSTER_GRID_Z)
+#define WIESEL_CLUSTER_MAX_LIGHT_INDICES (WIESEL_CLUSTER_COUNT * 64)
+// Seconds the window size has to stay the same before the swap chain is recreated
+#define WIESEL_RESIZE_DEBOUNCE_TIME 0.15f
+// Frames a replaced swap chain is kept alive for before it's destroyed
+#define WIESEL_SWAP_CHAIN_RETIRE_FRAMES 2
+// Impostor atlases have WIESEL_IMPOSTOR_GRID^2 views of this size each
+#define WIESEL_IMPOSTOR_GRID 8
+#define WIESEL_IMPOSTOR_FRAME_SIZE 128
+// Impostors drawn in a frame, over all cameras
+#define WIESEL_MAX_IMPOSTOR_INSTANCES 16384
+// Fraction of the screen height below which a model is drawn as an impostor
+#define WIESEL_IMPOSTOR_SCREEN_SIZE 0.05f
+// Length of the Halton sequence the TAA projection jitter cycles through
+#define WIESEL_TAA_JITTER_SAMPLES 8
+// Side of the square around the cursor the ID pass draws and reads back
+#define WIESEL_PICK_REGION_SIZE 7
+// Levels of detail a mesh can have, LOD0 included
+#define WIESEL_MAX_MESH_LODS 4
+// Screen size below which LOD1 is drawn, halved for every further level
+#define WIESEL_LOD_SCREEN_SIZE 0.5f
+// Fraction a screen size has to pass a switch point by to change the LOD
+#define WIESEL_LOD_HYSTERESIS 0.1f
+// Post-transform cache entries assumed by the mesh optimizer's ACMR analysis
+#define WIESEL_VERTEX_CACHE_SIZE 16
+// Internal shader permutations baked at build time, see ShaderLibrary
+#define WIESEL_SHADER_LIBRARY_PATH "assets/internal_shaders.shaderlib"
+// Watched by shader hot reload, the build points it at the engine's sources
+#ifndef WIESEL_SHADER_SOURCE_DIR
+#define WIESEL_SHADER_SOURCE_DIR "assets/internal_shaders"
+#endif
 
 std::string GetNameFromVulkanResult(VkResult errorCode);
 
 struct QueueFamilyIndices {
   std::optional<uint32_t> graphicsFamily;
   std::optional<uint32_t> presentFamily;
+  // Queue used for async compute, empty if the device only has the graphics
+  // queue. Can be a second queue of the graphics family.
+  std::optional<uint32_t> computeFamily;
+  uint32_t computeQueueIndex = 0;
 
   bool IsComplete() {
     return graphicsFamily.has_value() && presentFamily.has_value();
@@ -49,16 +95,6 @@ using Index = uint32_t;
 
 
 
-enum Vertex3DFlag {
-  VertexFlagHasTexture = BIT(0),
-  VertexFlagHasNormalMap = BIT(1),
-  VertexFlagHasSpecularMap = BIT(2),
-  VertexFlagHasHeightMap = BIT(3),
-  VertexFlagHasAlbedoMap = BIT(4),
-  VertexFlagHasRoughnessMap = BIT(5),
-  VertexFlagHasMetallicMap = BIT(6),
-};
-
 struct Vertex3D {
   glm::vec3 Pos;
   glm::vec3 Color;
@@ -66,7 +102,6 @@ struct Vertex3D {
   glm::vec3 Normal;
   glm::vec3 Tangent;
   glm::vec3 BiTangent;
-  uint32_t Flags;
 
   static VkVertexInputBindingDescription GetBindingDescription() {
     VkVertexInputBindingDescription bindingDescription{};
@@ -93,8 +128,6 @@ struct Vertex3D {
         {4, 0, VK_FORMAT_R32G32B32_SFLOAT, (uint32_t) offsetof(Vertex3D, Tangent)});
     attributeDescriptions.push_back(
         {5, 0, VK_FORMAT_R32G32B32_SFLOAT, (uint32_t) offsetof(Vertex3D, BiTangent)});
-    attributeDescriptions.push_back(
-        {6, 0, VK_FORMAT_R32_UINT, (uint32_t) offsetof(Vertex3D, Flags)});
 
     return attributeDescriptions;
   }
@@ -104,6 +137,102 @@ struct Vertex3D {
   }
 };
 
+// What meshes actually upload, 28 bytes instead of the 68 of Vertex3D.
+// Vertex3D stays the import and CPU side format, Pack converts on Allocate.
+// Normal and tangent are 10:10:10:2 unorm remapped to [-1, 1] in the vertex
+// shaders, the tangent's w holds the bitangent sign so the bitangent is
+// rebuilt as cross(normal, tangent) * sign.
+struct PackedVertex3D {
+  glm::vec3 Pos;
+  uint32_t Color;    // R8G8B8A8 unorm
+  uint32_t UV;       // R16G16 half float
+  uint32_t Normal;   // A2B10G10R10 unorm
+  uint32_t Tangent;  // A2B10G10R10 unorm, w is the bitangent sign
+
+  static PackedVertex3D Pack(const Vertex3D& vertex) {
+    glm::vec3 normal = glm::normalize(vertex.Normal);
+    glm::vec3 tangent = glm::normalize(vertex.Tangent);
+    float sign =
+        glm::dot(glm::cross(normal, tangent), vertex.BiTangent) < 0.0f ? 0.0f
+                                                                       : 1.0f;
+    if (glm::any(glm::isnan(normal))) {
+      normal = glm::vec3(0.0f, 1.0f, 0.0f);
+    }
+    if (glm::any(glm::isnan(tangent))) {
+      tangent = glm::vec3(1.0f, 0.0f, 0.0f);
+    }
+
+    PackedVertex3D packed{};
+    packed.Pos = vertex.Pos;
+    packed.Color = glm::packUnorm4x8(glm::vec4(vertex.Color, 1.0f));
+    packed.UV = glm::packHalf2x16(vertex.UV);
+    packed.Normal =
+        glm::packUnorm3x10_1x2(glm::vec4(normal * 0.5f + 0.5f, 0.0f));
+    packed.Tangent =
+        glm::packUnorm3x10_1x2(glm::vec4(tangent * 0.5f + 0.5f, sign));
+    return packed;
+  }
+
+  static VkVertexInputBindingDescription GetBindingDescription() {
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(PackedVertex3D);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescription;
+  }
+
+  static std::vector<VkVertexInputAttributeDescription>
+  GetAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    attributeDescriptions.push_back(
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, (uint32_t) offsetof(PackedVertex3D, Pos)});
+    attributeDescriptions.push_back(
+        {1, 0, VK_FORMAT_R8G8B8A8_UNORM, (uint32_t) offsetof(PackedVertex3D, Color)});
+    attributeDescriptions.push_back(
+        {2, 0, VK_FORMAT_R16G16_SFLOAT, (uint32_t) offsetof(PackedVertex3D, UV)});
+    attributeDescriptions.push_back(
+        {3, 0, VK_FORMAT_A2B10G10R10_UNORM_PACK32, (uint32_t) offsetof(PackedVertex3D, Normal)});
+    attributeDescriptions.push_back(
+        {4, 0, VK_FORMAT_A2B10G10R10_UNORM_PACK32, (uint32_t) offsetof(PackedVertex3D, Tangent)});
+
+    return attributeDescriptions;
+  }
+};
+
+// Shadow pass stream, 16 bytes. Everything but the position is dropped,
+// the half float UV stays for alpha tested cutouts.
+struct ShadowVertex3D {
+  glm::vec3 Pos;
+  uint32_t UV;  // R16G16 half float
+
+  static ShadowVertex3D Pack(const Vertex3D& vertex) {
+    return {vertex.Pos, glm::packHalf2x16(vertex.UV)};
+  }
+
+  static VkVertexInputBindingDescription GetBindingDescription() {
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(ShadowVertex3D);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    return bindingDescription;
+  }
+
+  static std::vector<VkVertexInputAttributeDescription>
+  GetAttributeDescriptions() {
+    std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
+
+    attributeDescriptions.push_back(
+        {0, 0, VK_FORMAT_R32G32B32_SFLOAT, (uint32_t) offsetof(ShadowVertex3D, Pos)});
+    attributeDescriptions.push_back(
+        {1, 0, VK_FORMAT_R16G16_SFLOAT, (uint32_t) offsetof(ShadowVertex3D, UV)});
+
+    return attributeDescriptions;
+  }
+};
+
 struct Vertex2DNoColor {
   glm::vec2 Pos;
   glm::vec2 UV;
@@ -178,7 +307,12 @@ struct alignas(16) CameraUniformData {
   float FarPlane;
   float _pad1[2];
   glm::vec4 CascadeSplits;
+  // 0 = disabled, 1 = full resolution blur, 2 = temporal half resolution
   uint32_t EnableSSAO;
+  uint32_t FrameIndex;
+  // Part of the attachments the deferred passes render into
+  glm::vec2 RenderScale;
+  alignas(16) glm::mat4 PreviousViewProjection;
 };
 
 struct alignas(16) ShadowMapMatricesUniformData {
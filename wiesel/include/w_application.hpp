@@ -55,6 +55,8 @@ class Application {
  private:
   void ExecuteQueue();
   void UpdateKeyboardAxis();
+  void DispatchToLayers(Event& event);
+  void UpdatePendingResize(const Ref<Renderer>& renderer);
 
  protected:
   static Application* application_;
@@ -66,6 +68,9 @@ class Application {
   bool is_minimized_;
   bool window_resized_;
   WindowSize window_size_;
+  // Last size reported while resizing, layers only see it once it settled
+  WindowSize pending_resize_size_{};
+  float_t resize_settle_timer_ = 0.0f;
   // proper layer stack
   std::vector<Ref<Layer>> layers_;
   Ref<ImGuiLayer> imgui_layer_;
@@ -26,8 +26,20 @@ class Engine {
   static void CleanupWindow();
   static void CleanupEngine();
 
-  WIESEL_GETTER_FN static std::shared_ptr<Renderer> GetRenderer();
-  WIESEL_GETTER_FN static std::shared_ptr<AppWindow> GetWindow();
+  // Returned by reference, these are called in hot paths and copying the
+  // shared_ptr would touch the refcount every time.
+  WIESEL_GETTER_FN static const std::shared_ptr<Renderer>& GetRenderer();
+  WIESEL_GETTER_FN static const std::shared_ptr<AppWindow>& GetWindow();
+
+  // Imported meshes go through MeshOptimizer, turning it off makes imports
+  // faster while iterating in the editor
+  static void SetMeshOptimizationEnabled(bool value) { kMeshOptimization = value; }
+  WIESEL_GETTER_FN static bool IsMeshOptimizationEnabled() { return kMeshOptimization; }
+  WIESEL_GETTER_FN static bool* IsMeshOptimizationEnabledPtr() { return &kMeshOptimization; }
+  // Imported meshes get a chain of simplified levels of detail
+  static void SetLodGenerationEnabled(bool value) { kLodGeneration = value; }
+  WIESEL_GETTER_FN static bool IsLodGenerationEnabled() { return kLodGeneration; }
+  WIESEL_GETTER_FN static bool* IsLodGenerationEnabledPtr() { return &kLodGeneration; }
 
   static aiScene* LoadAssimpModel(ModelComponent& modelComponent,
                                   const std::string& path,
@@ -56,6 +68,8 @@ class Engine {
  private:
   static Ref<Renderer> kRenderer;
   static Ref<AppWindow> kWindow;
+  static bool kMeshOptimization;
+  static bool kLodGeneration;
 };
 
 Application* CreateApp(int argc, char** argv);
@@ -22,6 +22,7 @@ void SceneLayer::OnDetach() {
 
 void SceneLayer::OnUpdate(float_t delta_time) {
   scene_->OnUpdate(delta_time);
+  scene_->ExtractRenderPacket();
 }
 
 void SceneLayer::OnEvent(Event& event) {
@@ -33,8 +34,26 @@ void SceneLayer::OnBeginPresent() {
 
 void SceneLayer::OnPresent() {
   std::shared_ptr<Renderer> renderer = Engine::GetRenderer();
+  if (!renderer->GetCameraData()) {
+    return;
+  }
+  if (renderer->IsCompositeInPresent()) {
+    // Composite pass was skipped, blend the layers straight into the swapchain.
+    // Only the camera's viewport is covered, it lags behind the window while a
+    // resize is pending.
+    const VkExtent2D& extent = renderer->GetExtent();
+    renderer->SetViewport(glm::min(renderer->GetCameraData()->viewport_size,
+                                   glm::vec2{extent.width, extent.height}));
+    renderer->GetPresentCompositePipeline()->Bind(PipelineBindPointGraphics);
+    renderer->DrawFullscreen(renderer->GetPresentCompositePipeline(),
+                             {renderer->GetSceneColorDescriptor()});
+    renderer->DrawFullscreen(renderer->GetPresentCompositePipeline(),
+                             {renderer->GetCameraData()->resources->sprite_output_descriptor});
+    renderer->SetViewport(extent);
+    return;
+  }
   renderer->DrawFullscreen(renderer->GetPresentPipeline(),
-                                {renderer->GetCameraData()->composite_output_descriptor});
+                                {renderer->GetCameraData()->resources->composite_output_descriptor});
 }
 
 void SceneLayer::OnPostPresent() {
@@ -42,7 +61,7 @@ void SceneLayer::OnPostPresent() {
 }
 
 void SceneLayer::OnPrePresent() {
-  scene_->Render();
+  scene_->Render(true);
 }
 
 
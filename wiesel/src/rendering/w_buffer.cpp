@@ -26,6 +26,8 @@ MemoryBuffer::~MemoryBuffer() {
       Engine::GetRenderer()->DestroyIndexBuffer(*this);
       break;
     case MemoryTypeUniformBuffer:
+    case MemoryTypeStorageBuffer:
+    case MemoryTypeReadbackBuffer:
       // this is handled by the object
       break;
   }
@@ -39,4 +41,16 @@ UniformBuffer::~UniformBuffer() {
   Engine::GetRenderer()->DestroyUniformBuffer(*this);
 }
 
+StorageBuffer::StorageBuffer() : MemoryBuffer(MemoryTypeStorageBuffer) {}
+
+StorageBuffer::~StorageBuffer() {
+  Engine::GetRenderer()->DestroyStorageBuffer(*this);
+}
+
+ReadbackBuffer::ReadbackBuffer() : MemoryBuffer(MemoryTypeReadbackBuffer) {}
+
+ReadbackBuffer::~ReadbackBuffer() {
+  Engine::GetRenderer()->DestroyReadbackBuffer(*this);
+}
+
 }  // namespace Wiesel
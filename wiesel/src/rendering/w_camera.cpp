@@ -126,23 +126,39 @@ void CameraComponent::ComputeCascades(const glm::vec3& lightDir) {
   force_light_reset = false;
 }
 
+static glm::vec4 NormalizePlane(const glm::vec4& plane) {
+  // Only the normal should be unit length so w stays as the distance
+  return plane / glm::length(glm::vec3(plane));
+}
+
 void CameraComponent::ExtractFrustumPlanes() {
   glm::mat4 m = projection * view_matrix;
   // Each plane is in the form (a,b,c,d), representing ax + by + cz + d = 0
-  planes.Left = glm::normalize(glm::vec4(m[0][3] + m[0][0], m[1][3] + m[1][0],
+  planes.Left = NormalizePlane(glm::vec4(m[0][3] + m[0][0], m[1][3] + m[1][0],
                                          m[2][3] + m[2][0], m[3][3] + m[3][0]));
   planes.Right =
-      glm::normalize(glm::vec4(m[0][3] - m[0][0], m[1][3] - m[1][0],
+      NormalizePlane(glm::vec4(m[0][3] - m[0][0], m[1][3] - m[1][0],
                                m[2][3] - m[2][0], m[3][3] - m[3][0]));
   planes.Bottom =
-      glm::normalize(glm::vec4(m[0][3] + m[0][1], m[1][3] + m[1][1],
+      NormalizePlane(glm::vec4(m[0][3] + m[0][1], m[1][3] + m[1][1],
                                m[2][3] + m[2][1], m[3][3] + m[3][1]));
-  planes.Top = glm::normalize(glm::vec4(m[0][3] - m[0][1], m[1][3] - m[1][1],
+  planes.Top = NormalizePlane(glm::vec4(m[0][3] - m[0][1], m[1][3] - m[1][1],
                                         m[2][3] - m[2][1], m[3][3] - m[3][1]));
-  planes.Near = glm::normalize(glm::vec4(m[0][3] + m[0][2], m[1][3] + m[1][2],
-                                         m[2][3] + m[2][2], m[3][3] + m[3][2]));
-  planes.Far = glm::normalize(glm::vec4(m[0][3] - m[0][2], m[1][3] - m[1][2],
+  // Depth is in [0, 1] so near plane is just the third row
+  planes.Near = NormalizePlane(
+      glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]));
+  planes.Far = NormalizePlane(glm::vec4(m[0][3] - m[0][2], m[1][3] - m[1][2],
                                         m[2][3] - m[2][2], m[3][3] - m[3][2]));
 }
 
+bool FrustumPlanes::IntersectsSphere(const glm::vec3& center,
+                                     float radius) const {
+  for (const glm::vec4& plane : {Left, Right, Bottom, Top, Near, Far}) {
+    if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace Wiesel
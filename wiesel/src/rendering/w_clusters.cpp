@@ -0,0 +1,135 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_clusters.hpp"
+
+#include "util/w_logger.hpp"
+
+namespace Wiesel {
+
+LightClusterGrid::LightClusterGrid() {
+  clusters_.resize(WIESEL_CLUSTER_COUNT);
+  bins_.resize(WIESEL_CLUSTER_COUNT);
+  light_indices_.reserve(WIESEL_CLUSTER_COUNT);
+}
+
+void LightClusterGrid::Build(std::span<const LightPoint> lights,
+                             const glm::mat4& view_matrix,
+                             const glm::mat4& projection, float near_plane,
+                             float far_plane) {
+  PROFILE_ZONE_SCOPED();
+  for (auto& bin : bins_) {
+    bin.clear();
+  }
+
+  // Same slicing as lighting_shader.frag
+  float logDepthRange = std::log(far_plane / near_plane);
+  auto sliceDepth = [&](int32_t slice) {
+    return near_plane *
+           std::exp(logDepthRange * static_cast<float>(slice) /
+                    static_cast<float>(WIESEL_CLUSTER_GRID_Z));
+  };
+  auto depthSlice = [&](float depth) {
+    float slice = std::log(depth / near_plane) / logDepthRange *
+                  static_cast<float>(WIESEL_CLUSTER_GRID_Z);
+    return std::clamp(static_cast<int32_t>(slice), 0,
+                      WIESEL_CLUSTER_GRID_Z - 1);
+  };
+
+  for (uint32_t i = 0; i < lights.size(); i++) {
+    const LightPoint& light = lights[i];
+    float radius = light.radius;
+    if (radius <= 0.0f) {
+      continue;
+    }
+    if (radius >= std::numeric_limits<float>::max()) {
+      for (auto& bin : bins_) {
+        bin.push_back(i);
+      }
+      continue;
+    }
+    glm::vec3 center =
+        glm::vec3(view_matrix * glm::vec4(light.base.position, 1.0f));
+    // View space looks down -z
+    float depth = -center.z;
+    if (depth + radius < near_plane || depth - radius > far_plane) {
+      continue;
+    }
+    int32_t sliceMin = depthSlice(std::max(depth - radius, near_plane));
+    int32_t sliceMax = depthSlice(std::min(depth + radius, far_plane));
+    for (int32_t z = sliceMin; z <= sliceMax; z++) {
+      float zNear = std::max(sliceDepth(z), depth - radius);
+      float zFar = std::min(sliceDepth(z + 1), depth + radius);
+      zNear = std::max(zNear, near_plane);
+      if (zNear > zFar) {
+        continue;
+      }
+
+      // Project the part of the sphere's bounding box inside this slice
+      glm::vec2 ndcMin{1.0f};
+      glm::vec2 ndcMax{-1.0f};
+      for (int c = 0; c < 8; c++) {
+        glm::vec4 corner{(c & 1) ? center.x + radius : center.x - radius,
+                         (c & 2) ? center.y + radius : center.y - radius,
+                         (c & 4) ? -zFar : -zNear, 1.0f};
+        glm::vec4 clip = projection * corner;
+        glm::vec2 ndc = glm::vec2(clip) / clip.w;
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+      }
+      if (ndcMax.x < -1.0f || ndcMax.y < -1.0f || ndcMin.x > 1.0f ||
+          ndcMin.y > 1.0f) {
+        continue;
+      }
+      int32_t xMin = std::clamp(
+          static_cast<int32_t>((ndcMin.x * 0.5f + 0.5f) * WIESEL_CLUSTER_GRID_X),
+          0, WIESEL_CLUSTER_GRID_X - 1);
+      int32_t xMax = std::clamp(
+          static_cast<int32_t>((ndcMax.x * 0.5f + 0.5f) * WIESEL_CLUSTER_GRID_X),
+          0, WIESEL_CLUSTER_GRID_X - 1);
+      int32_t yMin = std::clamp(
+          static_cast<int32_t>((ndcMin.y * 0.5f + 0.5f) * WIESEL_CLUSTER_GRID_Y),
+          0, WIESEL_CLUSTER_GRID_Y - 1);
+      int32_t yMax = std::clamp(
+          static_cast<int32_t>((ndcMax.y * 0.5f + 0.5f) * WIESEL_CLUSTER_GRID_Y),
+          0, WIESEL_CLUSTER_GRID_Y - 1);
+      for (int32_t y = yMin; y <= yMax; y++) {
+        for (int32_t x = xMin; x <= xMax; x++) {
+          uint32_t index = x + y * WIESEL_CLUSTER_GRID_X +
+                           z * WIESEL_CLUSTER_GRID_X * WIESEL_CLUSTER_GRID_Y;
+          bins_[index].push_back(i);
+        }
+      }
+    }
+  }
+
+  light_indices_.clear();
+  uint32_t dropped = 0;
+  for (uint32_t i = 0; i < WIESEL_CLUSTER_COUNT; i++) {
+    const auto& bin = bins_[i];
+    uint32_t offset = light_indices_.size();
+    uint32_t count = std::min<uint32_t>(
+        bin.size(), WIESEL_CLUSTER_MAX_LIGHT_INDICES - offset);
+    light_indices_.insert(light_indices_.end(), bin.begin(),
+                          bin.begin() + count);
+    clusters_[i] = {offset, count};
+    dropped += bin.size() - count;
+  }
+  if (dropped > 0 && !warned_overflow_) {
+    LOG_WARN(
+        "Light clusters need more than {} light indices, {} were dropped. "
+        "Raise WIESEL_CLUSTER_MAX_LIGHT_INDICES or shrink the light ranges.",
+        WIESEL_CLUSTER_MAX_LIGHT_INDICES, dropped);
+    warned_overflow_ = true;
+  }
+}
+
+}  // namespace Wiesel
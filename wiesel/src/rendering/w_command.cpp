@@ -6,11 +6,11 @@
 #include "w_engine.hpp"
 namespace Wiesel {
 
-CommandPool::CommandPool() {
+CommandPool::CommandPool(uint32_t queue_family_index) {
   VkCommandPoolCreateInfo poolInfo{};
   poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
   poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-  poolInfo.queueFamilyIndex = Engine::GetRenderer()->GetGraphicsQueueFamilyIndex();
+  poolInfo.queueFamilyIndex = queue_family_index;
   WIESEL_CHECK_VKRESULT(
       vkCreateCommandPool(Engine::GetRenderer()->GetLogicalDevice(), &poolInfo, nullptr, &handle_));
 }
@@ -19,33 +19,42 @@ CommandPool::~CommandPool() {
   vkDestroyCommandPool(Engine::GetRenderer()->GetLogicalDevice(), handle_, nullptr);
 }
 
-Ref<CommandBuffer> CommandPool::CreateBuffer() {
-  if (!free_buffers_.empty()) {
-    VkCommandBuffer buffer = free_buffers_.front();
-    free_buffers_.pop_front();
-    return CreateReference<CommandBuffer>(*this, buffer);
+Ref<CommandBuffer> CommandPool::CreateBuffer(VkCommandBufferLevel level) {
+  auto& freeBuffers = level == VK_COMMAND_BUFFER_LEVEL_PRIMARY
+                          ? free_buffers_
+                          : free_secondary_buffers_;
+  if (!freeBuffers.empty()) {
+    VkCommandBuffer buffer = freeBuffers.front();
+    freeBuffers.pop_front();
+    return CreateReference<CommandBuffer>(*this, buffer, level);
   }
   VkCommandBufferAllocateInfo allocInfo{};
   allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
   allocInfo.commandPool = handle_;
-  allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+  allocInfo.level = level;
   allocInfo.commandBufferCount = 1;
 
   VkCommandBuffer buffer;
   WIESEL_CHECK_VKRESULT(
       vkAllocateCommandBuffers(Engine::GetRenderer()->GetLogicalDevice(), &allocInfo, &buffer));
-  return CreateReference<CommandBuffer>(*this, buffer);
+  return CreateReference<CommandBuffer>(*this, buffer, level);
 }
 
-void CommandPool::ReturnBuffer(VkCommandBuffer buffer) {
-  free_buffers_.push_back(buffer);
+void CommandPool::ReturnBuffer(VkCommandBuffer buffer, VkCommandBufferLevel level) {
+  if (level == VK_COMMAND_BUFFER_LEVEL_PRIMARY) {
+    free_buffers_.push_back(buffer);
+  } else {
+    free_secondary_buffers_.push_back(buffer);
+  }
 }
 
-CommandBuffer::CommandBuffer(CommandPool& pool, VkCommandBuffer commandBuffer) : pool_(pool), handle_(commandBuffer) {
+CommandBuffer::CommandBuffer(CommandPool& pool, VkCommandBuffer commandBuffer,
+                             VkCommandBufferLevel level)
+    : pool_(pool), handle_(commandBuffer), level_(level) {
 }
 
 CommandBuffer::~CommandBuffer() {
-  pool_.ReturnBuffer(handle_);
+  pool_.ReturnBuffer(handle_, level_);
 }
 
 void CommandBuffer::Begin() {
@@ -57,6 +66,22 @@ void CommandBuffer::Begin() {
   WIESEL_CHECK_VKRESULT(vkBeginCommandBuffer(handle_, &beginInfo));
 }
 
+void CommandBuffer::Begin(VkRenderPass render_pass, uint32_t subpass,
+                          VkFramebuffer framebuffer) {
+  VkCommandBufferInheritanceInfo inheritanceInfo{};
+  inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+  inheritanceInfo.renderPass = render_pass;
+  inheritanceInfo.subpass = subpass;
+  inheritanceInfo.framebuffer = framebuffer;
+
+  VkCommandBufferBeginInfo beginInfo{};
+  beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+  beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+  beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+  WIESEL_CHECK_VKRESULT(vkBeginCommandBuffer(handle_, &beginInfo));
+}
+
 void CommandBuffer::End() {
   WIESEL_CHECK_VKRESULT(vkEndCommandBuffer(handle_));
 }
@@ -38,7 +38,11 @@ void DescriptorSet::Bake() {
     allocated_ = false;
   }
   VkDescriptorPoolSize poolSizes[] = {
-      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}};
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+      {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT,
+       std::max(static_cast<uint32_t>(input_attachments_.size()), 1u)},
+      {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+       std::max(static_cast<uint32_t>(storage_images_.size()), 1u)}};
 
   VkDescriptorPoolCreateInfo poolInfo{};
   poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -61,11 +65,13 @@ void DescriptorSet::Bake() {
                                                  &descriptor_set_));
 
   std::vector<VkWriteDescriptorSet> writes;
-  writes.reserve(combined_image_samplers_.size() + uniform_buffer_data_.size());
+  writes.reserve(combined_image_samplers_.size() + uniform_buffer_data_.size() +
+                 input_attachments_.size() + storage_images_.size());
   std::vector<VkDescriptorBufferInfo> bufferInfos;
   bufferInfos.reserve(uniform_buffer_data_.size());
   std::vector<VkDescriptorImageInfo> imageInfos;
-  imageInfos.reserve(combined_image_samplers_.size());
+  imageInfos.reserve(combined_image_samplers_.size() + input_attachments_.size() +
+                     storage_images_.size());
 
   for (const auto& item : combined_image_samplers_) {
     VkDescriptorImageInfo imageInfo;
@@ -104,6 +110,43 @@ void DescriptorSet::Bake() {
     set.pNext = nullptr;
     writes.emplace_back(set);
   }
+  for (const auto& item : input_attachments_) {
+    VkDescriptorImageInfo imageInfo;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = item.image_view->handle_;
+    imageInfo.sampler = VK_NULL_HANDLE;
+    imageInfos.emplace_back(imageInfo);
+
+    VkWriteDescriptorSet set{};
+    set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set.dstSet = descriptor_set_;
+    set.dstBinding = item.dst_binding;
+    set.dstArrayElement = 0;
+    set.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+    set.descriptorCount = 1;
+    set.pImageInfo = &imageInfos.back();
+    set.pNext = nullptr;
+    writes.emplace_back(set);
+  }
+  for (const auto& item : storage_images_) {
+    VkDescriptorImageInfo imageInfo;
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+    imageInfo.imageView = item.image_view->handle_;
+    imageInfo.sampler = VK_NULL_HANDLE;
+    imageInfos.emplace_back(imageInfo);
+
+    VkWriteDescriptorSet set{};
+    set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set.dstSet = descriptor_set_;
+    set.dstBinding = item.dst_binding;
+    set.dstArrayElement = 0;
+    set.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+    set.descriptorCount = 1;
+    set.pImageInfo = &imageInfos.back();
+    set.pNext = nullptr;
+    writes.emplace_back(set);
+  }
+
   vkUpdateDescriptorSets(Engine::GetRenderer()->GetLogicalDevice(), static_cast<uint32_t>(writes.size()),
                          writes.data(), 0, nullptr);
 
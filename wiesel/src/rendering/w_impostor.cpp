@@ -0,0 +1,50 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_impostor.hpp"
+
+#include "util/w_math.hpp"
+
+namespace Wiesel {
+
+float Impostor::GetScreenSize(const glm::mat4& transform_matrix,
+                              const glm::vec3& camera_position,
+                              const glm::mat4& projection) const {
+  return Math::GetScreenSize(center, radius, transform_matrix,
+                             camera_position, projection);
+}
+
+glm::vec2 OctahedralEncode(glm::vec3 direction) {
+  direction /= std::abs(direction.x) + std::abs(direction.y) +
+               std::abs(direction.z);
+  glm::vec2 p{direction.x, direction.z};
+  if (direction.y < 0.0f) {
+    p = (1.0f - glm::abs(glm::vec2(p.y, p.x))) *
+        glm::vec2(p.x >= 0.0f ? 1.0f : -1.0f, p.y >= 0.0f ? 1.0f : -1.0f);
+  }
+  return p * 0.5f + 0.5f;
+}
+
+glm::vec3 OctahedralDecode(glm::vec2 uv) {
+  glm::vec2 p = uv * 2.0f - 1.0f;
+  glm::vec3 direction{p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y};
+  if (direction.y < 0.0f) {
+    glm::vec2 folded =
+        (1.0f - glm::abs(glm::vec2(direction.z, direction.x))) *
+        glm::vec2(direction.x >= 0.0f ? 1.0f : -1.0f,
+                  direction.z >= 0.0f ? 1.0f : -1.0f);
+    direction.x = folded.x;
+    direction.z = folded.y;
+  }
+  return glm::normalize(direction);
+}
+
+}  // namespace Wiesel
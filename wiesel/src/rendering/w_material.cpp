@@ -79,6 +79,15 @@ void Material::Set(Ref<Material> material, Ref<Texture> texture,
     case TextureTypeTransmission:
       break;
   }
+  uint32_t flags = 0;
+  flags |= material->base_texture ? MaterialFlagHasTexture : 0;
+  flags |= material->normal_map ? MaterialFlagHasNormalMap : 0;
+  flags |= material->specular_map ? MaterialFlagHasSpecularMap : 0;
+  flags |= material->height_map ? MaterialFlagHasHeightMap : 0;
+  flags |= material->albedo_map ? MaterialFlagHasAlbedoMap : 0;
+  flags |= material->roughness_map ? MaterialFlagHasRoughnessMap : 0;
+  flags |= material->metallic_map ? MaterialFlagHasMetallicMap : 0;
+  material->flags = flags;
 }
 
 }  // namespace Wiesel
\ No newline at end of file
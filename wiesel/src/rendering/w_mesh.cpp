@@ -47,14 +47,41 @@ void Mesh::Allocate() {
     Deallocate();
   }
 
-  vertex_buffer = Engine::GetRenderer()->CreateVertexBuffer(vertices);
-  index_buffer = Engine::GetRenderer()->CreateIndexBuffer(indices);
+  if (!vertices.empty()) {
+    bounds_min = vertices[0].Pos;
+    bounds_max = vertices[0].Pos;
+    for (const auto& vertex : vertices) {
+      bounds_min = glm::min(bounds_min, vertex.Pos);
+      bounds_max = glm::max(bounds_max, vertex.Pos);
+    }
+  }
+
+  std::vector<PackedVertex3D> packed;
+  std::vector<ShadowVertex3D> shadow;
+  packed.reserve(vertices.size());
+  shadow.reserve(vertices.size());
+  for (const auto& vertex : vertices) {
+    packed.push_back(PackedVertex3D::Pack(vertex));
+    shadow.push_back(ShadowVertex3D::Pack(vertex));
+  }
+  vertex_buffer = Engine::GetRenderer()->CreateVertexBuffer(packed);
+  shadow_vertex_buffer = Engine::GetRenderer()->CreateVertexBuffer(shadow);
+  if (lod_indices.empty()) {
+    index_buffer = Engine::GetRenderer()->CreateIndexBuffer(indices);
+  } else {
+    std::vector<Index> allIndices = indices;
+    for (const auto& lod : lod_indices) {
+      allIndices.insert(allIndices.end(), lod.begin(), lod.end());
+    }
+    index_buffer = Engine::GetRenderer()->CreateIndexBuffer(allIndices);
+  }
   uniform_buffer = Engine::GetRenderer()->CreateUniformBuffer(
       sizeof(MatricesUniformData));
   geometry_descriptors =
       Engine::GetRenderer()->CreateMeshDescriptors(uniform_buffer, mat);
   shadow_descriptors =
       Engine::GetRenderer()->CreateShadowMeshDescriptors(uniform_buffer, mat);
+  handle = Engine::GetRenderer()->CreateMeshHandle(*this);
   allocated_ = true;
 }
 
@@ -62,11 +89,14 @@ void Mesh::Deallocate() {
   if (!allocated_) {
     return;
   }
+  Engine::GetRenderer()->DestroyMeshHandle(handle);
+  handle = {};
   mat = nullptr;
   uniform_buffer = nullptr;
   geometry_descriptors = nullptr;
   shadow_descriptors = nullptr;
   vertex_buffer = nullptr;
+  shadow_vertex_buffer = nullptr;
   index_buffer = nullptr;
   allocated_ = false;
 }
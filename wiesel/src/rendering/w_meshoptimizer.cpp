@@ -0,0 +1,719 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_meshoptimizer.hpp"
+
+#include <numeric>
+#include <unordered_set>
+
+#include "util/w_logger.hpp"
+
+namespace Wiesel::MeshOptimizer {
+
+namespace {
+
+// Forsyth's scoring assumes an LRU cache, a bit larger than the FIFO ones
+// used for analysis works best
+constexpr int kForsythCacheSize = 32;
+constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+// FIFO cache simulation, a vertex is still cached if fewer than
+// WIESEL_VERTEX_CACHE_SIZE misses happened since it was pushed
+class FifoCache {
+ public:
+  explicit FifoCache(size_t vertexCount) : timestamps_(vertexCount, 0) {}
+
+  // Returns true on a miss, which pushes the vertex
+  bool Access(Index index) {
+    if (timestamp_ - timestamps_[index] > WIESEL_VERTEX_CACHE_SIZE) {
+      timestamps_[index] = timestamp_++;
+      return true;
+    }
+    return false;
+  }
+
+  uint32_t AccessTriangle(const Index* triangle) {
+    return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+  }
+
+  void Reset() { timestamp_ += WIESEL_VERTEX_CACHE_SIZE + 1; }
+
+ private:
+  std::vector<uint32_t> timestamps_;
+  uint32_t timestamp_ = WIESEL_VERTEX_CACHE_SIZE + 1;
+};
+
+float ForsythScore(int cachePosition, uint32_t remainingTriangles) {
+  if (remainingTriangles == 0) {
+    return -1.0f;
+  }
+  float score = 0.0f;
+  if (cachePosition >= 0) {
+    // The last triangle's vertices get a fixed score so the next one doesn't
+    // just reuse a single edge of it
+    if (cachePosition < 3) {
+      score = 0.75f;
+    } else {
+      score = std::pow(1.0f - static_cast<float>(cachePosition - 3) /
+                                  static_cast<float>(kForsythCacheSize - 3),
+                       1.5f);
+    }
+  }
+  // Finish off vertices with few triangles left
+  return score +
+         2.0f * std::pow(static_cast<float>(remainingTriangles), -0.5f);
+}
+
+// Levels that would keep more than this of the previous level are dropped
+constexpr float kLodMinReduction = 0.8f;
+constexpr size_t kLodMinTriangles = 64;
+constexpr float kLodTargetError = 0.05f;
+
+// Squared distances to a set of planes, weighted by triangle area. The
+// symmetric 4x4 matrix is stored as the upper 3x3, a vector and a constant.
+struct Quadric {
+  double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+  double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+  double c = 0.0;
+  double weight = 0.0;
+
+  void AddPlane(const glm::dvec3& normal, double distance, double weight) {
+    a00 += weight * normal.x * normal.x;
+    a01 += weight * normal.x * normal.y;
+    a02 += weight * normal.x * normal.z;
+    a11 += weight * normal.y * normal.y;
+    a12 += weight * normal.y * normal.z;
+    a22 += weight * normal.z * normal.z;
+    b0 += weight * normal.x * distance;
+    b1 += weight * normal.y * distance;
+    b2 += weight * normal.z * distance;
+    c += weight * distance * distance;
+    this->weight += weight;
+  }
+
+  Quadric& operator+=(const Quadric& other) {
+    a00 += other.a00;
+    a01 += other.a01;
+    a02 += other.a02;
+    a11 += other.a11;
+    a12 += other.a12;
+    a22 += other.a22;
+    b0 += other.b0;
+    b1 += other.b1;
+    b2 += other.b2;
+    c += other.c;
+    weight += other.weight;
+    return *this;
+  }
+
+  // Weighted average of the squared distances
+  double Error(const glm::vec3& position) const {
+    double x = position.x;
+    double y = position.y;
+    double z = position.z;
+    double error = a00 * x * x + a11 * y * y + a22 * z * z +
+                   2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                   2.0 * (b0 * x + b1 * y + b2 * z) + c;
+    return weight > 0.0 ? std::abs(error) / weight : 0.0;
+  }
+};
+
+uint64_t HashBytes(const void* data, size_t size) {
+  // FNV-1a
+  auto bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = 14695981039346656037ull;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= bytes[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+}  // namespace
+
+float AnalyzeACMR(const std::vector<Index>& indices, size_t vertexCount) {
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount == 0) {
+    return 0.0f;
+  }
+  FifoCache cache(vertexCount);
+  size_t misses = 0;
+  for (size_t i = 0; i < triangleCount; i++) {
+    misses += cache.AccessTriangle(&indices[i * 3]);
+  }
+  return static_cast<float>(misses) / static_cast<float>(triangleCount);
+}
+
+void DeduplicateVertices(std::vector<Vertex3D>& vertices,
+                         std::vector<Index>& indices) {
+  PROFILE_ZONE_SCOPED();
+  // Compared as bytes, there must not be any padding in between
+  static_assert(sizeof(Vertex3D) == sizeof(float) * 17);
+  auto hash = [&vertices](Index index) {
+    return static_cast<size_t>(
+        HashBytes(&vertices[index], sizeof(Vertex3D)));
+  };
+  auto equal = [&vertices](Index a, Index b) {
+    return memcmp(&vertices[a], &vertices[b], sizeof(Vertex3D)) == 0;
+  };
+  std::unordered_set<Index, decltype(hash), decltype(equal)> unique(
+      vertices.size(), hash, equal);
+
+  std::vector<Index> remap(vertices.size());
+  std::vector<Vertex3D> result;
+  result.reserve(vertices.size());
+  for (Index i = 0; i < vertices.size(); i++) {
+    auto [it, inserted] = unique.insert(i);
+    if (inserted) {
+      remap[i] = static_cast<Index>(result.size());
+      result.push_back(vertices[i]);
+    } else {
+      remap[i] = remap[*it];
+    }
+  }
+  if (result.size() == vertices.size()) {
+    return;
+  }
+  for (Index& index : indices) {
+    index = remap[index];
+  }
+  vertices = std::move(result);
+}
+
+void OptimizeVertexCache(std::vector<Index>& indices, size_t vertexCount) {
+  PROFILE_ZONE_SCOPED();
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount < 2) {
+    return;
+  }
+
+  // Triangles using each vertex, the first remaining[v] entries of a vertex's
+  // range are the ones not emitted yet
+  std::vector<uint32_t> offsets(vertexCount + 1, 0);
+  for (Index index : indices) {
+    offsets[index + 1]++;
+  }
+  for (size_t v = 0; v < vertexCount; v++) {
+    offsets[v + 1] += offsets[v];
+  }
+  std::vector<uint32_t> adjacency(indices.size());
+  std::vector<uint32_t> remaining(vertexCount, 0);
+  for (size_t i = 0; i < indices.size(); i++) {
+    Index v = indices[i];
+    adjacency[offsets[v] + remaining[v]++] = static_cast<uint32_t>(i / 3);
+  }
+
+  std::vector<int> cachePosition(vertexCount, -1);
+  std::vector<float> vertexScore(vertexCount);
+  for (size_t v = 0; v < vertexCount; v++) {
+    vertexScore[v] = ForsythScore(-1, remaining[v]);
+  }
+  std::vector<float> triangleScore(triangleCount);
+  std::vector<bool> emitted(triangleCount, false);
+  uint32_t best = 0;
+  for (size_t t = 0; t < triangleCount; t++) {
+    triangleScore[t] = vertexScore[indices[t * 3]] +
+                       vertexScore[indices[t * 3 + 1]] +
+                       vertexScore[indices[t * 3 + 2]];
+    if (triangleScore[t] > triangleScore[best]) {
+      best = static_cast<uint32_t>(t);
+    }
+  }
+
+  std::vector<Index> result;
+  result.reserve(indices.size());
+  std::vector<Index> cache;
+  std::vector<Index> newCache;
+  cache.reserve(kForsythCacheSize + 3);
+  newCache.reserve(kForsythCacheSize + 3);
+  size_t nextUnemitted = 0;
+  while (result.size() < indices.size()) {
+    if (best == kInvalidIndex) {
+      // Nothing in the cache has triangles left, continue in input order
+      while (emitted[nextUnemitted]) {
+        nextUnemitted++;
+      }
+      best = static_cast<uint32_t>(nextUnemitted);
+    }
+    emitted[best] = true;
+
+    newCache.clear();
+    for (int k = 0; k < 3; k++) {
+      Index v = indices[best * 3 + k];
+      result.push_back(v);
+      if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+        newCache.push_back(v);
+      }
+      uint32_t* begin = &adjacency[offsets[v]];
+      uint32_t* end = begin + remaining[v];
+      uint32_t* it = std::find(begin, end, best);
+      if (it != end) {
+        std::swap(*it, *(end - 1));
+        remaining[v]--;
+      }
+    }
+    for (Index v : cache) {
+      if (std::find(newCache.begin(), newCache.end(), v) == newCache.end()) {
+        newCache.push_back(v);
+      }
+    }
+    for (size_t i = 0; i < newCache.size(); i++) {
+      Index v = newCache[i];
+      cachePosition[v] =
+          i < static_cast<size_t>(kForsythCacheSize) ? static_cast<int>(i) : -1;
+      vertexScore[v] = ForsythScore(cachePosition[v], remaining[v]);
+    }
+
+    // Only triangles touching the cache changed, the best one is among them
+    best = kInvalidIndex;
+    float bestScore = -1.0f;
+    for (Index v : newCache) {
+      for (uint32_t i = 0; i < remaining[v]; i++) {
+        uint32_t t = adjacency[offsets[v] + i];
+        triangleScore[t] = vertexScore[indices[t * 3]] +
+                           vertexScore[indices[t * 3 + 1]] +
+                           vertexScore[indices[t * 3 + 2]];
+        if (triangleScore[t] > bestScore) {
+          bestScore = triangleScore[t];
+          best = t;
+        }
+      }
+    }
+    if (newCache.size() > static_cast<size_t>(kForsythCacheSize)) {
+      newCache.resize(kForsythCacheSize);
+    }
+    cache.swap(newCache);
+  }
+  indices = std::move(result);
+}
+
+void OptimizeOverdraw(std::vector<Index>& indices,
+                      const std::vector<Vertex3D>& vertices, float threshold) {
+  PROFILE_ZONE_SCOPED();
+  size_t triangleCount = indices.size() / 3;
+  if (triangleCount < 2) {
+    return;
+  }
+
+  // Hard boundaries are where the cache restarts anyway, a triangle missing
+  // all three vertices
+  FifoCache cache(vertices.size());
+  std::vector<size_t> hardStarts;
+  for (size_t t = 0; t < triangleCount; t++) {
+    if (cache.AccessTriangle(&indices[t * 3]) == 3) {
+      hardStarts.push_back(t);
+    }
+  }
+  hardStarts.push_back(triangleCount);
+
+  // Soft boundaries split those further wherever the cluster so far, starting
+  // with a cold cache, is within threshold of the hard cluster's ACMR
+  std::vector<size_t> clusterStarts;
+  for (size_t c = 0; c + 1 < hardStarts.size(); c++) {
+    size_t start = hardStarts[c];
+    size_t end = hardStarts[c + 1];
+    cache.Reset();
+    uint32_t misses = 0;
+    for (size_t t = start; t < end; t++) {
+      misses += cache.AccessTriangle(&indices[t * 3]);
+    }
+    float clusterACMR = static_cast<float>(misses) / (end - start);
+
+    clusterStarts.push_back(start);
+    cache.Reset();
+    misses = 0;
+    size_t softStart = start;
+    for (size_t t = start; t + 1 < end; t++) {
+      misses += cache.AccessTriangle(&indices[t * 3]);
+      float acmr = static_cast<float>(misses) / (t + 1 - softStart);
+      if (acmr <= clusterACMR * threshold) {
+        clusterStarts.push_back(t + 1);
+        softStart = t + 1;
+        misses = 0;
+        cache.Reset();
+      }
+    }
+  }
+  clusterStarts.push_back(triangleCount);
+  size_t clusterCount = clusterStarts.size() - 1;
+  if (clusterCount < 2) {
+    return;
+  }
+
+  struct Cluster {
+    size_t start;
+    size_t end;
+    float sortKey;
+  };
+  std::vector<Cluster> clusters(clusterCount);
+  std::vector<glm::vec3> centroids(clusterCount);
+  std::vector<glm::vec3> normals(clusterCount);
+  glm::vec3 meshCentroid{0.0f};
+  float meshArea = 0.0f;
+  for (size_t c = 0; c < clusterCount; c++) {
+    glm::vec3 centroid{0.0f};
+    glm::vec3 normal{0.0f};
+    float area = 0.0f;
+    for (size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++) {
+      const glm::vec3& a = vertices[indices[t * 3]].Pos;
+      const glm::vec3& b = vertices[indices[t * 3 + 1]].Pos;
+      const glm::vec3& p = vertices[indices[t * 3 + 2]].Pos;
+      // Twice the area, length of the cross product
+      glm::vec3 cross = glm::cross(b - a, p - a);
+      float triangleArea = glm::length(cross);
+      centroid += (a + b + p) * (triangleArea / 3.0f);
+      normal += cross;
+      area += triangleArea;
+    }
+    meshCentroid += centroid;
+    meshArea += area;
+    centroids[c] = area > 0.0f ? centroid / area : centroid;
+    float length = glm::length(normal);
+    normals[c] = length > 0.0f ? normal / length : normal;
+    clusters[c] = {clusterStarts[c], clusterStarts[c + 1], 0.0f};
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+  for (size_t c = 0; c < clusterCount; c++) {
+    clusters[c].sortKey = glm::dot(centroids[c] - meshCentroid, normals[c]);
+  }
+  std::stable_sort(clusters.begin(), clusters.end(),
+                   [](const Cluster& a, const Cluster& b) {
+                     return a.sortKey > b.sortKey;
+                   });
+
+  std::vector<Index> result;
+  result.reserve(indices.size());
+  for (const auto& cluster : clusters) {
+    result.insert(result.end(), indices.begin() + cluster.start * 3,
+                  indices.begin() + cluster.end * 3);
+  }
+  indices = std::move(result);
+}
+
+void OptimizeVertexFetch(std::vector<Vertex3D>& vertices,
+                         std::vector<Index>& indices) {
+  PROFILE_ZONE_SCOPED();
+  std::vector<Index> remap(vertices.size(), kInvalidIndex);
+  std::vector<Vertex3D> result;
+  result.reserve(vertices.size());
+  for (Index& index : indices) {
+    if (remap[index] == kInvalidIndex) {
+      remap[index] = static_cast<Index>(result.size());
+      result.push_back(vertices[index]);
+    }
+    index = remap[index];
+  }
+  vertices = std::move(result);
+}
+
+void Optimize(std::vector<Vertex3D>& vertices, std::vector<Index>& indices) {
+  PROFILE_ZONE_SCOPED();
+  if (indices.size() < 3) {
+    return;
+  }
+  size_t vertexCount = vertices.size();
+  float acmrBefore = AnalyzeACMR(indices, vertices.size());
+  DeduplicateVertices(vertices, indices);
+  OptimizeVertexCache(indices, vertices.size());
+  OptimizeOverdraw(indices, vertices);
+  OptimizeVertexFetch(vertices, indices);
+  float acmrAfter = AnalyzeACMR(indices, vertices.size());
+  LOG_INFO("Optimized mesh: {} -> {} vertices, ACMR {:.3f} -> {:.3f}",
+           vertexCount, vertices.size(), acmrBefore, acmrAfter);
+}
+
+namespace {
+
+// Simplify, but quadrics are passed in so GenerateLods can carry them from
+// one level to the next. Empty ones are built from indices, collapses merge
+// them in place. Indexed by the first vertex at each position.
+std::vector<Index> SimplifyWithQuadrics(const std::vector<Vertex3D>& vertices,
+                                        const std::vector<Index>& indices,
+                                        size_t target_index_count,
+                                        float target_error,
+                                        std::vector<Quadric>& quadrics) {
+  PROFILE_ZONE_SCOPED();
+  std::vector<Index> result = indices;
+  size_t vertexCount = vertices.size();
+  if (result.size() <= target_index_count || vertexCount == 0) {
+    return result;
+  }
+
+  // Collapses are decided on positions, every vertex maps to the first vertex
+  // sharing its position
+  std::vector<Index> position(vertexCount);
+  {
+    auto hash = [&vertices](Index index) {
+      return static_cast<size_t>(
+          HashBytes(&vertices[index].Pos, sizeof(glm::vec3)));
+    };
+    auto equal = [&vertices](Index a, Index b) {
+      return vertices[a].Pos == vertices[b].Pos;
+    };
+    std::unordered_set<Index, decltype(hash), decltype(equal)> unique(
+        vertexCount, hash, equal);
+    for (Index i = 0; i < vertexCount; i++) {
+      position[i] = *unique.insert(i).first;
+    }
+  }
+
+  // A position used by several vertices is on a seam, moving it would tear
+  // the attributes apart. Borders and non-manifold edges are kept too.
+  std::vector<bool> locked(vertexCount, false);
+  std::vector<Index> firstVertex(vertexCount, kInvalidIndex);
+  for (Index index : result) {
+    Index p = position[index];
+    if (firstVertex[p] == kInvalidIndex) {
+      firstVertex[p] = index;
+    } else if (firstVertex[p] != index) {
+      locked[p] = true;
+    }
+  }
+  auto edgeKey = [](Index a, Index b) {
+    return (static_cast<uint64_t>(a) << 32) | b;
+  };
+  std::unordered_map<uint64_t, uint32_t> halfEdges;
+  halfEdges.reserve(result.size());
+  for (size_t i = 0; i < result.size(); i += 3) {
+    for (int e = 0; e < 3; e++) {
+      halfEdges[edgeKey(position[result[i + e]],
+                        position[result[i + (e + 1) % 3]])]++;
+    }
+  }
+  for (size_t i = 0; i < result.size(); i += 3) {
+    for (int e = 0; e < 3; e++) {
+      Index a = position[result[i + e]];
+      Index b = position[result[i + (e + 1) % 3]];
+      auto opposite = halfEdges.find(edgeKey(b, a));
+      if (halfEdges[edgeKey(a, b)] != 1 || opposite == halfEdges.end() ||
+          opposite->second != 1) {
+        locked[a] = true;
+        locked[b] = true;
+      }
+    }
+  }
+
+  glm::vec3 boundsMin = vertices[result[0]].Pos;
+  glm::vec3 boundsMax = boundsMin;
+  for (Index index : result) {
+    boundsMin = glm::min(boundsMin, vertices[index].Pos);
+    boundsMax = glm::max(boundsMax, vertices[index].Pos);
+  }
+  if (quadrics.empty()) {
+    quadrics.resize(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+      const glm::vec3& a = vertices[result[i]].Pos;
+      const glm::vec3& b = vertices[result[i + 1]].Pos;
+      const glm::vec3& p = vertices[result[i + 2]].Pos;
+      glm::dvec3 cross = glm::cross(glm::dvec3(b - a), glm::dvec3(p - a));
+      double length = glm::length(cross);
+      if (length <= 0.0) {
+        continue;
+      }
+      glm::dvec3 normal = cross / length;
+      double distance = -glm::dot(normal, glm::dvec3(a));
+      for (int k = 0; k < 3; k++) {
+        quadrics[position[result[i + k]]].AddPlane(normal, distance,
+                                                   length * 0.5);
+      }
+    }
+  }
+  double maxError = target_error * glm::length(boundsMax - boundsMin);
+  maxError *= maxError;
+
+  struct Collapse {
+    Index from;
+    Index to;
+    double cost;
+  };
+  std::vector<Collapse> collapses;
+  std::vector<uint32_t> fanOffsets(vertexCount + 1);
+  std::vector<uint32_t> fan;
+  std::vector<Index> remap(vertexCount);
+  std::vector<bool> touched(vertexCount);
+  size_t triangleCount = result.size() / 3;
+  size_t targetTriangleCount = target_index_count / 3;
+  // Collapses in a pass don't share triangles, so their checks stay valid
+  // while applying them together
+  while (triangleCount > targetTriangleCount) {
+    std::fill(fanOffsets.begin(), fanOffsets.end(), 0);
+    for (Index index : result) {
+      fanOffsets[position[index] + 1]++;
+    }
+    for (size_t p = 0; p < vertexCount; p++) {
+      fanOffsets[p + 1] += fanOffsets[p];
+    }
+    fan.resize(result.size());
+    {
+      std::vector<uint32_t> fill(fanOffsets.begin(), fanOffsets.end() - 1);
+      for (size_t i = 0; i < result.size(); i++) {
+        fan[fill[position[result[i]]]++] = static_cast<uint32_t>(i / 3);
+      }
+    }
+
+    collapses.clear();
+    for (size_t i = 0; i < result.size(); i += 3) {
+      for (int e = 0; e < 3; e++) {
+        Index a = result[i + e];
+        Index b = result[i + (e + 1) % 3];
+        for (auto [from, to] : {std::pair{a, b}, std::pair{b, a}}) {
+          if (locked[position[from]]) {
+            continue;
+          }
+          Quadric quadric = quadrics[position[from]];
+          quadric += quadrics[position[to]];
+          double cost = quadric.Error(vertices[to].Pos);
+          if (cost <= maxError) {
+            collapses.push_back({from, to, cost});
+          }
+        }
+      }
+    }
+    if (collapses.empty()) {
+      break;
+    }
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse& a, const Collapse& b) {
+                return a.cost < b.cost;
+              });
+
+    std::iota(remap.begin(), remap.end(), 0);
+    std::fill(touched.begin(), touched.end(), false);
+    size_t collapsed = 0;
+    for (const auto& collapse : collapses) {
+      if (triangleCount <= targetTriangleCount) {
+        break;
+      }
+      Index from = position[collapse.from];
+      Index to = position[collapse.to];
+      if (touched[from] || touched[to]) {
+        continue;
+      }
+      const glm::vec3& target = vertices[collapse.to].Pos;
+      bool valid = true;
+      size_t removed = 0;
+      for (uint32_t f = fanOffsets[from]; f < fanOffsets[from + 1] && valid;
+           f++) {
+        const Index* triangle = &result[fan[f] * 3];
+        bool hasTo = false;
+        for (int k = 0; k < 3; k++) {
+          if (position[triangle[k]] == to) {
+            hasTo = true;
+            // The fan has to reach the target through the same vertex,
+            // otherwise the target's attributes would be wrong for some of it
+            valid &= triangle[k] == collapse.to;
+          }
+        }
+        if (hasTo) {
+          removed++;
+          continue;
+        }
+        // Triangles that stay must not flip or fold over too far
+        glm::vec3 corners[3];
+        for (int k = 0; k < 3; k++) {
+          corners[k] = vertices[triangle[k]].Pos;
+        }
+        glm::vec3 before = glm::cross(corners[1] - corners[0],
+                                      corners[2] - corners[0]);
+        for (int k = 0; k < 3; k++) {
+          if (position[triangle[k]] == from) {
+            corners[k] = target;
+          }
+        }
+        glm::vec3 after = glm::cross(corners[1] - corners[0],
+                                     corners[2] - corners[0]);
+        float beforeLength = glm::length(before);
+        if (beforeLength > 0.0f &&
+            glm::dot(before, after) <=
+                0.25f * beforeLength * glm::length(after)) {
+          valid = false;
+        }
+      }
+      if (!valid || removed == 0) {
+        continue;
+      }
+
+      remap[collapse.from] = collapse.to;
+      quadrics[to] += quadrics[from];
+      for (uint32_t f = fanOffsets[from]; f < fanOffsets[from + 1]; f++) {
+        const Index* triangle = &result[fan[f] * 3];
+        for (int k = 0; k < 3; k++) {
+          touched[position[triangle[k]]] = true;
+        }
+      }
+      triangleCount -= removed;
+      collapsed++;
+    }
+    if (collapsed == 0) {
+      break;
+    }
+
+    size_t write = 0;
+    for (size_t i = 0; i < result.size(); i += 3) {
+      Index a = remap[result[i]];
+      Index b = remap[result[i + 1]];
+      Index p = remap[result[i + 2]];
+      if (position[a] == position[b] || position[a] == position[p] ||
+          position[b] == position[p]) {
+        continue;
+      }
+      result[write++] = a;
+      result[write++] = b;
+      result[write++] = p;
+    }
+    result.resize(write);
+    triangleCount = result.size() / 3;
+  }
+  return result;
+}
+
+}  // namespace
+
+std::vector<Index> Simplify(const std::vector<Vertex3D>& vertices,
+                            const std::vector<Index>& indices,
+                            size_t target_index_count, float target_error) {
+  std::vector<Quadric> quadrics;
+  return SimplifyWithQuadrics(vertices, indices, target_index_count,
+                              target_error, quadrics);
+}
+
+void GenerateLods(const std::vector<Vertex3D>& vertices,
+                  const std::vector<Index>& indices,
+                  std::vector<std::vector<Index>>& lods) {
+  PROFILE_ZONE_SCOPED();
+  std::string counts = std::to_string(indices.size() / 3);
+  std::vector<Index> previous = indices;
+  // Each level starts from the one before, the quadrics carry the error of
+  // every collapse since LOD0 so it doesn't drift with each level
+  std::vector<Quadric> quadrics;
+  for (uint32_t level = 1; level < WIESEL_MAX_MESH_LODS; level++) {
+    size_t target = previous.size() / 6 * 3;
+    if (target / 3 < kLodMinTriangles) {
+      break;
+    }
+    std::vector<Index> lod = SimplifyWithQuadrics(vertices, previous, target,
+                                                  kLodTargetError, quadrics);
+    if (lod.size() > previous.size() * kLodMinReduction) {
+      break;
+    }
+    OptimizeVertexCache(lod, vertices.size());
+    counts += " -> " + std::to_string(lod.size() / 3);
+    previous = lod;
+    lods.push_back(std::move(lod));
+  }
+  if (!lods.empty()) {
+    LOG_INFO("Generated {} LODs, triangles {}", lods.size(), counts);
+  }
+}
+
+}  // namespace Wiesel::MeshOptimizer
@@ -0,0 +1,171 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_occlusion.hpp"
+
+namespace Wiesel {
+
+// Max difference allowed between the matrix the pyramid was captured with
+// and the current one, anything above this is treated as a camera cut.
+static constexpr float kHiZCameraCutThreshold = 0.5f;
+// Small bias so surfaces don't cull themselves because of precision
+static constexpr float kHiZDepthBias = 0.05f;
+
+void HiZPyramid::OnRecorded(const glm::mat4& view_projection, float near_plane,
+                            float far_plane, uint32_t width, uint32_t height) {
+  pending_view_projection_ = view_projection;
+  pending_near_plane_ = near_plane;
+  pending_far_plane_ = far_plane;
+  pending_width_ = width;
+  pending_height_ = height;
+  pending_ = true;
+}
+
+void HiZPyramid::Update(const float* data, uint32_t stride) {
+  PROFILE_ZONE_SCOPED();
+  uint32_t width = pending_width_;
+  uint32_t height = pending_height_;
+  if (!pending_ || data == nullptr || width == 0 || height == 0 ||
+      stride < width) {
+    return;
+  }
+  pending_ = false;
+
+  if (levels_.empty() || levels_[0].width != width ||
+      levels_[0].height != height) {
+    levels_.clear();
+    uint32_t w = width;
+    uint32_t h = height;
+    while (true) {
+      levels_.push_back({w, h, std::vector<float>(w * h)});
+      if (w == 1 && h == 1) {
+        break;
+      }
+      w = std::max(1u, (w + 1) / 2);
+      h = std::max(1u, (h + 1) / 2);
+    }
+  }
+
+  for (uint32_t y = 0; y < height; y++) {
+    memcpy(levels_[0].depths.data() + y * width, data + y * stride,
+           sizeof(float) * width);
+  }
+  for (size_t i = 1; i < levels_.size(); i++) {
+    const Level& src = levels_[i - 1];
+    Level& dst = levels_[i];
+    for (uint32_t y = 0; y < dst.height; y++) {
+      uint32_t sy0 = std::min(y * 2, src.height - 1);
+      uint32_t sy1 = std::min(y * 2 + 1, src.height - 1);
+      for (uint32_t x = 0; x < dst.width; x++) {
+        uint32_t sx0 = std::min(x * 2, src.width - 1);
+        uint32_t sx1 = std::min(x * 2 + 1, src.width - 1);
+        dst.depths[y * dst.width + x] =
+            std::max(std::max(src.depths[sy0 * src.width + sx0],
+                              src.depths[sy0 * src.width + sx1]),
+                     std::max(src.depths[sy1 * src.width + sx0],
+                              src.depths[sy1 * src.width + sx1]));
+      }
+    }
+  }
+
+  view_projection_ = pending_view_projection_;
+  near_plane_ = pending_near_plane_;
+  far_plane_ = pending_far_plane_;
+  valid_ = true;
+}
+
+void HiZPyramid::Invalidate() {
+  valid_ = false;
+  pending_ = false;
+}
+
+bool HiZPyramid::IsUsableFor(const glm::mat4& view_projection) const {
+  if (!valid_) {
+    return false;
+  }
+  for (int c = 0; c < 4; c++) {
+    for (int r = 0; r < 4; r++) {
+      if (std::abs(view_projection[c][r] - view_projection_[c][r]) >
+          kHiZCameraCutThreshold) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+float HiZPyramid::LinearDepth(float depth) const {
+  // Same as linearDepth in geometry_shader.frag
+  float z = depth * 2.0f - 1.0f;
+  return (2.0f * near_plane_ * far_plane_) /
+         (far_plane_ + near_plane_ - z * (far_plane_ - near_plane_));
+}
+
+bool HiZPyramid::IsOccluded(const glm::vec3& bounds_min,
+                            const glm::vec3& bounds_max,
+                            const glm::mat4& model) const {
+  if (!valid_) {
+    return false;
+  }
+  glm::mat4 mvp = view_projection_ * model;
+  glm::vec2 uv_min{1.0f};
+  glm::vec2 uv_max{0.0f};
+  float nearest = std::numeric_limits<float>::max();
+  for (int i = 0; i < 8; i++) {
+    glm::vec3 corner{(i & 1) ? bounds_max.x : bounds_min.x,
+                     (i & 2) ? bounds_max.y : bounds_min.y,
+                     (i & 4) ? bounds_max.z : bounds_min.z};
+    glm::vec4 clip = mvp * glm::vec4(corner, 1.0f);
+    if (clip.w <= near_plane_) {
+      // Crosses the near plane, can't say anything about it
+      return false;
+    }
+    glm::vec3 ndc = glm::vec3(clip) / clip.w;
+    glm::vec2 uv = glm::vec2(ndc) * 0.5f + 0.5f;
+    uv_min = glm::min(uv_min, uv);
+    uv_max = glm::max(uv_max, uv);
+    nearest = std::min(nearest, LinearDepth(ndc.z));
+  }
+  if (uv_max.x < 0.0f || uv_max.y < 0.0f || uv_min.x > 1.0f ||
+      uv_min.y > 1.0f) {
+    // Off screen, frustum culling should handle this
+    return false;
+  }
+  uv_min = glm::clamp(uv_min, 0.0f, 1.0f);
+  uv_max = glm::clamp(uv_max, 0.0f, 1.0f);
+
+  // Pick the level where the rect covers around 2x2 texels
+  const Level& base = levels_[0];
+  float size = std::max((uv_max.x - uv_min.x) * base.width,
+                        (uv_max.y - uv_min.y) * base.height);
+  uint32_t level = static_cast<uint32_t>(
+      std::ceil(std::log2(std::max(size * 0.5f, 1.0f))));
+  level = std::min(level, static_cast<uint32_t>(levels_.size() - 1));
+  const Level& l = levels_[level];
+
+  // Dilate by a texel, the resolve may average edge pixels with the cleared ones
+  int32_t x0 = std::max(static_cast<int32_t>(uv_min.x * l.width) - 1, 0);
+  int32_t y0 = std::max(static_cast<int32_t>(uv_min.y * l.height) - 1, 0);
+  int32_t x1 = std::min(static_cast<int32_t>(uv_max.x * l.width) + 1,
+                        static_cast<int32_t>(l.width) - 1);
+  int32_t y1 = std::min(static_cast<int32_t>(uv_max.y * l.height) + 1,
+                        static_cast<int32_t>(l.height) - 1);
+
+  float occluder = 0.0f;
+  for (int32_t y = y0; y <= y1; y++) {
+    for (int32_t x = x0; x <= x1; x++) {
+      occluder = std::max(occluder, l.depths[y * l.width + x]);
+    }
+  }
+  return nearest > occluder + kHiZDepthBias;
+}
+
+}  // namespace Wiesel
@@ -25,8 +25,9 @@ Pipeline::~Pipeline() {
   is_allocated_ = false;
 }
 
-void Pipeline::SetRenderPass(Ref<RenderPass> pass) {
+void Pipeline::SetRenderPass(Ref<RenderPass> pass, uint32_t subpass) {
   m_RenderPass = pass;
+  subpass_ = subpass;
 }
 
 void Pipeline::AddInputLayout(Ref<DescriptorSetLayout> layout) {
@@ -38,6 +39,7 @@ void Pipeline::AddDynamicState(VkDynamicState state) {
 }
 
 void Pipeline::AddShader(Ref<Shader> shader) {
+  shader->pipelines_.push_back(weak_from_this());
   shaders_.push_back({
       .shader = shader
   });
@@ -62,15 +64,43 @@ void Pipeline::Bake() {
     is_allocated_ = false;
   }
 
+  std::vector<VkShaderModule> modules;
+  modules.reserve(shaders_.size());
+  for (const auto& info : shaders_) {
+    modules.push_back(info.shader->shader_module_);
+  }
+  CreateHandles(GetCreateState(), modules, layout_, pipeline_);
+  is_allocated_ = true;
+  bake_version_++;
+}
+
+Pipeline::CreateState Pipeline::GetCreateState() const {
+  return {
+      .properties = properties_,
+      .shaders = shaders_,
+      .dynamic_states = dynamic_states_,
+      .render_pass = m_RenderPass,
+      .subpass = subpass_,
+      .descriptor_layouts = descriptor_layouts_,
+      .has_vertex_binding = has_vertex_binding_,
+      .vertex_input_binding_descriptions = vertex_input_binding_descriptions_,
+      .vertex_attribute_descriptions = vertex_attribute_descriptions_,
+      .push_constants = push_constants_
+  };
+}
+
+void Pipeline::CreateHandles(const CreateState& state,
+                             const std::vector<VkShaderModule>& modules,
+                             VkPipelineLayout& layout, VkPipeline& pipeline) {
   std::vector<VkDescriptorSetLayout> layouts;
-  layouts.reserve(descriptor_layouts_.size());
-  for (const auto& item : descriptor_layouts_) {
+  layouts.reserve(state.descriptor_layouts.size());
+  for (const auto& item : state.descriptor_layouts) {
     layouts.push_back(item->layout_);
   }
 
   std::vector<VkPushConstantRange> pushConstants;
-  pushConstants.reserve(push_constants_.size());
-  for (const auto& item : push_constants_) {
+  pushConstants.reserve(state.push_constants.size());
+  for (const auto& item : state.push_constants) {
     pushConstants.push_back({
         .stageFlags = item.flags,
         .offset = item.offset,
@@ -85,18 +115,19 @@ void Pipeline::Bake() {
   pipelineLayoutInfo.pPushConstantRanges = pushConstants.data();
 
   WIESEL_CHECK_VKRESULT(vkCreatePipelineLayout(
-      Engine::GetRenderer()->GetLogicalDevice(), &pipelineLayoutInfo, nullptr, &layout_));
+      Engine::GetRenderer()->GetLogicalDevice(), &pipelineLayoutInfo, nullptr, &layout));
 
   std::vector<VkPipelineShaderStageCreateInfo> shaderStages;
   std::vector<VkSpecializationInfo> specializationInfos;
-  specializationInfos.reserve(shaders_.size());
+  specializationInfos.reserve(state.shaders.size());
   uint32_t specializationIndex = 0;
-  for (const auto& info : shaders_) {
+  for (size_t i = 0; i < state.shaders.size(); i++) {
+    const ShaderInfo& info = state.shaders[i];
     VkPipelineShaderStageCreateInfo stageInfo{};
     stageInfo.sType =
         VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     stageInfo.stage = GetShaderFlagBitsByType(info.shader->properties_.type);
-    stageInfo.module = info.shader->shader_module_;
+    stageInfo.module = modules[i];
     stageInfo.pName = info.shader->properties_.main.c_str();
     if (info.specialization.data != nullptr) {
       specializationInfos[specializationIndex] = VkSpecializationInfo{
@@ -111,10 +142,22 @@ void Pipeline::Bake() {
     shaderStages.push_back(stageInfo);
   }
 
+  if (shaderStages.size() == 1 &&
+      shaderStages[0].stage == VK_SHADER_STAGE_COMPUTE_BIT) {
+    VkComputePipelineCreateInfo pipelineInfo{};
+    pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    pipelineInfo.stage = shaderStages[0];
+    pipelineInfo.layout = layout;
+    WIESEL_CHECK_VKRESULT(
+        vkCreateComputePipelines(Engine::GetRenderer()->GetLogicalDevice(), VK_NULL_HANDLE, 1,
+                                 &pipelineInfo, nullptr, &pipeline));
+    return;
+  }
+
   std::vector<VkDynamicState> dynamicStates;
   dynamicStates.push_back(VK_DYNAMIC_STATE_VIEWPORT);
   dynamicStates.push_back(VK_DYNAMIC_STATE_SCISSOR);
-  for (const auto& item : dynamic_states_) {
+  for (const auto& item : state.dynamic_states) {
     dynamicStates.push_back(item);
   }
 
@@ -127,13 +170,13 @@ void Pipeline::Bake() {
   vertexInputInfo.sType =
       VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-  if (has_vertex_binding_) {
+  if (state.has_vertex_binding) {
     vertexInputInfo.vertexBindingDescriptionCount =
-        static_cast<uint32_t>(vertex_input_binding_descriptions_.size());
-    vertexInputInfo.pVertexBindingDescriptions = vertex_input_binding_descriptions_.data();
+        static_cast<uint32_t>(state.vertex_input_binding_descriptions.size());
+    vertexInputInfo.pVertexBindingDescriptions = state.vertex_input_binding_descriptions.data();
     vertexInputInfo.vertexAttributeDescriptionCount =
-        static_cast<uint32_t>(vertex_attribute_descriptions_.size());
-    vertexInputInfo.pVertexAttributeDescriptions = vertex_attribute_descriptions_.data();
+        static_cast<uint32_t>(state.vertex_attribute_descriptions.size());
+    vertexInputInfo.pVertexAttributeDescriptions = state.vertex_attribute_descriptions.data();
   } else {
     vertexInputInfo.vertexBindingDescriptionCount = 0;
     vertexInputInfo.vertexAttributeDescriptionCount = 0;
@@ -161,13 +204,13 @@ void Pipeline::Bake() {
      * VK_POLYGON_MODE_LINE: polygon edges are drawn as lines
      * VK_POLYGON_MODE_POINT: polygon vertices are drawn as points
      */
-  if (properties_.enable_wireframe) {
+  if (state.properties.enable_wireframe) {
     rasterizer.polygonMode = VK_POLYGON_MODE_LINE;
   } else {
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
   }
   rasterizer.lineWidth = 1.0f;
-  switch (properties_.cull_mode) {
+  switch (state.properties.cull_mode) {
     case CullModeNone:
       rasterizer.cullMode = VK_CULL_MODE_NONE;
       break;
@@ -189,18 +232,16 @@ void Pipeline::Bake() {
   multisampling.sType =
       VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
   multisampling.sampleShadingEnable = VK_FALSE;
-  multisampling.rasterizationSamples = properties_.msaa_samples;
+  multisampling.rasterizationSamples = state.properties.msaa_samples;
 
   std::vector<VkPipelineColorBlendAttachmentState> colorBlendAttachments;
-  for (const auto& item : m_RenderPass->attachments_) {
-    if (item.type != AttachmentTextureType::Color && item.type != AttachmentTextureType::Offscreen) {
-      continue;
-    }
+  uint32_t colorAttachmentCount = state.render_pass->GetColorAttachmentCount(state.subpass);
+  for (uint32_t i = 0; i < colorAttachmentCount; i++) {
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask =
         VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
         VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    if (properties_.enable_alpha_blending) {
+    if (state.properties.enable_alpha_blending) {
       colorBlendAttachment.blendEnable = VK_TRUE;
       colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
       colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
@@ -224,12 +265,12 @@ void Pipeline::Bake() {
   VkPipelineDepthStencilStateCreateInfo depthStencil{};
   depthStencil.sType =
       VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-  if (properties_.enable_depth_test) {
+  if (state.properties.enable_depth_test) {
     depthStencil.depthTestEnable = VK_TRUE;
   } else {
     depthStencil.depthTestEnable = VK_FALSE;
   }
-  if (properties_.enable_depth_write) {
+  if (state.properties.enable_depth_write) {
     depthStencil.depthWriteEnable = VK_TRUE;
   } else {
     depthStencil.depthWriteEnable = VK_FALSE;
@@ -252,15 +293,13 @@ void Pipeline::Bake() {
   pipelineInfo.pDepthStencilState = &depthStencil;
   pipelineInfo.pColorBlendState = &colorBlending;
   pipelineInfo.pDynamicState = &dynamicState;
-  pipelineInfo.layout = layout_;
-  pipelineInfo.renderPass = m_RenderPass->GetVulkanHandle();
-  pipelineInfo.subpass = 0;
+  pipelineInfo.layout = layout;
+  pipelineInfo.renderPass = state.render_pass->GetVulkanHandle();
+  pipelineInfo.subpass = state.subpass;
 
   WIESEL_CHECK_VKRESULT(
       vkCreateGraphicsPipelines(Engine::GetRenderer()->GetLogicalDevice(), VK_NULL_HANDLE, 1,
-                                &pipelineInfo, nullptr, &pipeline_));
-
-  is_allocated_ = true;
+                                &pipelineInfo, nullptr, &pipeline));
 }
 
 void Pipeline::Bind(PipelineBindPoint bind_point) {
@@ -24,6 +24,7 @@ namespace Wiesel {
 
 Renderer::Renderer(Ref<AppWindow> window) : window_(window) {
   Spirv::Init();
+  shader_library_ = CreateReference<ShaderLibrary>(WIESEL_SHADER_LIBRARY_PATH);
 #ifdef VULKAN_VALIDATION
   validation_layers_.push_back("VK_LAYER_KHRONOS_validation");
 #endif
@@ -39,7 +40,36 @@ Renderer::Renderer(Ref<AppWindow> window) : window_(window) {
   recreate_pipeline_ = false;
   enable_wireframe_ = false;
   enable_ssao_ = true;
+  enable_ssao_temporal_ = true;
   only_ssao_ = false;
+  enable_occlusion_culling_ = true;
+  enable_impostors_ = true;
+  impostor_screen_size_ = WIESEL_IMPOSTOR_SCREEN_SIZE;
+  enable_mesh_lods_ = true;
+  lod_screen_size_ = WIESEL_LOD_SCREEN_SIZE;
+  shadow_lod_bias_ = 1;
+  anti_aliasing_ = AntiAliasing::FXAA;
+  enable_fused_lighting_ = true;
+  enable_direct_composite_ = true;
+  enable_static_passes_ = true;
+  enable_async_compute_ = true;
+  enable_shader_hot_reload_ = false;
+  static_pass_version_ = 1;
+  static_pass_ssao_temporal_ = false;
+  static_pass_only_ssao_ = false;
+  static_pass_render_pass_ = VK_NULL_HANDLE;
+  static_pass_framebuffer_ = VK_NULL_HANDLE;
+  static_pass_viewport_ = {};
+  composite_in_present_ = false;
+  enable_dynamic_resolution_ = true;
+  composite_pipeline_push_constant_ =
+      CreateReference<CompositePipelinePushConstant>();
+  geometry_pipeline_push_constant_ =
+      CreateReference<GeometryPipelinePushConstant>();
+  impostor_bake_push_constant_ = CreateReference<ImpostorBakePushConstant>();
+#ifdef ID_BUFFER_PASS
+  id_pipeline_push_constant_ = CreateReference<IDPipelinePushConstant>();
+#endif
   recreate_swap_chain_ = false;
   swap_chain_created_ = false;
   enable_vsync_ = true;
@@ -73,6 +103,7 @@ void Renderer::Initialize(const RendererProperties&& properties) {
   CreateCommandBuffers();
   CreatePermanentResources();
   CreateSyncObjects();
+  CreateTimestampQueries();
   CreateTracy();
   initialized_ = true;
 }
@@ -117,6 +148,12 @@ Ref<MemoryBuffer> Renderer::CreateVertexBuffer(std::vector<T> vertices) {
 template Ref<MemoryBuffer> Renderer::CreateVertexBuffer<Vertex3D>(
     std::vector<Vertex3D>);
 
+template Ref<MemoryBuffer> Renderer::CreateVertexBuffer<PackedVertex3D>(
+    std::vector<PackedVertex3D>);
+
+template Ref<MemoryBuffer> Renderer::CreateVertexBuffer<ShadowVertex3D>(
+    std::vector<ShadowVertex3D>);
+
 template Ref<MemoryBuffer> Renderer::CreateVertexBuffer<Vertex2DNoColor>(
     std::vector<Vertex2DNoColor>);
 
@@ -132,9 +169,24 @@ Ref<IndexBuffer> Renderer::CreateIndexBuffer(std::vector<Index> indices) {
   Ref<IndexBuffer> memoryBuffer = CreateReference<IndexBuffer>();
 
   static_assert(sizeof(Index) == sizeof(uint32_t));
-  memoryBuffer->index_type_ = VK_INDEX_TYPE_UINT32;
   memoryBuffer->size_ = indices.size();
-  VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
+  // Most meshes index fewer than 65536 vertices, those get half the memory
+  // and index fetch bandwidth
+  std::vector<uint16_t> shortIndices;
+  Index maxIndex = indices.empty()
+                       ? 0
+                       : *std::max_element(indices.begin(), indices.end());
+  const void* source = indices.data();
+  VkDeviceSize bufferSize;
+  if (maxIndex <= std::numeric_limits<uint16_t>::max()) {
+    shortIndices.assign(indices.begin(), indices.end());
+    memoryBuffer->index_type_ = VK_INDEX_TYPE_UINT16;
+    source = shortIndices.data();
+    bufferSize = sizeof(uint16_t) * shortIndices.size();
+  } else {
+    memoryBuffer->index_type_ = VK_INDEX_TYPE_UINT32;
+    bufferSize = sizeof(Index) * indices.size();
+  }
 
   VkBuffer stagingBuffer;
   VkDeviceMemory stagingBufferMemory;
@@ -145,7 +197,7 @@ Ref<IndexBuffer> Renderer::CreateIndexBuffer(std::vector<Index> indices) {
 
   void* data;
   vkMapMemory(logical_device_, stagingBufferMemory, 0, bufferSize, 0, &data);
-  memcpy(data, indices.data(), (size_t)bufferSize);
+  memcpy(data, source, (size_t)bufferSize);
   vkUnmapMemory(logical_device_, stagingBufferMemory);
 
   CreateBuffer(
@@ -196,261 +248,546 @@ void Renderer::DestroyUniformBuffer(UniformBuffer& buffer) {
   vkFreeMemory(logical_device_, buffer.memory_handle_, nullptr);
 }
 
+Ref<StorageBuffer> Renderer::CreateStorageBuffer(VkDeviceSize size,
+                                                 VkBufferUsageFlags usage) {
+  Ref<StorageBuffer> storageBuffer = CreateReference<StorageBuffer>();
+  storageBuffer->size_ = size;
+  CreateBuffer(size, usage,
+               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+               storageBuffer->buffer_handle_, storageBuffer->memory_handle_);
+
+  WIESEL_CHECK_VKRESULT(vkMapMemory(logical_device_,
+                                    storageBuffer->memory_handle_, 0, size, 0,
+                                    &storageBuffer->data_));
+  memset(storageBuffer->data_, 0, size);
+  return storageBuffer;
+}
+
+void Renderer::DestroyStorageBuffer(StorageBuffer& buffer) {
+  vkDeviceWaitIdle(logical_device_);
+  vkDestroyBuffer(logical_device_, buffer.buffer_handle_, nullptr);
+  vkFreeMemory(logical_device_, buffer.memory_handle_, nullptr);
+}
+
+Ref<ReadbackBuffer> Renderer::CreateReadbackBuffer(VkDeviceSize size) {
+  Ref<ReadbackBuffer> readbackBuffer = CreateReference<ReadbackBuffer>();
+  readbackBuffer->size_ = size;
+  CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
+                   VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+               readbackBuffer->buffer_handle_, readbackBuffer->memory_handle_);
+
+  WIESEL_CHECK_VKRESULT(vkMapMemory(logical_device_,
+                                    readbackBuffer->memory_handle_, 0, size, 0,
+                                    &readbackBuffer->data_));
+  memset(readbackBuffer->data_, 0, size);
+  return readbackBuffer;
+}
+
+void Renderer::DestroyReadbackBuffer(ReadbackBuffer& buffer) {
+  if (!destroying_retired_) {
+    vkDeviceWaitIdle(logical_device_);
+  }
+  vkDestroyBuffer(logical_device_, buffer.buffer_handle_, nullptr);
+  vkFreeMemory(logical_device_, buffer.memory_handle_, nullptr);
+}
+
 void Renderer::SetupCameraComponent(CameraComponent& component) {
+  // Kept across resizes, the render packet points at it
+  if (!component.resources) {
+    component.resources = CreateReference<CameraResources>();
+  }
+  CameraResources& resources = *component.resources;
+  if (resources.geometry_framebuffer) {
+    // Frames in flight may still render into the old targets, hold on to
+    // them instead of waiting for the device when they are replaced below
+    retired_camera_resources_.push_back({resources, frame_index_});
+  }
+  if (!resources.camera_uniform_buffer) {
+    resources.lights_uniform_buffer =
+        CreateUniformBuffer(sizeof(LightsUniformData));
+    resources.camera_uniform_buffer =
+        CreateUniformBuffer(sizeof(CameraUniformData));
+    resources.shadow_camera_uniform_buffer =
+        CreateUniformBuffer(sizeof(ShadowMapMatricesUniformData));
+    resources.point_lights_storage_buffer =
+        CreateStorageBuffer(sizeof(LightPoint) * WIESEL_MAX_POINT_LIGHTS);
+    resources.light_clusters_storage_buffer =
+        CreateStorageBuffer(sizeof(LightCluster) * WIESEL_CLUSTER_COUNT);
+    resources.light_indices_storage_buffer = CreateStorageBuffer(
+        sizeof(uint32_t) * WIESEL_CLUSTER_MAX_LIGHT_INDICES);
+  }
+  resources.ssao_gen_commands = {};
+  resources.ssao_temporal_commands = {};
+  resources.ssao_blur_horz_commands = {};
+  resources.ssao_blur_vert_commands = {};
+  resources.lighting_commands = {};
+  resources.fxaa_commands = {};
+  resources.taa_commands = {};
+  resources.composite_commands = {};
+  // New targets are empty, render them right away whatever the interval
+  component.frames_until_render = 0;
+  component.next_render_time = 0.0f;
   component.aspect_ratio = Engine::GetRenderer()->GetAspectRatio();
   VkExtent2D extent = Engine::GetRenderer()->GetExtent();
   component.viewport_size.x = extent.width;
   component.viewport_size.y = extent.height;
 
-  component.ssao_color_image = CreateAttachmentTexture(
+  resources.ssao_color_image = CreateAttachmentTexture(
       {extent.width / 2, extent.height / 2, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
-  component.ssao_blur_horz_color_image = CreateAttachmentTexture(
+  resources.ssao_blur_horz_color_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
-  component.ssao_blur_vert_color_image = CreateAttachmentTexture(
+  resources.ssao_blur_vert_color_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
-  component.ssao_gen_framebuffer = ssao_gen_render_pass_->CreateFramebuffer(
-      0, {component.ssao_color_image->image_views_[0]},
+  resources.ssao_gen_framebuffer = ssao_gen_render_pass_->CreateFramebuffer(
+      0, {resources.ssao_color_image->image_views_[0]},
       {extent.width / 2, extent.height / 2});
-  component.ssao_blur_horz_framebuffer = ssao_blur_horz_render_pass_->CreateFramebuffer(
-      0, {component.ssao_blur_horz_color_image->image_views_[0]},
+  resources.ssao_blur_horz_framebuffer = ssao_blur_horz_render_pass_->CreateFramebuffer(
+      0, {resources.ssao_blur_horz_color_image->image_views_[0]},
       {extent.width, extent.height});
-  component.ssao_blur_vert_framebuffer = ssao_blur_vert_render_pass_->CreateFramebuffer(
-      0, {component.ssao_blur_vert_color_image->image_views_[0]},
+  resources.ssao_blur_vert_framebuffer = ssao_blur_vert_render_pass_->CreateFramebuffer(
+      0, {resources.ssao_blur_vert_color_image->image_views_[0]},
       {extent.width, extent.height});
+  for (uint32_t i = 0; i < resources.ssao_history_images.size(); i++) {
+    resources.ssao_history_images[i] = CreateAttachmentTexture(
+        {extent.width / 2, extent.height / 2, AttachmentTextureType::Offscreen, 1,
+         VK_FORMAT_R16G16_SFLOAT, VK_SAMPLE_COUNT_1_BIT, true});
+    resources.ssao_history_framebuffers[i] =
+        ssao_temporal_render_pass_->CreateFramebuffer(
+            0, {resources.ssao_history_images[i]->image_views_[0]},
+            {extent.width / 2, extent.height / 2});
+  }
+  resources.ssao_history_index = 0;
+  // Zero matrix makes the temporal pass reject the (empty) history
+  resources.previous_view_projection = glm::mat4{0.0f};
 
-  component.geometry_view_pos_image = CreateAttachmentTexture(
+  resources.geometry_view_pos_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R32G32B32A32_SFLOAT, msaa_samples_, true});
-  component.geometry_world_pos_image = CreateAttachmentTexture(
+  resources.geometry_world_pos_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R32G32B32A32_SFLOAT, msaa_samples_, true});
-  component.GeometryDepthImage = CreateAttachmentTexture(
+  resources.geometry_depth_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R32_SFLOAT, msaa_samples_, true});
-  component.geometry_normal_image = CreateAttachmentTexture(
+  resources.geometry_normal_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R8G8B8A8_UNORM, msaa_samples_, true});
-  component.geometry_albedo_image = CreateAttachmentTexture(
+  resources.geometry_albedo_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R8G8B8A8_UNORM, msaa_samples_, true});
-  component.geometry_material_image = CreateAttachmentTexture(
+  resources.geometry_material_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        VK_FORMAT_R16G16B16A16_SFLOAT, msaa_samples_, true});
-  component.geometry_depth_stencil = CreateAttachmentTexture(
+  resources.geometry_depth_stencil = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::DepthStencil, 1,
        FindDepthFormat(), msaa_samples_, true});
 
-  component.shadow_depth_stencil = CreateAttachmentTexture(
+#ifdef ID_BUFFER_PASS
+  // Only the pick region, BeginIDPass shifts the viewport onto it
+  resources.id_image = CreateAttachmentTexture(
+      {WIESEL_PICK_REGION_SIZE, WIESEL_PICK_REGION_SIZE,
+       AttachmentTextureType::Offscreen, 1, VK_FORMAT_R32_UINT,
+       VK_SAMPLE_COUNT_1_BIT, true});
+  resources.id_depth_stencil = CreateAttachmentTexture(
+      {WIESEL_PICK_REGION_SIZE, WIESEL_PICK_REGION_SIZE,
+       AttachmentTextureType::DepthStencil, 1, FindDepthFormat(),
+       VK_SAMPLE_COUNT_1_BIT, true});
+  std::array<AttachmentTexture*, 2> idTextures = {
+      resources.id_image.get(), resources.id_depth_stencil.get()};
+  resources.id_framebuffer = id_render_pass_->CreateFramebuffer(
+      0, idTextures, {WIESEL_PICK_REGION_SIZE, WIESEL_PICK_REGION_SIZE});
+#endif
+
+  resources.shadow_depth_stencil = CreateAttachmentTexture(
       {WIESEL_SHADOWMAP_DIM, WIESEL_SHADOWMAP_DIM,
        AttachmentTextureType::DepthStencil, 1, FindDepthFormat(),
        VK_SAMPLE_COUNT_1_BIT, true, WIESEL_SHADOW_CASCADE_COUNT});
-  component.shadow_depth_view_array =
-      CreateImageView(component.shadow_depth_stencil, VK_IMAGE_VIEW_TYPE_2D_ARRAY,
+  resources.shadow_depth_view_array =
+      CreateImageView(resources.shadow_depth_stencil, VK_IMAGE_VIEW_TYPE_2D_ARRAY,
                       0, WIESEL_SHADOW_CASCADE_COUNT);
   for (int i = 0; i < WIESEL_SHADOW_CASCADE_COUNT; ++i) {
-    component.shadow_depth_views[i] =
-        CreateImageView(component.shadow_depth_stencil, VK_IMAGE_VIEW_TYPE_2D, i);
+    resources.shadow_depth_views[i] =
+        CreateImageView(resources.shadow_depth_stencil, VK_IMAGE_VIEW_TYPE_2D, i);
     std::array<ImageView*, 1> textures = {
-        component.shadow_depth_views[i].get(),
+        resources.shadow_depth_views[i].get(),
     };
-    component.shadow_framebuffers[i] = shadow_render_pass_->CreateFramebuffer(
+    resources.shadow_framebuffers[i] = shadow_render_pass_->CreateFramebuffer(
         0, textures, {WIESEL_SHADOWMAP_DIM, WIESEL_SHADOWMAP_DIM});
   }
 
   if (msaa_samples_ > VK_SAMPLE_COUNT_1_BIT) {
-    component.geometry_view_pos_resolve_image = CreateAttachmentTexture(
+    resources.geometry_view_pos_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, true});
-    component.geometry_world_pos_resolve_image = CreateAttachmentTexture(
+    resources.geometry_world_pos_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          VK_FORMAT_R32G32B32A32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, true});
-    component.geometry_depth_resolve_image = CreateAttachmentTexture(
+    resources.geometry_depth_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, true});
-    component.geometry_normal_resolve_image = CreateAttachmentTexture(
+    resources.geometry_normal_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
-    component.geometry_albedo_resolve_image = CreateAttachmentTexture(
+    resources.geometry_albedo_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
-    component.geometry_material_resolve_image = CreateAttachmentTexture(
+    resources.geometry_material_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          VK_FORMAT_R16G16B16A16_SFLOAT, VK_SAMPLE_COUNT_1_BIT, true});
     std::array<AttachmentTexture*, 13> textures = {
-        component.geometry_view_pos_image.get(),
-        component.geometry_world_pos_image.get(),
-        component.GeometryDepthImage.get(),
-        component.geometry_normal_image.get(),
-        component.geometry_albedo_image.get(),
-        component.geometry_material_image.get(),
-        component.geometry_depth_stencil.get(),
-        component.geometry_view_pos_resolve_image.get(),
-        component.geometry_world_pos_resolve_image.get(),
-        component.geometry_depth_resolve_image.get(),
-        component.geometry_normal_resolve_image.get(),
-        component.geometry_albedo_resolve_image.get(),
-        component.geometry_material_resolve_image.get(),
+        resources.geometry_view_pos_image.get(),
+        resources.geometry_world_pos_image.get(),
+        resources.geometry_depth_image.get(),
+        resources.geometry_normal_image.get(),
+        resources.geometry_albedo_image.get(),
+        resources.geometry_material_image.get(),
+        resources.geometry_depth_stencil.get(),
+        resources.geometry_view_pos_resolve_image.get(),
+        resources.geometry_world_pos_resolve_image.get(),
+        resources.geometry_depth_resolve_image.get(),
+        resources.geometry_normal_resolve_image.get(),
+        resources.geometry_albedo_resolve_image.get(),
+        resources.geometry_material_resolve_image.get(),
     };
-    component.geometry_framebuffer = geometry_render_pass_->CreateFramebuffer(
+    resources.geometry_framebuffer = geometry_render_pass_->CreateFramebuffer(
         0, textures, component.viewport_size);
   } else {
-    component.geometry_view_pos_resolve_image = component.geometry_view_pos_image;
-    component.geometry_world_pos_resolve_image = component.geometry_world_pos_image;
-    component.geometry_depth_resolve_image = component.GeometryDepthImage;
-    component.geometry_normal_resolve_image = component.geometry_normal_image;
-    component.geometry_albedo_resolve_image = component.geometry_albedo_image;
-    component.geometry_material_resolve_image = component.geometry_material_image;
+    resources.geometry_view_pos_resolve_image = resources.geometry_view_pos_image;
+    resources.geometry_world_pos_resolve_image = resources.geometry_world_pos_image;
+    resources.geometry_depth_resolve_image = resources.geometry_depth_image;
+    resources.geometry_normal_resolve_image = resources.geometry_normal_image;
+    resources.geometry_albedo_resolve_image = resources.geometry_albedo_image;
+    resources.geometry_material_resolve_image = resources.geometry_material_image;
     std::array<AttachmentTexture*, 7> textures = {
-        component.geometry_view_pos_image.get(),
-        component.geometry_world_pos_image.get(),
-        component.GeometryDepthImage.get(),
-        component.geometry_normal_image.get(),
-        component.geometry_albedo_image.get(),
-        component.geometry_depth_stencil.get(),
-        component.geometry_material_image.get(),
+        resources.geometry_view_pos_image.get(),
+        resources.geometry_world_pos_image.get(),
+        resources.geometry_depth_image.get(),
+        resources.geometry_normal_image.get(),
+        resources.geometry_albedo_image.get(),
+        resources.geometry_material_image.get(),
+        resources.geometry_depth_stencil.get(),
     };
-    component.geometry_framebuffer = geometry_render_pass_->CreateFramebuffer(
+    resources.geometry_framebuffer = geometry_render_pass_->CreateFramebuffer(
         0, textures, component.viewport_size);
   }
 
-  component.lighting_color_image = CreateAttachmentTexture(
+  uint32_t hizWidth =
+      (extent.width + WIESEL_HIZ_DOWNSAMPLE - 1) / WIESEL_HIZ_DOWNSAMPLE;
+  uint32_t hizHeight =
+      (extent.height + WIESEL_HIZ_DOWNSAMPLE - 1) / WIESEL_HIZ_DOWNSAMPLE;
+  AttachmentTextureProps hizProps{hizWidth, hizHeight,
+                                  AttachmentTextureType::Offscreen, 1,
+                                  VK_FORMAT_R32_SFLOAT, VK_SAMPLE_COUNT_1_BIT, true};
+  hizProps.storage = true;
+  resources.hiz_image = CreateAttachmentTexture(hizProps);
+  resources.hiz_framebuffer = hiz_render_pass_->CreateFramebuffer(
+      0, {resources.hiz_image->image_views_[0]}, {hizWidth, hizHeight});
+  resources.hiz_readback_buffer =
+      CreateReadbackBuffer(sizeof(float) * hizWidth * hizHeight);
+  if (!resources.hiz_pyramid) {
+    resources.hiz_pyramid = CreateReference<HiZPyramid>();
+  } else {
+    resources.hiz_pyramid->Invalidate();
+  }
+
+  // Without msaa there is no resolve image, later passes sample this directly
+  resources.lighting_color_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
-       swap_chain_image_format_, msaa_samples_});
+       swap_chain_image_format_, msaa_samples_,
+       msaa_samples_ == VK_SAMPLE_COUNT_1_BIT});
   if (msaa_samples_ > VK_SAMPLE_COUNT_1_BIT) {
-    component.lighting_color_resolve_image = CreateAttachmentTexture(
+    resources.lighting_color_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          swap_chain_image_format_, VK_SAMPLE_COUNT_1_BIT, true});
 
     std::array<AttachmentTexture*, 2> textures{
-        component.lighting_color_image.get(),
-        component.lighting_color_resolve_image.get()};
-    component.lighting_framebuffer = lighting_render_pass_->CreateFramebuffer(
+        resources.lighting_color_image.get(),
+        resources.lighting_color_resolve_image.get()};
+    resources.lighting_framebuffer = lighting_render_pass_->CreateFramebuffer(
         0, textures, {extent.width, extent.height});
   } else {
-    component.lighting_color_resolve_image = component.lighting_color_image;
+    resources.lighting_color_resolve_image = resources.lighting_color_image;
     std::array<AttachmentTexture*, 1> textures{
-        component.lighting_color_image.get()};
-    component.lighting_framebuffer = lighting_render_pass_->CreateFramebuffer(
+        resources.lighting_color_image.get()};
+    resources.lighting_framebuffer = lighting_render_pass_->CreateFramebuffer(
         0, textures, {extent.width, extent.height});
   }
 
-  component.sprite_color_image = CreateAttachmentTexture(
+  resources.fxaa_color_image = CreateAttachmentTexture(
+      {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
+       swap_chain_image_format_, VK_SAMPLE_COUNT_1_BIT, true});
+  resources.fxaa_framebuffer = anti_aliasing_render_pass_->CreateFramebuffer(
+      0, {resources.fxaa_color_image->image_views_[0]},
+      {extent.width, extent.height});
+  for (uint32_t i = 0; i < resources.taa_history_images.size(); i++) {
+    resources.taa_history_images[i] = CreateAttachmentTexture(
+        {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
+         swap_chain_image_format_, VK_SAMPLE_COUNT_1_BIT, true});
+    resources.taa_history_framebuffers[i] =
+        anti_aliasing_render_pass_->CreateFramebuffer(
+            0, {resources.taa_history_images[i]->image_views_[0]},
+            {extent.width, extent.height});
+  }
+  resources.taa_history_index = 0;
+
+  if (geometry_lighting_render_pass_) {
+    resources.transient_view_pos_image = CreateAttachmentTexture(
+        {.width = extent.width, .height = extent.height,
+         .type = AttachmentTextureType::Offscreen,
+         .image_format = VK_FORMAT_R32G32B32A32_SFLOAT,
+         .transient = true, .input_attachment = true});
+    resources.transient_world_pos_image = CreateAttachmentTexture(
+        {.width = extent.width, .height = extent.height,
+         .type = AttachmentTextureType::Offscreen,
+         .image_format = VK_FORMAT_R32G32B32A32_SFLOAT,
+         .transient = true, .input_attachment = true});
+    resources.transient_normal_image = CreateAttachmentTexture(
+        {.width = extent.width, .height = extent.height,
+         .type = AttachmentTextureType::Offscreen,
+         .image_format = VK_FORMAT_R8G8B8A8_UNORM,
+         .transient = true, .input_attachment = true});
+    resources.transient_albedo_image = CreateAttachmentTexture(
+        {.width = extent.width, .height = extent.height,
+         .type = AttachmentTextureType::Offscreen,
+         .image_format = VK_FORMAT_R8G8B8A8_UNORM,
+         .transient = true, .input_attachment = true});
+    resources.transient_material_image = CreateAttachmentTexture(
+        {.width = extent.width, .height = extent.height,
+         .type = AttachmentTextureType::Offscreen,
+         .image_format = VK_FORMAT_R16G16B16A16_SFLOAT,
+         .transient = true, .input_attachment = true});
+    resources.transient_depth_stencil = CreateAttachmentTexture(
+        {.width = extent.width, .height = extent.height,
+         .type = AttachmentTextureType::DepthStencil,
+         .image_format = FindDepthFormat(), .transient = true});
+    // Linear depth is stored for the Hi-Z pass
+    std::array<AttachmentTexture*, 8> textures = {
+        resources.transient_view_pos_image.get(),
+        resources.transient_world_pos_image.get(),
+        resources.geometry_depth_image.get(),
+        resources.transient_normal_image.get(),
+        resources.transient_albedo_image.get(),
+        resources.transient_material_image.get(),
+        resources.transient_depth_stencil.get(),
+        resources.lighting_color_image.get(),
+    };
+    resources.geometry_lighting_framebuffer =
+        geometry_lighting_render_pass_->CreateFramebuffer(
+            0, textures, component.viewport_size);
+
+    resources.geometry_input_descriptor = CreateReference<DescriptorSet>();
+    resources.geometry_input_descriptor->SetLayout(
+        geometry_input_descriptor_layout_);
+    resources.geometry_input_descriptor->AddInputAttachment(
+        0, resources.transient_view_pos_image->image_views_[0]);
+    resources.geometry_input_descriptor->AddInputAttachment(
+        1, resources.transient_world_pos_image->image_views_[0]);
+    resources.geometry_input_descriptor->AddInputAttachment(
+        2, resources.transient_normal_image->image_views_[0]);
+    resources.geometry_input_descriptor->AddInputAttachment(
+        3, resources.transient_albedo_image->image_views_[0]);
+    resources.geometry_input_descriptor->AddInputAttachment(
+        4, resources.transient_material_image->image_views_[0]);
+    resources.geometry_input_descriptor->Bake();
+  } else {
+    resources.transient_view_pos_image = nullptr;
+    resources.transient_world_pos_image = nullptr;
+    resources.transient_normal_image = nullptr;
+    resources.transient_albedo_image = nullptr;
+    resources.transient_material_image = nullptr;
+    resources.transient_depth_stencil = nullptr;
+    resources.geometry_lighting_framebuffer = nullptr;
+    resources.geometry_input_descriptor = nullptr;
+  }
+
+  resources.sprite_color_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
        swap_chain_image_format_, VK_SAMPLE_COUNT_1_BIT, true});
 
-  std::array<AttachmentTexture*, 1> textures{component.sprite_color_image.get()};
-  component.sprite_framebuffer = sprite_render_pass_->CreateFramebuffer(
+  std::array<AttachmentTexture*, 1> textures{resources.sprite_color_image.get()};
+  resources.sprite_framebuffer = sprite_render_pass_->CreateFramebuffer(
       0, textures, {extent.width, extent.height});
 
-  component.composite_color_image = CreateAttachmentTexture(
+  resources.composite_color_image = CreateAttachmentTexture(
       {extent.width, extent.height, AttachmentTextureType::Offscreen, 1,
-       swap_chain_image_format_, msaa_samples_});
+       swap_chain_image_format_, msaa_samples_,
+       msaa_samples_ == VK_SAMPLE_COUNT_1_BIT});
   if (msaa_samples_ > VK_SAMPLE_COUNT_1_BIT) {
-    component.composite_color_resolve_image = CreateAttachmentTexture(
+    resources.composite_color_resolve_image = CreateAttachmentTexture(
         {extent.width, extent.height, AttachmentTextureType::Resolve, 1,
          swap_chain_image_format_, VK_SAMPLE_COUNT_1_BIT, true});
 
     std::array<AttachmentTexture*, 2> textures{
-        component.composite_color_image.get(),
-        component.composite_color_resolve_image.get()};
-    component.composite_framebuffer = lighting_render_pass_->CreateFramebuffer(
+        resources.composite_color_image.get(),
+        resources.composite_color_resolve_image.get()};
+    resources.composite_framebuffer = lighting_render_pass_->CreateFramebuffer(
         0, textures, {extent.width, extent.height});
   } else {
-    component.composite_color_resolve_image = component.lighting_color_image;
+    resources.composite_color_resolve_image = resources.composite_color_image;
     std::array<AttachmentTexture*, 1> textures{
-        component.composite_color_image.get()};
-    component.composite_framebuffer = lighting_render_pass_->CreateFramebuffer(
+        resources.composite_color_image.get()};
+    resources.composite_framebuffer = lighting_render_pass_->CreateFramebuffer(
         0, textures, {extent.width, extent.height});
   }
 
-  component.global_descriptor = CreateGlobalDescriptors(component);
-  component.shadow_descriptor = CreateShadowGlobalDescriptors(component);
-  component.geometry_output_descriptor = CreateReference<DescriptorSet>();
-  component.geometry_output_descriptor->SetLayout(
+  resources.global_descriptor = CreateGlobalDescriptors(component);
+  resources.bound_shadow_image = blank_shadow_map_;
+  resources.bound_shadow_view = blank_shadow_view_;
+  resources.shadow_descriptor = CreateShadowGlobalDescriptors(component);
+  resources.geometry_output_descriptor = CreateReference<DescriptorSet>();
+  resources.geometry_output_descriptor->SetLayout(
       geometry_output_descriptor_layout_);
-  component.geometry_output_descriptor->AddCombinedImageSampler(
-      0, component.geometry_view_pos_resolve_image->image_views_[0],
+  resources.geometry_output_descriptor->AddCombinedImageSampler(
+      0, resources.geometry_view_pos_resolve_image->image_views_[0],
+      default_nearest_sampler_);
+  resources.geometry_output_descriptor->AddCombinedImageSampler(
+      1, resources.geometry_world_pos_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.geometry_output_descriptor->AddCombinedImageSampler(
-      1, component.geometry_world_pos_resolve_image->image_views_[0],
+  resources.geometry_output_descriptor->AddCombinedImageSampler(
+      2, resources.geometry_depth_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.geometry_output_descriptor->AddCombinedImageSampler(
-      2, component.geometry_depth_resolve_image->image_views_[0],
+  resources.geometry_output_descriptor->AddCombinedImageSampler(
+      3, resources.geometry_normal_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.geometry_output_descriptor->AddCombinedImageSampler(
-      3, component.geometry_normal_resolve_image->image_views_[0],
+  resources.geometry_output_descriptor->AddCombinedImageSampler(
+      4, resources.geometry_albedo_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.geometry_output_descriptor->AddCombinedImageSampler(
-      4, component.geometry_albedo_resolve_image->image_views_[0],
+  resources.geometry_output_descriptor->AddCombinedImageSampler(
+      5, resources.geometry_material_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.geometry_output_descriptor->AddCombinedImageSampler(
-      5, component.geometry_material_resolve_image->image_views_[0],
+  resources.geometry_output_descriptor->Bake();
+
+  resources.hiz_input_descriptor = CreateReference<DescriptorSet>();
+  resources.hiz_input_descriptor->SetLayout(present_descriptor_layout_);
+  resources.hiz_input_descriptor->AddCombinedImageSampler(
+      0, resources.geometry_depth_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.geometry_output_descriptor->Bake();
+  resources.hiz_input_descriptor->Bake();
 
-  component.lighting_output_descriptor = CreateReference<DescriptorSet>();
-  component.lighting_output_descriptor->SetLayout(present_descriptor_layout_);
-  component.lighting_output_descriptor->AddCombinedImageSampler(
-      0, component.lighting_color_resolve_image->image_views_[0],
+  resources.hiz_compute_descriptor = CreateReference<DescriptorSet>();
+  resources.hiz_compute_descriptor->SetLayout(hiz_compute_descriptor_layout_);
+  resources.hiz_compute_descriptor->AddCombinedImageSampler(
+      0, resources.geometry_depth_resolve_image->image_views_[0],
+      default_nearest_sampler_);
+  resources.hiz_compute_descriptor->AddStorageImage(
+      1, resources.hiz_image->image_views_[0]);
+  resources.hiz_compute_descriptor->Bake();
+
+  resources.lighting_output_descriptor = CreateReference<DescriptorSet>();
+  resources.lighting_output_descriptor->SetLayout(present_descriptor_layout_);
+  resources.lighting_output_descriptor->AddCombinedImageSampler(
+      0, resources.lighting_color_resolve_image->image_views_[0],
       default_linear_sampler_);
-  component.lighting_output_descriptor->Bake();
+  resources.lighting_output_descriptor->Bake();
+
+  resources.fxaa_output_descriptor = CreateReference<DescriptorSet>();
+  resources.fxaa_output_descriptor->SetLayout(present_descriptor_layout_);
+  resources.fxaa_output_descriptor->AddCombinedImageSampler(
+      0, resources.fxaa_color_image->image_views_[0], default_linear_sampler_);
+  resources.fxaa_output_descriptor->Bake();
+
+  for (uint32_t i = 0; i < resources.taa_history_images.size(); i++) {
+    // Reads last frame's history, writes into taa_history_images[i]
+    uint32_t previous = (i + 1) % resources.taa_history_images.size();
+    resources.taa_descriptors[i] = CreateReference<DescriptorSet>();
+    resources.taa_descriptors[i]->SetLayout(taa_descriptor_layout_);
+    resources.taa_descriptors[i]->AddCombinedImageSampler(
+        0, resources.lighting_color_resolve_image->image_views_[0], default_nearest_sampler_);
+    resources.taa_descriptors[i]->AddCombinedImageSampler(
+        1, resources.taa_history_images[previous]->image_views_[0], default_linear_sampler_);
+    resources.taa_descriptors[i]->AddCombinedImageSampler(
+        2, resources.geometry_depth_resolve_image->image_views_[0], default_nearest_sampler_);
+    resources.taa_descriptors[i]->Bake();
+
+    resources.taa_history_output_descriptors[i] = CreateReference<DescriptorSet>();
+    resources.taa_history_output_descriptors[i]->SetLayout(present_descriptor_layout_);
+    resources.taa_history_output_descriptors[i]->AddCombinedImageSampler(
+        0, resources.taa_history_images[i]->image_views_[0], default_linear_sampler_);
+    resources.taa_history_output_descriptors[i]->Bake();
+  }
 
-  component.sprite_output_descriptor = CreateReference<DescriptorSet>();
-  component.sprite_output_descriptor->SetLayout(present_descriptor_layout_);
-  component.sprite_output_descriptor->AddCombinedImageSampler(
-      0, component.sprite_color_image->image_views_[0],
+  resources.sprite_output_descriptor = CreateReference<DescriptorSet>();
+  resources.sprite_output_descriptor->SetLayout(present_descriptor_layout_);
+  resources.sprite_output_descriptor->AddCombinedImageSampler(
+      0, resources.sprite_color_image->image_views_[0],
       default_linear_sampler_);
-  component.sprite_output_descriptor->Bake();
+  resources.sprite_output_descriptor->Bake();
 
-  component.composite_output_descriptor = CreateReference<DescriptorSet>();
-  component.composite_output_descriptor->SetLayout(present_descriptor_layout_);
-  component.composite_output_descriptor->AddCombinedImageSampler(
-      0, component.composite_color_resolve_image->image_views_[0],
+  resources.composite_output_descriptor = CreateReference<DescriptorSet>();
+  resources.composite_output_descriptor->SetLayout(present_descriptor_layout_);
+  resources.composite_output_descriptor->AddCombinedImageSampler(
+      0, resources.composite_color_resolve_image->image_views_[0],
       default_linear_sampler_);
-  component.composite_output_descriptor->Bake();
+  resources.composite_output_descriptor->Bake();
 
-  component.ssao_gen_descriptor = CreateReference<DescriptorSet>();
-  component.ssao_gen_descriptor->SetLayout(ssao_gen_descriptor_layout_);
-  component.ssao_gen_descriptor->AddCombinedImageSampler(
-      0, component.geometry_view_pos_resolve_image->image_views_[0],
+  resources.ssao_gen_descriptor = CreateReference<DescriptorSet>();
+  resources.ssao_gen_descriptor->SetLayout(ssao_gen_descriptor_layout_);
+  resources.ssao_gen_descriptor->AddCombinedImageSampler(
+      0, resources.geometry_view_pos_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.ssao_gen_descriptor->AddCombinedImageSampler(
-      1, component.geometry_normal_resolve_image->image_views_[0],
+  resources.ssao_gen_descriptor->AddCombinedImageSampler(
+      1, resources.geometry_normal_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.ssao_gen_descriptor->AddCombinedImageSampler(
-      2, component.geometry_depth_resolve_image->image_views_[0],
+  resources.ssao_gen_descriptor->AddCombinedImageSampler(
+      2, resources.geometry_depth_resolve_image->image_views_[0],
       default_nearest_sampler_);
-  component.ssao_gen_descriptor->AddCombinedImageSampler(
+  resources.ssao_gen_descriptor->AddCombinedImageSampler(
       3, ssao_noise_->image_views_[0], default_linear_sampler_);
-  component.ssao_gen_descriptor->AddUniformBuffer(4, ssao_kernel_uniform_buffer_);
-  component.ssao_gen_descriptor->Bake();
-
-  component.ssao_output_descriptor = CreateReference<DescriptorSet>();
-  component.ssao_output_descriptor->SetLayout(ssao_output_descriptor_layout_);
-  component.ssao_output_descriptor->AddCombinedImageSampler(
-      0, component.ssao_color_image->image_views_[0], default_nearest_sampler_);
-  component.ssao_output_descriptor->AddCombinedImageSampler(
-      1, component.geometry_depth_resolve_image->image_views_[0],default_nearest_sampler_);
-  component.ssao_output_descriptor->Bake();
-
-  component.ssao_blur_horz_output_descriptor = CreateReference<DescriptorSet>();
-  component.ssao_blur_horz_output_descriptor->SetLayout(ssao_blur_descriptor_layout_);
-  component.ssao_blur_horz_output_descriptor->AddCombinedImageSampler(
-      0, component.ssao_blur_horz_color_image->image_views_[0], default_linear_sampler_);
-  component.ssao_blur_horz_output_descriptor->AddCombinedImageSampler(
-      1, component.geometry_depth_resolve_image->image_views_[0],default_nearest_sampler_);
-  component.ssao_blur_horz_output_descriptor->Bake();
-
-  component.ssao_blur_vert_output_descriptor = CreateReference<DescriptorSet>();
-  component.ssao_blur_vert_output_descriptor->SetLayout(ssao_blur_descriptor_layout_);
-  component.ssao_blur_vert_output_descriptor->AddCombinedImageSampler(
-      0, component.ssao_blur_vert_color_image->image_views_[0], default_linear_sampler_);
-  component.ssao_blur_horz_output_descriptor->AddCombinedImageSampler(
-      1, component.geometry_depth_resolve_image->image_views_[0],default_nearest_sampler_);
-  component.ssao_blur_vert_output_descriptor->Bake();
+  resources.ssao_gen_descriptor->AddUniformBuffer(4, ssao_kernel_uniform_buffer_);
+  resources.ssao_gen_descriptor->Bake();
+
+  resources.ssao_output_descriptor = CreateReference<DescriptorSet>();
+  resources.ssao_output_descriptor->SetLayout(ssao_output_descriptor_layout_);
+  resources.ssao_output_descriptor->AddCombinedImageSampler(
+      0, resources.ssao_color_image->image_views_[0], default_nearest_sampler_);
+  resources.ssao_output_descriptor->AddCombinedImageSampler(
+      1, resources.geometry_depth_resolve_image->image_views_[0],default_nearest_sampler_);
+  resources.ssao_output_descriptor->Bake();
+
+  resources.ssao_blur_horz_output_descriptor = CreateReference<DescriptorSet>();
+  resources.ssao_blur_horz_output_descriptor->SetLayout(ssao_blur_descriptor_layout_);
+  resources.ssao_blur_horz_output_descriptor->AddCombinedImageSampler(
+      0, resources.ssao_blur_horz_color_image->image_views_[0], default_linear_sampler_);
+  resources.ssao_blur_horz_output_descriptor->AddCombinedImageSampler(
+      1, resources.geometry_depth_resolve_image->image_views_[0],default_nearest_sampler_);
+  resources.ssao_blur_horz_output_descriptor->Bake();
+
+  resources.ssao_blur_vert_output_descriptor = CreateReference<DescriptorSet>();
+  resources.ssao_blur_vert_output_descriptor->SetLayout(ssao_blur_descriptor_layout_);
+  resources.ssao_blur_vert_output_descriptor->AddCombinedImageSampler(
+      0, resources.ssao_blur_vert_color_image->image_views_[0], default_linear_sampler_);
+  resources.ssao_blur_vert_output_descriptor->AddCombinedImageSampler(
+      1, resources.geometry_depth_resolve_image->image_views_[0],default_nearest_sampler_);
+  resources.ssao_blur_vert_output_descriptor->Bake();
+
+  for (uint32_t i = 0; i < resources.ssao_history_images.size(); i++) {
+    // Reads last frame's history, writes into ssao_history_images[i]
+    uint32_t previous = (i + 1) % resources.ssao_history_images.size();
+    resources.ssao_temporal_descriptors[i] = CreateReference<DescriptorSet>();
+    resources.ssao_temporal_descriptors[i]->SetLayout(ssao_temporal_descriptor_layout_);
+    resources.ssao_temporal_descriptors[i]->AddCombinedImageSampler(
+        0, resources.ssao_color_image->image_views_[0], default_nearest_sampler_);
+    resources.ssao_temporal_descriptors[i]->AddCombinedImageSampler(
+        1, resources.ssao_history_images[previous]->image_views_[0], default_linear_sampler_);
+    resources.ssao_temporal_descriptors[i]->AddCombinedImageSampler(
+        2, resources.geometry_world_pos_resolve_image->image_views_[0], default_nearest_sampler_);
+    resources.ssao_temporal_descriptors[i]->AddCombinedImageSampler(
+        3, resources.geometry_depth_resolve_image->image_views_[0], default_nearest_sampler_);
+    resources.ssao_temporal_descriptors[i]->Bake();
+
+    resources.ssao_history_output_descriptors[i] = CreateReference<DescriptorSet>();
+    resources.ssao_history_output_descriptors[i]->SetLayout(ssao_output_descriptor_layout_);
+    resources.ssao_history_output_descriptors[i]->AddCombinedImageSampler(
+        0, resources.ssao_history_images[i]->image_views_[0], default_nearest_sampler_);
+    resources.ssao_history_output_descriptors[i]->AddCombinedImageSampler(
+        1, resources.geometry_depth_resolve_image->image_views_[0], default_nearest_sampler_);
+    resources.ssao_history_output_descriptors[i]->Bake();
+  }
 
   component.view_changed = true;
   component.pos_changed = true;
@@ -804,6 +1141,16 @@ Ref<AttachmentTexture> Renderer::CreateAttachmentTexture(
   if (props.transfer_dest) {
     flags |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
   }
+  if (props.input_attachment) {
+    flags |= VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+  }
+  if (props.storage) {
+    flags |= VK_IMAGE_USAGE_STORAGE_BIT;
+  }
+  VkMemoryPropertyFlags memoryProperties = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+  if (props.transient) {
+    memoryProperties |= VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+  }
 
   int aspectFlags;
   if (props.type == AttachmentTextureType::DepthStencil) {
@@ -820,7 +1167,7 @@ Ref<AttachmentTexture> Renderer::CreateAttachmentTexture(
   for (uint32_t i = 0; i < props.image_count; i++) {
     CreateImage(props.width, props.height, 1, props.msaa_samples,
                 props.image_format, VK_IMAGE_TILING_OPTIMAL, flags,
-                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture->images_[i],
+                memoryProperties, texture->images_[i],
                 texture->device_memories_[i], 0, props.layer_count);
 
     if (props.layer_count != 1)
@@ -936,7 +1283,9 @@ void Renderer::DestroyAttachmentTexture(AttachmentTexture& texture) {
   if (!texture.is_allocated_) {
     return;
   }
-  vkDeviceWaitIdle(logical_device_);
+  if (!destroying_retired_) {
+    vkDeviceWaitIdle(logical_device_);
+  }
   texture.image_views_.clear();
   if (texture.type_ != AttachmentTextureType::SwapChain) {
     for (VkImage& image : texture.images_) {
@@ -1258,12 +1607,190 @@ Ref<DescriptorSet> Renderer::CreateShadowMeshDescriptors(
   return object;
 }
 
+MeshHandle Renderer::CreateMeshHandle(const Mesh& mesh) {
+  MeshDrawData data{};
+  data.vertex_buffer = mesh.vertex_buffer->buffer_handle_;
+  data.shadow_vertex_buffer = mesh.shadow_vertex_buffer->buffer_handle_;
+  data.index_buffer = mesh.index_buffer->buffer_handle_;
+  data.index_type = mesh.index_buffer->index_type_;
+  data.lods[0] = {0, static_cast<uint32_t>(mesh.indices.size())};
+  data.lod_count = 1;
+  uint32_t firstIndex = data.lods[0].index_count;
+  for (const auto& lod : mesh.lod_indices) {
+    if (data.lod_count == WIESEL_MAX_MESH_LODS) {
+      break;
+    }
+    data.lods[data.lod_count++] = {firstIndex,
+                                   static_cast<uint32_t>(lod.size())};
+    firstIndex += static_cast<uint32_t>(lod.size());
+  }
+  data.material_flags = mesh.mat->flags;
+  data.geometry_descriptor = mesh.geometry_descriptors->descriptor_set_;
+  data.shadow_descriptor = mesh.shadow_descriptors->descriptor_set_;
+  data.uniform_data = mesh.uniform_buffer->data_;
+  return mesh_pool_.Create(data);
+}
+
+void Renderer::DestroyMeshHandle(MeshHandle handle) {
+  mesh_pool_.Release(handle);
+}
+
+Ref<Impostor> Renderer::CreateImpostor(const Model& model) {
+  PROFILE_ZONE_SCOPED();
+  glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+  glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+  std::vector<const MeshDrawData*> meshes;
+  for (const auto& mesh : model.meshes) {
+    const MeshDrawData* data =
+        mesh->allocated_ ? mesh_pool_.Get(mesh->handle) : nullptr;
+    if (!data) {
+      continue;
+    }
+    boundsMin = glm::min(boundsMin, mesh->bounds_min);
+    boundsMax = glm::max(boundsMax, mesh->bounds_max);
+    meshes.push_back(data);
+  }
+  if (meshes.empty()) {
+    return nullptr;
+  }
+
+  Ref<Impostor> impostor = CreateReference<Impostor>();
+  impostor->center = (boundsMin + boundsMax) * 0.5f;
+  impostor->radius =
+      std::max(glm::length(boundsMax - boundsMin) * 0.5f, 0.001f);
+
+  constexpr uint32_t kFrameSize = WIESEL_IMPOSTOR_FRAME_SIZE;
+  constexpr uint32_t kAtlasSize = WIESEL_IMPOSTOR_GRID * kFrameSize;
+  impostor->albedo_image = CreateAttachmentTexture(
+      {kAtlasSize, kAtlasSize, AttachmentTextureType::Offscreen, 1,
+       VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
+  impostor->normal_depth_image = CreateAttachmentTexture(
+      {kAtlasSize, kAtlasSize, AttachmentTextureType::Offscreen, 1,
+       VK_FORMAT_R8G8B8A8_UNORM, VK_SAMPLE_COUNT_1_BIT, true});
+  // Only needed while baking
+  Ref<AttachmentTexture> depthStencil = CreateAttachmentTexture(
+      {kAtlasSize, kAtlasSize, AttachmentTextureType::DepthStencil, 1,
+       FindDepthFormat(), VK_SAMPLE_COUNT_1_BIT});
+  std::array<AttachmentTexture*, 3> textures = {
+      impostor->albedo_image.get(),
+      impostor->normal_depth_image.get(),
+      depthStencil.get(),
+  };
+  Ref<Framebuffer> framebuffer = impostor_bake_render_pass_->CreateFramebuffer(
+      0, textures, {kAtlasSize, kAtlasSize});
+
+  // Pipelines and passes record into command_buffer_, the frame's buffer is
+  // put back once the bake is submitted
+  Ref<CommandBuffer> frameCommandBuffer = command_buffer_;
+  command_buffer_ = command_pool_->CreateBuffer();
+  command_buffer_->Begin();
+  impostor_bake_render_pass_->Begin(framebuffer, {0.0f, 0.0f, 0.0f, 0.0f});
+  float radius = impostor->radius;
+  for (uint32_t y = 0; y < WIESEL_IMPOSTOR_GRID; y++) {
+    for (uint32_t x = 0; x < WIESEL_IMPOSTOR_GRID; x++) {
+      glm::vec3 direction = OctahedralDecode(
+          (glm::vec2(x, y) + 0.5f) / static_cast<float>(WIESEL_IMPOSTOR_GRID));
+      // Has to match the basis in impostor_shader.vert
+      glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f)
+                                                   : glm::vec3(0.0f, 1.0f, 0.0f);
+      glm::mat4 view = glm::lookAt(impostor->center + direction * radius * 2.0f,
+                                   impostor->center, up);
+      // Bounding sphere covers the whole frame and the [0, 1] depth range
+      glm::mat4 projection =
+          glm::ortho(-radius, radius, -radius, radius, radius, radius * 3.0f);
+      projection[1][1] *= -1;
+      impostor_bake_push_constant_->view_projection = projection * view;
+      impostor_bake_pipeline_->Bind(PipelineBindPointGraphics);
+
+      VkViewport viewport{};
+      viewport.x = static_cast<float>(x * kFrameSize);
+      viewport.y = static_cast<float>(y * kFrameSize);
+      viewport.width = static_cast<float>(kFrameSize);
+      viewport.height = static_cast<float>(kFrameSize);
+      viewport.minDepth = 0.0f;
+      viewport.maxDepth = 1.0f;
+      vkCmdSetViewport(command_buffer_->handle_, 0, 1, &viewport);
+      VkRect2D scissor{};
+      scissor.offset = {static_cast<int32_t>(x * kFrameSize),
+                        static_cast<int32_t>(y * kFrameSize)};
+      scissor.extent = {kFrameSize, kFrameSize};
+      vkCmdSetScissor(command_buffer_->handle_, 0, 1, &scissor);
+
+      for (const MeshDrawData* mesh : meshes) {
+        VkDeviceSize offset = 0;
+        vkCmdBindVertexBuffers(command_buffer_->handle_, 0, 1,
+                               &mesh->vertex_buffer, &offset);
+        vkCmdBindIndexBuffer(command_buffer_->handle_, mesh->index_buffer, 0,
+                             mesh->index_type);
+        vkCmdBindDescriptorSets(command_buffer_->handle_,
+                                VK_PIPELINE_BIND_POINT_GRAPHICS,
+                                impostor_bake_pipeline_->layout_, 0, 1,
+                                &mesh->geometry_descriptor, 0, nullptr);
+        impostor_bake_push_constant_->material_flags = mesh->material_flags;
+        vkCmdPushConstants(
+            command_buffer_->handle_, impostor_bake_pipeline_->layout_,
+            VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+            sizeof(ImpostorBakePushConstant),
+            impostor_bake_push_constant_.get());
+        vkCmdDrawIndexed(command_buffer_->handle_, mesh->lods[0].index_count,
+                         1, 0, 0, 0);
+      }
+    }
+  }
+  impostor_bake_render_pass_->End();
+  TransitionImageLayout(impostor->albedo_image->images_[0],
+                        impostor->albedo_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(impostor->normal_depth_image->images_[0],
+                        impostor->normal_depth_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  command_buffer_->End();
+
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &command_buffer_->handle_;
+  WIESEL_CHECK_VKRESULT(
+      vkQueueSubmit(graphics_queue_, 1, &submitInfo, VK_NULL_HANDLE));
+  vkQueueWaitIdle(graphics_queue_);
+  command_buffer_ = frameCommandBuffer;
+
+  impostor->descriptor = CreateReference<DescriptorSet>();
+  impostor->descriptor->SetLayout(impostor_descriptor_layout_);
+  impostor->descriptor->AddCombinedImageSampler(
+      0, impostor->albedo_image->image_views_[0], default_linear_sampler_);
+  impostor->descriptor->AddCombinedImageSampler(
+      1, impostor->normal_depth_image->image_views_[0], default_linear_sampler_);
+  impostor->descriptor->Bake();
+  return impostor;
+}
+
+Ref<Impostor> Renderer::GetOrCreateImpostor(const Model& model) {
+  if (model.model_path.empty()) {
+    return CreateImpostor(model);
+  }
+  auto it = impostor_cache_.find(model.model_path);
+  if (it != impostor_cache_.end()) {
+    return it->second;
+  }
+  Ref<Impostor> impostor = CreateImpostor(model);
+  if (impostor) {
+    impostor_cache_.insert({model.model_path, impostor});
+  }
+  return impostor;
+}
+
 Ref<DescriptorSet> Renderer::CreateGlobalDescriptors(CameraComponent& camera) {
   Ref<DescriptorSet> object = CreateReference<DescriptorSet>();
 
   VkDescriptorPoolSize poolSizes[] = {
       {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 3},
-      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1}};
+      {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1},
+      {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3}};
 
   VkDescriptorPoolCreateInfo poolInfo{};
   poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -1285,15 +1812,15 @@ Ref<DescriptorSet> Renderer::CreateGlobalDescriptors(CameraComponent& camera) {
                                                  &object->descriptor_set_));
 
   std::vector<VkWriteDescriptorSet> writes;
-  writes.reserve(4);
+  writes.reserve(7);
   std::vector<VkDescriptorBufferInfo> bufferInfos;
-  bufferInfos.reserve(3);
+  bufferInfos.reserve(6);
   std::vector<VkDescriptorImageInfo> imageInfos;
   imageInfos.reserve(1);
 
   {
     VkDescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = lights_uniform_buffer_->buffer_handle_;
+    bufferInfo.buffer = camera.resources->lights_uniform_buffer->buffer_handle_;
     bufferInfo.offset = 0;
     bufferInfo.range = sizeof(LightsUniformData);
     bufferInfos.emplace_back(bufferInfo);
@@ -1313,7 +1840,7 @@ Ref<DescriptorSet> Renderer::CreateGlobalDescriptors(CameraComponent& camera) {
 
   {
     VkDescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = camera_uniform_buffer_->buffer_handle_;
+    bufferInfo.buffer = camera.resources->camera_uniform_buffer->buffer_handle_;
     bufferInfo.offset = 0;
     bufferInfo.range = sizeof(CameraUniformData);
     bufferInfos.emplace_back(bufferInfo);
@@ -1333,7 +1860,8 @@ Ref<DescriptorSet> Renderer::CreateGlobalDescriptors(CameraComponent& camera) {
 
   {
     VkDescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = shadow_camera_uniform_buffer_->buffer_handle_;
+    bufferInfo.buffer =
+        camera.resources->shadow_camera_uniform_buffer->buffer_handle_;
     bufferInfo.offset = 0;
     bufferInfo.range = sizeof(ShadowMapMatricesUniformData);
     bufferInfos.emplace_back(bufferInfo);
@@ -1352,15 +1880,11 @@ Ref<DescriptorSet> Renderer::CreateGlobalDescriptors(CameraComponent& camera) {
   }
 
   {
+    // Starts out blank, SetCameraData binds the map the camera samples
     VkDescriptorImageInfo imageInfo;
     imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-    if (camera.shadow_depth_view_array == nullptr) {
-      imageInfo.imageView = blank_texture_->image_view_->handle_;
-      imageInfo.sampler = blank_texture_->sampler_;
-    } else {
-      imageInfo.imageView = camera.shadow_depth_view_array->handle_;
-      imageInfo.sampler = default_linear_sampler_->sampler_;
-    }
+    imageInfo.imageView = blank_shadow_view_->handle_;
+    imageInfo.sampler = shadow_compare_sampler_->sampler_;
     imageInfos.emplace_back(imageInfo);
 
     VkWriteDescriptorSet set{};
@@ -1375,6 +1899,30 @@ Ref<DescriptorSet> Renderer::CreateGlobalDescriptors(CameraComponent& camera) {
     writes.emplace_back(set);
   }
 
+  std::array<Ref<StorageBuffer>, 3> storageBuffers{
+      camera.resources->point_lights_storage_buffer,
+      camera.resources->light_clusters_storage_buffer,
+      camera.resources->light_indices_storage_buffer};
+  for (uint32_t i = 0; i < storageBuffers.size(); i++) {
+    VkDescriptorBufferInfo bufferInfo;
+    bufferInfo.buffer = storageBuffers[i]->buffer_handle_;
+    bufferInfo.offset = 0;
+    bufferInfo.range = storageBuffers[i]->size_;
+    bufferInfos.emplace_back(bufferInfo);
+
+    VkWriteDescriptorSet set{};
+    set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    set.dstSet = object->descriptor_set_;
+    set.dstBinding = 4 + i;
+    set.dstArrayElement = 0;
+    set.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    set.descriptorCount = 1;
+    set.pBufferInfo = &bufferInfos[bufferInfos.size() - 1];
+    set.pNext = nullptr;
+
+    writes.emplace_back(set);
+  }
+
   vkUpdateDescriptorSets(logical_device_, static_cast<uint32_t>(writes.size()),
                          writes.data(), 0, nullptr);
 
@@ -1415,7 +1963,8 @@ Ref<DescriptorSet> Renderer::CreateShadowGlobalDescriptors(
 
   {
     VkDescriptorBufferInfo bufferInfo;
-    bufferInfo.buffer = shadow_camera_uniform_buffer_->buffer_handle_;
+    bufferInfo.buffer =
+        camera.resources->shadow_camera_uniform_buffer->buffer_handle_;
     bufferInfo.offset = 0;
     bufferInfo.range = sizeof(ShadowMapMatricesUniformData);
     bufferInfos.emplace_back(bufferInfo);
@@ -1574,6 +2123,15 @@ VkSampleCountFlagBits Renderer::GetMsaaSamples() {
   return msaa_samples_;
 }
 
+void Renderer::SetAntiAliasing(AntiAliasing value) {
+  if (value == anti_aliasing_) {
+    return;
+  }
+  anti_aliasing_ = value;
+  // Composite reads a different image
+  InvalidateStaticPasses();
+}
+
 void Renderer::SetVsync(bool vsync) {
   if (vsync == enable_vsync_) {
     return;
@@ -1592,17 +2150,22 @@ void Renderer::Cleanup() {
 
   vkDeviceWaitIdle(logical_device_);
   LOG_DEBUG("Destroying Renderer");
+  shader_reloader_ = nullptr;
 
   camera_ = nullptr;
   quad_index_buffer_ = nullptr;
   quad_vertex_buffer_ = nullptr;
 
   CleanupGlobalUniformBuffers();
+  impostor_cache_.clear();
   blank_texture_ = nullptr;
+  blank_shadow_view_ = nullptr;
+  blank_shadow_map_ = nullptr;
 
   LOG_DEBUG("Destroying graphics");
   CleanupGeometryGraphics();
   CleanupPresentGraphics();
+  DestroyRetiredResources(true);
 
   LOG_DEBUG("Destroying descriptor set layout");
   CleanupDescriptorLayouts();
@@ -1611,8 +2174,19 @@ void Renderer::Cleanup() {
   vkDestroySemaphore(logical_device_, render_finished_semaphore_, nullptr);
   vkDestroySemaphore(logical_device_, image_available_semaphore_, nullptr);
   vkDestroyFence(logical_device_, fence_, nullptr);
+  if (graphics_timeline_semaphore_ != VK_NULL_HANDLE) {
+    vkDestroySemaphore(logical_device_, graphics_timeline_semaphore_, nullptr);
+    vkDestroySemaphore(logical_device_, compute_timeline_semaphore_, nullptr);
+  }
+  if (timestamp_query_pool_ != VK_NULL_HANDLE) {
+    vkDestroyQueryPool(logical_device_, timestamp_query_pool_, nullptr);
+  }
 
   LOG_DEBUG("Destroying command pool");
+  hiz_acquire_images_.clear();
+  compute_command_buffers_.clear();
+  compute_command_pool_ = nullptr;
+  frame_command_buffers_.clear();
   command_buffer_ = nullptr;
   command_pool_ = nullptr;
 
@@ -1647,7 +2221,18 @@ void Renderer::CreateVulkanInstance() {
   appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
   appInfo.pEngineName = "No Engine";
   appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-  appInfo.apiVersion = VK_API_VERSION_1_0;
+  // 1.2 for timeline semaphores, when the loader has it. A 1.0 loader does
+  // not export vkEnumerateInstanceVersion and rejects anything above 1.0.
+  instance_api_version_ = VK_API_VERSION_1_0;
+  auto enumerateInstanceVersion =
+      reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+          vkGetInstanceProcAddr(nullptr, "vkEnumerateInstanceVersion"));
+  if (enumerateInstanceVersion != nullptr) {
+    WIESEL_CHECK_VKRESULT(enumerateInstanceVersion(&instance_api_version_));
+  }
+  instance_api_version_ =
+      std::min<uint32_t>(instance_api_version_, VK_API_VERSION_1_2);
+  appInfo.apiVersion = instance_api_version_;
 
   VkInstanceCreateInfo createInfo{};
   createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
@@ -1713,9 +2298,6 @@ void Renderer::PickPhysicalDevice() {
     vkGetPhysicalDeviceFeatures(physical_device_, &physical_device_features_);
     msaa_samples_ = GetMaxUsableSampleCount();
     previous_msaa_samples_ = msaa_samples_;
-    if (physical_device_features_.shaderImageGatherExtended) {
-      shader_features_.push_back("USE_GATHER");
-    }
   } else {
     throw std::runtime_error("failed to find a suitable GPU!");
   }
@@ -1725,17 +2307,39 @@ void Renderer::CreateLogicalDevice() {
   LOG_DEBUG("Creating logical device");
   queue_family_indices_ = FindQueueFamilies(physical_device_);
 
+  VkPhysicalDeviceTimelineSemaphoreFeatures timelineFeatures{};
+  timelineFeatures.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES;
+  if (instance_api_version_ >= VK_API_VERSION_1_2 &&
+      physical_device_properties_.apiVersion >= VK_API_VERSION_1_2) {
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &timelineFeatures;
+    vkGetPhysicalDeviceFeatures2(physical_device_, &features);
+  }
+  if (!timelineFeatures.timelineSemaphore) {
+    queue_family_indices_.computeFamily.reset();
+  }
+  if (!queue_family_indices_.computeFamily.has_value()) {
+    LOG_INFO("No async compute queue, Hi-Z will be built on the graphics queue");
+  }
+
   std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-  std::set<uint32_t> uniqueQueueFamilies = {GetGraphicsQueueFamilyIndex(),
-                                            GetPresentQueueFamilyIndex()};
+  // Family index to how many queues we use from it
+  std::map<uint32_t, uint32_t> queueCounts = {{GetGraphicsQueueFamilyIndex(), 1},
+                                              {GetPresentQueueFamilyIndex(), 1}};
+  if (queue_family_indices_.computeFamily.has_value()) {
+    uint32_t& count = queueCounts[*queue_family_indices_.computeFamily];
+    count = std::max(count, queue_family_indices_.computeQueueIndex + 1);
+  }
 
-  float queuePriority = 1.0f;
-  for (uint32_t queueFamily : uniqueQueueFamilies) {
+  std::array<float, 2> queuePriorities{1.0f, 1.0f};
+  for (const auto& [queueFamily, queueCount] : queueCounts) {
     VkDeviceQueueCreateInfo queueCreateInfo{};
     queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
     queueCreateInfo.queueFamilyIndex = queueFamily;
-    queueCreateInfo.queueCount = 1;
-    queueCreateInfo.pQueuePriorities = &queuePriority;
+    queueCreateInfo.queueCount = queueCount;
+    queueCreateInfo.pQueuePriorities = queuePriorities.data();
     queueCreateInfos.push_back(queueCreateInfo);
   }
 
@@ -1753,6 +2357,9 @@ void Renderer::CreateLogicalDevice() {
       static_cast<uint32_t>(device_extensions_.size());
   createInfo.ppEnabledExtensionNames = device_extensions_.data();
   createInfo.enabledLayerCount = 0;
+  if (timelineFeatures.timelineSemaphore) {
+    createInfo.pNext = &timelineFeatures;
+  }
 
   if (vkCreateDevice(physical_device_, &createInfo, nullptr,
                      &logical_device_) != VK_SUCCESS) {
@@ -1763,6 +2370,13 @@ void Renderer::CreateLogicalDevice() {
                    &present_queue_);
   vkGetDeviceQueue(logical_device_, GetGraphicsQueueFamilyIndex(), 0,
                    &graphics_queue_);
+  if (queue_family_indices_.computeFamily.has_value()) {
+    vkGetDeviceQueue(logical_device_, *queue_family_indices_.computeFamily,
+                     queue_family_indices_.computeQueueIndex, &compute_queue_);
+    LOG_INFO("Using queue {} of family {} for async compute",
+             queue_family_indices_.computeQueueIndex,
+             *queue_family_indices_.computeFamily);
+  }
 }
 
 void Renderer::CreateDescriptorLayouts() {
@@ -1802,6 +2416,13 @@ void Renderer::CreateDescriptorLayouts() {
       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
   global_descriptor_layout_->AddBinding(
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
+  // Point lights, light clusters and light indices
+  global_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
+  global_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
+  global_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT);
   global_descriptor_layout_->Bake();
 
   present_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
@@ -1809,6 +2430,13 @@ void Renderer::CreateDescriptorLayouts() {
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
   present_descriptor_layout_->Bake();
 
+  hiz_compute_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
+  hiz_compute_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT);
+  hiz_compute_descriptor_layout_->AddBinding(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+                                             VK_SHADER_STAGE_COMPUTE_BIT);
+  hiz_compute_descriptor_layout_->Bake();
+
   skybox_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
   skybox_descriptor_layout_->AddBinding(
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -1841,6 +2469,26 @@ void Renderer::CreateDescriptorLayouts() {
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerDepth
   ssao_blur_descriptor_layout_->Bake();
 
+  ssao_temporal_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
+  ssao_temporal_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerSSAO
+  ssao_temporal_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerHistory
+  ssao_temporal_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerWorldPos
+  ssao_temporal_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerDepth
+  ssao_temporal_descriptor_layout_->Bake();
+
+  taa_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
+  taa_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerColor
+  taa_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerHistory
+  taa_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // samplerDepth
+  taa_descriptor_layout_->Bake();
+
   geometry_output_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
   geometry_output_descriptor_layout_->AddBinding(
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
@@ -1856,15 +2504,35 @@ void Renderer::CreateDescriptorLayouts() {
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
   geometry_output_descriptor_layout_->Bake();
 
+  geometry_input_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
+  geometry_input_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT); // inputViewPos
+  geometry_input_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT); // inputWorldPos
+  geometry_input_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT); // inputNormal
+  geometry_input_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT); // inputAlbedo
+  geometry_input_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, VK_SHADER_STAGE_FRAGMENT_BIT); // inputMaterial
+  geometry_input_descriptor_layout_->Bake();
+
   sprite_draw_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
   sprite_draw_descriptor_layout_->AddBinding(
       VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT);
   sprite_draw_descriptor_layout_->AddBinding(
       VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT);
   sprite_draw_descriptor_layout_->Bake();
+
+  impostor_descriptor_layout_ = CreateReference<DescriptorSetLayout>();
+  impostor_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // albedoAtlas
+  impostor_descriptor_layout_->AddBinding(
+      VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT); // normalDepthAtlas
+  impostor_descriptor_layout_->Bake();
 }
 
-void Renderer::CreateSwapChain() {
+void Renderer::CreateSwapChain(VkSwapchainKHR old_swap_chain) {
   LOG_DEBUG("Creating swap chain");
   swap_chain_details_ = QuerySwapChainSupport(physical_device_);
 
@@ -1914,7 +2582,8 @@ void Renderer::CreateSwapChain() {
   createInfo.presentMode = presentMode;
   // If it's clipped, obscured pixels will be ignored hence increasing the performance.
   createInfo.clipped = VK_TRUE;
-  createInfo.oldSwapchain = VK_NULL_HANDLE;
+  // Lets the driver reuse resources of the swap chain being replaced
+  createInfo.oldSwapchain = old_swap_chain;
 
   if (vkCreateSwapchainKHR(logical_device_, &createInfo, nullptr,
                            &swap_chain_) != VK_SUCCESS) {
@@ -1941,14 +2610,8 @@ void Renderer::CreateSwapChain() {
   texture->type_ = AttachmentTextureType::SwapChain;
   texture->is_allocated_ = true;
   texture->msaa_samples_ = msaa_samples_;
+  // No initial transition, the present pass starts from an undefined layout
   for (VkImage& image : swapChainImages) {
-    TransitionImageLayout(image, swap_chain_image_format_,
-                          VK_IMAGE_LAYOUT_UNDEFINED,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-
-    TransitionImageLayout(image, swap_chain_image_format_,
-                          VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                          VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 1);
     texture->images_.push_back(image);
     texture->image_views_.push_back(CreateImageView(
         image, swap_chain_image_format_, VK_IMAGE_ASPECT_COLOR_BIT, 1));
@@ -1965,11 +2628,14 @@ void Renderer::CreateSwapChain() {
        static_cast<uint32_t>(swapChainImages.size()), swap_chain_image_format_,
        msaa_samples_});
 
-  present_render_pass_ = CreateReference<RenderPass>(PassType::Present);
-  present_render_pass_->AttachOutput(present_color_image_);
-  present_render_pass_->AttachOutput(present_depth_stencil_);
-  present_render_pass_->AttachOutput(swap_chain_texture_);
-  present_render_pass_->Bake();
+  // Kept on resize, only the attachment format and samples matter for it
+  if (!present_render_pass_) {
+    present_render_pass_ = CreateReference<RenderPass>(PassType::Present);
+    present_render_pass_->AttachOutput(present_color_image_);
+    present_render_pass_->AttachOutput(present_depth_stencil_);
+    present_render_pass_->AttachOutput(swap_chain_texture_);
+    present_render_pass_->Bake();
+  }
   present_framebuffers_.resize(swapChainImages.size());
   std::array<AttachmentTexture*, 3> textures{present_color_image_.get(),
                                              present_depth_stencil_.get(),
@@ -1983,6 +2649,17 @@ void Renderer::CreateSwapChain() {
 void Renderer::CreateGeometryRenderPass() {
   LOG_DEBUG("Creating render pass");
 
+#ifdef ID_BUFFER_PASS
+  id_render_pass_ = CreateReference<RenderPass>(PassType::Geometry);
+  id_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
+                                 .format = VK_FORMAT_R32_UINT,
+                                 .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  id_render_pass_->AttachOutput({.type = AttachmentTextureType::DepthStencil,
+                                 .format = FindDepthFormat(),
+                                 .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  id_render_pass_->Bake();
+#endif
+
   geometry_render_pass_ = CreateReference<RenderPass>(PassType::Geometry);
   geometry_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
                                       .format = VK_FORMAT_R32G32B32A32_SFLOAT,
@@ -2039,6 +2716,59 @@ void Renderer::CreateGeometryRenderPass() {
   }
   lighting_render_pass_->Bake();
 
+  if (msaa_samples_ == VK_SAMPLE_COUNT_1_BIT) {
+    // Same g-buffer as the geometry pass, only linear depth (for Hi-Z) and
+    // the lighting output are written back to memory
+    geometry_lighting_render_pass_ =
+        CreateReference<RenderPass>(PassType::GeometryLighting);
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT,
+         .transient = true,
+         .input = true});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT,
+         .transient = true,
+         .input = true});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = VK_FORMAT_R32_SFLOAT,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = VK_FORMAT_R8G8B8A8_UNORM,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT,
+         .transient = true,
+         .input = true});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = VK_FORMAT_R8G8B8A8_UNORM,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT,
+         .transient = true,
+         .input = true});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = VK_FORMAT_R16G16B16A16_SFLOAT,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT,
+         .transient = true,
+         .input = true});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::DepthStencil,
+         .format = FindDepthFormat(),
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT,
+         .transient = true});
+    geometry_lighting_render_pass_->AttachOutput(
+        {.type = AttachmentTextureType::Offscreen,
+         .format = swap_chain_image_format_,
+         .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+    geometry_lighting_render_pass_->Bake();
+  } else {
+    geometry_lighting_render_pass_ = nullptr;
+  }
+
   composite_render_pass_ = CreateReference<RenderPass>(PassType::PostProcess);
   composite_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
                                        .format = swap_chain_image_format_,
@@ -2056,6 +2786,18 @@ void Renderer::CreateGeometryRenderPass() {
                                     .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
   sprite_render_pass_->Bake();
 
+  anti_aliasing_render_pass_ = CreateReference<RenderPass>(PassType::PostProcess);
+  anti_aliasing_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
+                                            .format = swap_chain_image_format_,
+                                            .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  anti_aliasing_render_pass_->Bake();
+
+  hiz_render_pass_ = CreateReference<RenderPass>(PassType::PostProcess);
+  hiz_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
+                                  .format = VK_FORMAT_R32_SFLOAT,
+                                  .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  hiz_render_pass_->Bake();
+
   ssao_gen_render_pass_ = CreateReference<RenderPass>(PassType::PostProcess);
   ssao_gen_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
                                      .format = VK_FORMAT_R8_UNORM,
@@ -2074,11 +2816,30 @@ void Renderer::CreateGeometryRenderPass() {
                                       .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
   ssao_blur_vert_render_pass_->Bake();
 
+  ssao_temporal_render_pass_ = CreateReference<RenderPass>(PassType::PostProcess);
+  ssao_temporal_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
+                                            .format = VK_FORMAT_R16G16_SFLOAT,
+                                            .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  ssao_temporal_render_pass_->Bake();
+
   shadow_render_pass_ = CreateReference<RenderPass>(PassType::Shadow);
   shadow_render_pass_->AttachOutput({.type = AttachmentTextureType::DepthStencil,
                                     .format = FindDepthFormat(),
                                     .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
   shadow_render_pass_->Bake();
+
+  impostor_bake_render_pass_ = CreateReference<RenderPass>(PassType::Geometry);
+  impostor_bake_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
+                                            .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                            .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  impostor_bake_render_pass_->AttachOutput({.type = AttachmentTextureType::Offscreen,
+                                            .format = VK_FORMAT_R8G8B8A8_UNORM,
+                                            .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  impostor_bake_render_pass_->AttachOutput(
+      {.type = AttachmentTextureType::DepthStencil,
+       .format = FindDepthFormat(),
+       .msaa_samples = VK_SAMPLE_COUNT_1_BIT});
+  impostor_bake_render_pass_->Bake();
 }
 
 void Renderer::CreateGeometryGraphicsPipelines() {
@@ -2091,15 +2852,71 @@ void Renderer::CreateGeometryGraphicsPipelines() {
                     ShaderSourceSource, "assets/internal_shaders/geometry_shader.frag"});
   geometry_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
       msaa_samples_, CullModeBack, enable_wireframe_, false});
-  geometry_pipeline_->SetVertexData(Vertex3D::GetBindingDescription(),
-                                    Vertex3D::GetAttributeDescriptions());
+  geometry_pipeline_->SetVertexData(PackedVertex3D::GetBindingDescription(),
+                                    PackedVertex3D::GetAttributeDescriptions());
   geometry_pipeline_->SetRenderPass(geometry_render_pass_);
   geometry_pipeline_->AddInputLayout(geometry_mesh_descriptor_layout_);
   geometry_pipeline_->AddInputLayout(global_descriptor_layout_);
+  geometry_pipeline_->AddPushConstant(geometry_pipeline_push_constant_,
+                                      VK_SHADER_STAGE_FRAGMENT_BIT);
   geometry_pipeline_->AddShader(geometryVertexShader);
   geometry_pipeline_->AddShader(geometryFragmentShader);
   geometry_pipeline_->Bake();
 
+#ifdef ID_BUFFER_PASS
+  auto idFragmentShader =
+      CreateShader({ShaderTypeFragment, ShaderLangGLSL, "main",
+                    ShaderSourceSource, "assets/internal_shaders/id_shader.frag"});
+  id_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      VK_SAMPLE_COUNT_1_BIT, CullModeBack, false, false});
+  id_pipeline_->SetVertexData(PackedVertex3D::GetBindingDescription(),
+                              PackedVertex3D::GetAttributeDescriptions());
+  id_pipeline_->SetRenderPass(id_render_pass_);
+  id_pipeline_->AddInputLayout(geometry_mesh_descriptor_layout_);
+  id_pipeline_->AddInputLayout(global_descriptor_layout_);
+  id_pipeline_->AddPushConstant(id_pipeline_push_constant_,
+                                VK_SHADER_STAGE_FRAGMENT_BIT);
+  id_pipeline_->AddShader(geometryVertexShader);
+  id_pipeline_->AddShader(idFragmentShader);
+  id_pipeline_->Bake();
+#endif
+
+  auto impostorVertexShader =
+      CreateShader({ShaderTypeVertex, ShaderLangGLSL, "main",
+                    ShaderSourceSource, "assets/internal_shaders/impostor_shader.vert"});
+  auto impostorFragmentShader =
+      CreateShader({ShaderTypeFragment, ShaderLangGLSL, "main",
+                    ShaderSourceSource, "assets/internal_shaders/impostor_shader.frag"});
+  impostor_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      msaa_samples_, CullModeNone, enable_wireframe_, false});
+  impostor_pipeline_->SetVertexData(ImpostorInstance::GetBindingDescription(),
+                                    ImpostorInstance::GetAttributeDescriptions());
+  impostor_pipeline_->SetRenderPass(geometry_render_pass_);
+  impostor_pipeline_->AddInputLayout(impostor_descriptor_layout_);
+  impostor_pipeline_->AddInputLayout(global_descriptor_layout_);
+  impostor_pipeline_->AddShader(impostorVertexShader);
+  impostor_pipeline_->AddShader(impostorFragmentShader);
+  impostor_pipeline_->Bake();
+
+  auto impostorBakeVertexShader = CreateShader(
+      {ShaderTypeVertex, ShaderLangGLSL, "main", ShaderSourceSource,
+       "assets/internal_shaders/impostor_bake_shader.vert"});
+  auto impostorBakeFragmentShader = CreateShader(
+      {ShaderTypeFragment, ShaderLangGLSL, "main", ShaderSourceSource,
+       "assets/internal_shaders/impostor_bake_shader.frag"});
+  impostor_bake_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      VK_SAMPLE_COUNT_1_BIT, CullModeBack, false, false});
+  impostor_bake_pipeline_->SetVertexData(PackedVertex3D::GetBindingDescription(),
+                                         PackedVertex3D::GetAttributeDescriptions());
+  impostor_bake_pipeline_->SetRenderPass(impostor_bake_render_pass_);
+  impostor_bake_pipeline_->AddPushConstant(
+      impostor_bake_push_constant_,
+      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
+  impostor_bake_pipeline_->AddInputLayout(geometry_mesh_descriptor_layout_);
+  impostor_bake_pipeline_->AddShader(impostorBakeVertexShader);
+  impostor_bake_pipeline_->AddShader(impostorBakeFragmentShader);
+  impostor_bake_pipeline_->Bake();
+
   auto skyboxVertexShader =
       CreateShader({ShaderTypeVertex, ShaderLangGLSL, "main",
                     ShaderSourceSource, "assets/internal_shaders/skybox_shader.vert"});
@@ -2133,6 +2950,63 @@ void Renderer::CreateGeometryGraphicsPipelines() {
   lighting_pipeline_->AddShader(lightingFragmentShader);
   lighting_pipeline_->Bake();
 
+  if (geometry_lighting_render_pass_) {
+    fused_geometry_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+        VK_SAMPLE_COUNT_1_BIT, CullModeBack, enable_wireframe_, false});
+    fused_geometry_pipeline_->SetVertexData(PackedVertex3D::GetBindingDescription(),
+                                            PackedVertex3D::GetAttributeDescriptions());
+    fused_geometry_pipeline_->SetRenderPass(geometry_lighting_render_pass_, 0);
+    fused_geometry_pipeline_->AddInputLayout(geometry_mesh_descriptor_layout_);
+    fused_geometry_pipeline_->AddInputLayout(global_descriptor_layout_);
+    // Same push constant as geometry_pipeline_ so DrawMesh can use either
+    fused_geometry_pipeline_->AddPushConstant(geometry_pipeline_push_constant_,
+                                              VK_SHADER_STAGE_FRAGMENT_BIT);
+    fused_geometry_pipeline_->AddShader(geometryVertexShader);
+    fused_geometry_pipeline_->AddShader(geometryFragmentShader);
+    fused_geometry_pipeline_->Bake();
+
+    fused_impostor_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+        VK_SAMPLE_COUNT_1_BIT, CullModeNone, enable_wireframe_, false});
+    fused_impostor_pipeline_->SetVertexData(
+        ImpostorInstance::GetBindingDescription(),
+        ImpostorInstance::GetAttributeDescriptions());
+    fused_impostor_pipeline_->SetRenderPass(geometry_lighting_render_pass_, 0);
+    fused_impostor_pipeline_->AddInputLayout(impostor_descriptor_layout_);
+    fused_impostor_pipeline_->AddInputLayout(global_descriptor_layout_);
+    fused_impostor_pipeline_->AddShader(impostorVertexShader);
+    fused_impostor_pipeline_->AddShader(impostorFragmentShader);
+    fused_impostor_pipeline_->Bake();
+
+    fused_skybox_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+        VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, true, false});
+    fused_skybox_pipeline_->SetRenderPass(geometry_lighting_render_pass_, 1);
+    fused_skybox_pipeline_->AddInputLayout(skybox_descriptor_layout_);
+    fused_skybox_pipeline_->AddInputLayout(global_descriptor_layout_);
+    fused_skybox_pipeline_->AddShader(skyboxVertexShader);
+    fused_skybox_pipeline_->AddShader(skyboxFragmentShader);
+    fused_skybox_pipeline_->Bake();
+
+    auto lightingInputFragmentShader = CreateShader(
+        {ShaderTypeFragment, ShaderLangGLSL, "main", ShaderSourceSource,
+         "assets/internal_shaders/lighting_shader.frag", {"INPUT_ATTACHMENTS"}});
+
+    fused_lighting_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+        VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, true, true, false});
+    fused_lighting_pipeline_->SetRenderPass(geometry_lighting_render_pass_, 1);
+    fused_lighting_pipeline_->AddInputLayout(geometry_input_descriptor_layout_);
+    fused_lighting_pipeline_->AddInputLayout(ssao_output_descriptor_layout_);
+    fused_lighting_pipeline_->AddInputLayout(global_descriptor_layout_);
+    fused_lighting_pipeline_->AddInputLayout(skybox_descriptor_layout_);
+    fused_lighting_pipeline_->AddShader(fullscreenVertexShader);
+    fused_lighting_pipeline_->AddShader(lightingInputFragmentShader);
+    fused_lighting_pipeline_->Bake();
+  } else {
+    fused_geometry_pipeline_ = nullptr;
+    fused_impostor_pipeline_ = nullptr;
+    fused_skybox_pipeline_ = nullptr;
+    fused_lighting_pipeline_ = nullptr;
+  }
+
   auto shadowVertexShader =
       CreateShader({ShaderTypeVertex, ShaderLangGLSL, "main",
                     ShaderSourceSource, "assets/internal_shaders/shadow_shader.vert"});
@@ -2142,16 +3016,40 @@ void Renderer::CreateGeometryGraphicsPipelines() {
   shadow_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
       VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, true, true});
   shadow_pipeline_->SetRenderPass(shadow_render_pass_);
-  shadow_pipeline_->SetVertexData(Vertex3D::GetBindingDescription(),
-                                  Vertex3D::GetAttributeDescriptions());
-  shadow_pipeline_->AddPushConstant(shadow_pipeline_push_constant_,
-                                    VK_SHADER_STAGE_VERTEX_BIT);
+  shadow_pipeline_->SetVertexData(ShadowVertex3D::GetBindingDescription(),
+                                  ShadowVertex3D::GetAttributeDescriptions());
+  shadow_pipeline_->AddPushConstant(
+      shadow_pipeline_push_constant_,
+      VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
   shadow_pipeline_->AddInputLayout(shadow_mesh_descriptor_layout_);
   shadow_pipeline_->AddInputLayout(global_shadow_descriptor_layout_);
   shadow_pipeline_->AddShader(shadowVertexShader);
   shadow_pipeline_->AddShader(shadowFragmentShader);
   shadow_pipeline_->Bake();
 
+  auto hizFragmentShader =
+      CreateShader({ShaderTypeFragment, ShaderLangGLSL, "main",
+                    ShaderSourceSource, "assets/internal_shaders/hiz_shader.frag"});
+
+  hiz_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, false, false});
+  hiz_pipeline_->SetRenderPass(hiz_render_pass_);
+  hiz_pipeline_->AddInputLayout(present_descriptor_layout_);
+  hiz_pipeline_->AddShader(fullscreenVertexShader);
+  hiz_pipeline_->AddShader(hizFragmentShader);
+  hiz_pipeline_->Bake();
+
+  if (compute_queue_ != VK_NULL_HANDLE) {
+    auto hizComputeShader =
+        CreateShader({ShaderTypeCompute, ShaderLangGLSL, "main",
+                      ShaderSourceSource, "assets/internal_shaders/hiz_shader.comp"});
+    hiz_compute_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+        VK_SAMPLE_COUNT_1_BIT, CullModeNone, false, false, false, false});
+    hiz_compute_pipeline_->AddInputLayout(hiz_compute_descriptor_layout_);
+    hiz_compute_pipeline_->AddShader(hizComputeShader);
+    hiz_compute_pipeline_->Bake();
+  }
+
   auto ssaoFragmentShader =
       CreateShader({ShaderTypeFragment, ShaderLangGLSL, "main",
                     ShaderSourceSource, "assets/internal_shaders/ssao_gen_shader.frag"});
@@ -2173,6 +3071,7 @@ void Renderer::CreateGeometryGraphicsPipelines() {
       VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, false, false});
   ssao_blur_horz_pipeline_->SetRenderPass(ssao_blur_horz_render_pass_);
   ssao_blur_horz_pipeline_->AddInputLayout(ssao_blur_descriptor_layout_);
+  ssao_blur_horz_pipeline_->AddInputLayout(global_descriptor_layout_);
   ssao_blur_horz_pipeline_->AddShader(fullscreenVertexShader);
   ssao_blur_horz_pipeline_->AddShader(ssaoBlurHorzFragmentShader);
   ssao_blur_horz_pipeline_->Bake();
@@ -2185,10 +3084,50 @@ void Renderer::CreateGeometryGraphicsPipelines() {
       VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, false, false});
   ssao_blur_vert_pipeline_->SetRenderPass(ssao_blur_vert_render_pass_);
   ssao_blur_vert_pipeline_->AddInputLayout(ssao_blur_descriptor_layout_);
+  ssao_blur_vert_pipeline_->AddInputLayout(global_descriptor_layout_);
   ssao_blur_vert_pipeline_->AddShader(fullscreenVertexShader);
   ssao_blur_vert_pipeline_->AddShader(ssaoBlurVertFragmentShader);
   ssao_blur_vert_pipeline_->Bake();
 
+  auto ssaoTemporalFragmentShader = CreateShader(
+      {ShaderTypeFragment, ShaderLangGLSL, "main", ShaderSourceSource,
+       "assets/internal_shaders/ssao_temporal_shader.frag"});
+
+  ssao_temporal_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, false, false});
+  ssao_temporal_pipeline_->SetRenderPass(ssao_temporal_render_pass_);
+  ssao_temporal_pipeline_->AddInputLayout(ssao_temporal_descriptor_layout_);
+  ssao_temporal_pipeline_->AddInputLayout(global_descriptor_layout_);
+  ssao_temporal_pipeline_->AddShader(fullscreenVertexShader);
+  ssao_temporal_pipeline_->AddShader(ssaoTemporalFragmentShader);
+  ssao_temporal_pipeline_->Bake();
+
+  auto fxaaFragmentShader = CreateShader(
+      {ShaderTypeFragment, ShaderLangGLSL, "main", ShaderSourceSource,
+       "assets/internal_shaders/fxaa_shader.frag"});
+
+  fxaa_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, false, false});
+  fxaa_pipeline_->SetRenderPass(anti_aliasing_render_pass_);
+  fxaa_pipeline_->AddInputLayout(present_descriptor_layout_);
+  fxaa_pipeline_->AddInputLayout(global_descriptor_layout_);
+  fxaa_pipeline_->AddShader(fullscreenVertexShader);
+  fxaa_pipeline_->AddShader(fxaaFragmentShader);
+  fxaa_pipeline_->Bake();
+
+  auto taaFragmentShader = CreateShader(
+      {ShaderTypeFragment, ShaderLangGLSL, "main", ShaderSourceSource,
+       "assets/internal_shaders/taa_shader.frag"});
+
+  taa_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      VK_SAMPLE_COUNT_1_BIT, CullModeFront, false, false, false, false});
+  taa_pipeline_->SetRenderPass(anti_aliasing_render_pass_);
+  taa_pipeline_->AddInputLayout(taa_descriptor_layout_);
+  taa_pipeline_->AddInputLayout(global_descriptor_layout_);
+  taa_pipeline_->AddShader(fullscreenVertexShader);
+  taa_pipeline_->AddShader(taaFragmentShader);
+  taa_pipeline_->Bake();
+
   auto spriteVertexShader =
       CreateShader({ShaderTypeVertex, ShaderLangGLSL, "main",
                     ShaderSourceSource, "assets/internal_shaders/sprite_shader.vert"});
@@ -2209,12 +3148,15 @@ void Renderer::CreateGeometryGraphicsPipelines() {
 
   auto compositeFragmentShader =
       CreateShader({ShaderTypeFragment, ShaderLangGLSL, "main",
-                    ShaderSourceSource, "assets/internal_shaders/quad_shader.frag"});
+                    ShaderSourceSource, "assets/internal_shaders/quad_shader.frag",
+                    {"RENDER_SCALE"}});
 
   composite_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
       msaa_samples_, CullModeFront, false, true, true, false});
   composite_pipeline_->SetRenderPass(composite_render_pass_);
   composite_pipeline_->AddInputLayout(skybox_descriptor_layout_);
+  composite_pipeline_->AddPushConstant(composite_pipeline_push_constant_,
+                                       VK_SHADER_STAGE_FRAGMENT_BIT);
   composite_pipeline_->AddShader(fullscreenVertexShader);
   composite_pipeline_->AddShader(compositeFragmentShader);
   composite_pipeline_->Bake();
@@ -2234,6 +3176,22 @@ void Renderer::CreatePresentGraphicsPipelines() {
   present_pipeline_->AddShader(presentVertexShader);
   present_pipeline_->AddShader(presentFragmentShader);
   present_pipeline_->Bake();
+
+  auto compositeFragmentShader =
+      CreateShader({ShaderTypeFragment, ShaderLangGLSL, "main",
+                    ShaderSourceSource, "assets/internal_shaders/quad_shader.frag",
+                    {"RENDER_SCALE"}});
+  // Same as composite_pipeline_ but draws into the swapchain image, both
+  // layers are blended so depth is ignored
+  present_composite_pipeline_ = CreateReference<Pipeline>(PipelineProperties{
+      msaa_samples_, CullModeNone, false, true, false, false});
+  present_composite_pipeline_->SetRenderPass(present_render_pass_);
+  present_composite_pipeline_->AddInputLayout(present_descriptor_layout_);
+  present_composite_pipeline_->AddPushConstant(composite_pipeline_push_constant_,
+                                               VK_SHADER_STAGE_FRAGMENT_BIT);
+  present_composite_pipeline_->AddShader(presentVertexShader);
+  present_composite_pipeline_->AddShader(compositeFragmentShader);
+  present_composite_pipeline_->Bake();
 }
 
 void Renderer::RecreatePipeline(Ref<Pipeline> pipeline) {
@@ -2241,10 +3199,33 @@ void Renderer::RecreatePipeline(Ref<Pipeline> pipeline) {
 }
 
 Ref<Shader> Renderer::CreateShader(ShaderProperties properties) {
-  for (const auto& item : shader_features_) {
-    properties.defines.push_back(item);
+  std::string reloadedPath =
+      shader_reloader_ ? shader_reloader_->GetReloadedPath(properties.path)
+                       : "";
+  if (properties.source == ShaderSourceSource && !reloadedPath.empty()) {
+    // The library has the version from before the edit
+    properties.path = reloadedPath;
+  } else if (properties.source == ShaderSourceSource &&
+             shader_library_->Contains(properties.path, properties.defines)) {
+    properties.source = ShaderSourceLibrary;
+  } else if (properties.source == ShaderSourceSource) {
+    bool warn = shader_library_->IsLoaded();
+#ifdef DEBUG
+    // Internal shaders should never miss, permutations.txt is out of date
+    warn |= properties.path.starts_with("assets/internal_shaders/");
+#endif
+    if (warn) {
+      LOG_WARN("Shader {} is not in the shader library, compiling it",
+               ShaderLibrary::MakeKey(properties.path, properties.defines));
+    }
   }
-  return CreateReference<Shader>(properties);
+  Ref<Shader> shader = CreateReference<Shader>(properties);
+  std::erase_if(shaders_, [](const auto& item) { return item.expired(); });
+  shaders_.push_back(shader);
+  if (shader_reloader_) {
+    shader_reloader_->Track(shader);
+  }
+  return shader;
 }
 
 void Renderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
@@ -2471,11 +3452,67 @@ void Renderer::TransitionImageLayout(VkImage image, VkFormat format,
 }
 
 void Renderer::CreateCommandPools() {
-  command_pool_ = CreateReference<CommandPool>();
+  command_pool_ = CreateReference<CommandPool>(GetGraphicsQueueFamilyIndex());
+  if (compute_queue_ != VK_NULL_HANDLE) {
+    compute_command_pool_ =
+        CreateReference<CommandPool>(*queue_family_indices_.computeFamily);
+  }
 }
 
 void Renderer::CreateCommandBuffers() {
-  command_buffer_ = command_pool_->CreateBuffer();
+  frame_command_buffers_.push_back(command_pool_->CreateBuffer());
+  command_buffer_ = frame_command_buffers_[0];
+}
+
+void Renderer::CreateBlankShadowMap() {
+  blank_shadow_map_ = CreateAttachmentTexture(
+      {1, 1, AttachmentTextureType::DepthStencil, 1, FindDepthFormat(),
+       VK_SAMPLE_COUNT_1_BIT, true, WIESEL_SHADOW_CASCADE_COUNT, true});
+  blank_shadow_view_ = CreateImageView(
+      blank_shadow_map_, VK_IMAGE_VIEW_TYPE_2D_ARRAY, 0,
+      WIESEL_SHADOW_CASCADE_COUNT);
+
+  // Cleared to the far plane so every compare passes, left in the layout
+  // the lighting pass samples it in
+  VkImageSubresourceRange range{};
+  range.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+  if (HasStencilComponent(blank_shadow_map_->format_)) {
+    range.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+  }
+  range.baseMipLevel = 0;
+  range.levelCount = 1;
+  range.baseArrayLayer = 0;
+  range.layerCount = WIESEL_SHADOW_CASCADE_COUNT;
+
+  VkImageMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.image = blank_shadow_map_->images_[0];
+  barrier.subresourceRange = range;
+
+  VkCommandBuffer commandBuffer = BeginSingleTimeCommands();
+  barrier.oldLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.srcAccessMask = 0;
+  barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0,
+                       nullptr, 1, &barrier);
+
+  VkClearDepthStencilValue clearValue{1.0f, 0};
+  vkCmdClearDepthStencilImage(commandBuffer, barrier.image,
+                              VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                              &clearValue, 1, &range);
+
+  barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+  barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+  vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0,
+                       nullptr, 1, &barrier);
+  EndSingleTimeCommands(commandBuffer);
 }
 
 void Renderer::CreatePermanentResources() {
@@ -2498,6 +3535,13 @@ void Renderer::CreatePermanentResources() {
   default_linear_sampler_ = CreateReference<Sampler>(1, SamplerProps{});
   default_nearest_sampler_ = CreateReference<Sampler>(
       1, SamplerProps{VK_FILTER_NEAREST, VK_FILTER_NEAREST, -1.0f});
+  // Outside of the shadow map counts as lit
+  shadow_compare_sampler_ = CreateReference<Sampler>(
+      1, SamplerProps{VK_FILTER_LINEAR, VK_FILTER_LINEAR, -1.0f,
+                      VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER,
+                      VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE, true,
+                      VK_COMPARE_OP_LESS_OR_EQUAL});
+  CreateBlankShadowMap();
 
   // SSAO
   ssao_kernel_uniform_buffer_ =
@@ -2572,6 +3616,11 @@ void Renderer::CreateImage(uint32_t width, uint32_t height, uint32_t mipLevels,
 
   VkMemoryRequirements memRequirements;
   vkGetImageMemoryRequirements(logical_device_, image, &memRequirements);
+  // Usually only tiled gpus have lazily allocated memory
+  if ((properties & VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT) &&
+      !HasMemoryType(memRequirements.memoryTypeBits, properties)) {
+    properties &= ~VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT;
+  }
 
   VkMemoryAllocateInfo allocInfo{};
   allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
@@ -2783,59 +3832,203 @@ void Renderer::CreateSyncObjects() {
                                           nullptr, &render_finished_semaphore_));
   WIESEL_CHECK_VKRESULT(
       vkCreateFence(logical_device_, &fenceInfo, nullptr, &fence_));
+
+  if (compute_queue_ != VK_NULL_HANDLE) {
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+    VkSemaphoreCreateInfo timelineSemaphoreInfo{};
+    timelineSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    timelineSemaphoreInfo.pNext = &timelineInfo;
+    WIESEL_CHECK_VKRESULT(vkCreateSemaphore(logical_device_, &timelineSemaphoreInfo,
+                                            nullptr, &graphics_timeline_semaphore_));
+    WIESEL_CHECK_VKRESULT(vkCreateSemaphore(logical_device_, &timelineSemaphoreInfo,
+                                            nullptr, &compute_timeline_semaphore_));
+  }
+}
+
+void Renderer::CreateTimestampQueries() {
+  if (!physical_device_properties_.limits.timestampComputeAndGraphics) {
+    LOG_WARN("Timestamp queries are not supported, dynamic resolution is disabled!");
+    enable_dynamic_resolution_ = false;
+    return;
+  }
+  uint32_t queueFamilyCount = 0;
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &queueFamilyCount,
+                                           nullptr);
+  std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+  vkGetPhysicalDeviceQueueFamilyProperties(physical_device_, &queueFamilyCount,
+                                           queueFamilies.data());
+  uint32_t validBits =
+      queueFamilies[GetGraphicsQueueFamilyIndex()].timestampValidBits;
+  if (validBits == 0) {
+    LOG_WARN("Graphics queue has no timestamp support, dynamic resolution is disabled!");
+    enable_dynamic_resolution_ = false;
+    return;
+  }
+  timestamp_valid_mask_ =
+      validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+  VkQueryPoolCreateInfo queryPoolInfo{};
+  queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+  queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+  queryPoolInfo.queryCount = 2;
+  WIESEL_CHECK_VKRESULT(vkCreateQueryPool(logical_device_, &queryPoolInfo,
+                                          nullptr, &timestamp_query_pool_));
+}
+
+void Renderer::ReadTimestampQueries() {
+  PROFILE_ZONE_SCOPED();
+  if (timestamp_query_pool_ == VK_NULL_HANDLE) {
+    return;
+  }
+  // Frame fence was already waited, so these never block
+  uint64_t timestamps[2];
+  VkResult result = vkGetQueryPoolResults(
+      logical_device_, timestamp_query_pool_, 0, 2, sizeof(timestamps),
+      timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+  if (result != VK_SUCCESS) {
+    return;
+  }
+  // Only the low timestampValidBits are written, masking the difference also
+  // handles the counter wrapping around between the two queries
+  uint64_t ticks = ((timestamps[1] & timestamp_valid_mask_) -
+                    (timestamps[0] & timestamp_valid_mask_)) &
+                   timestamp_valid_mask_;
+  gpu_frame_time_ms_ = static_cast<float>(ticks) *
+                       physical_device_properties_.limits.timestampPeriod /
+                       1000000.0f;
+  if (enable_dynamic_resolution_) {
+    resolution_scale_controller_.Update(gpu_frame_time_ms_);
+  } else {
+    resolution_scale_controller_.Reset();
+  }
 }
 
 void Renderer::CleanupDescriptorLayouts() {
   geometry_mesh_descriptor_layout_ = nullptr;
   present_descriptor_layout_ = nullptr;
+  hiz_compute_descriptor_layout_ = nullptr;
 }
 
 void Renderer::CleanupGeometryGraphics() {
+#ifdef ID_BUFFER_PASS
+  id_pipeline_ = nullptr;
+  id_render_pass_ = nullptr;
+#endif
   geometry_pipeline_ = nullptr;
+  fused_geometry_pipeline_ = nullptr;
+  impostor_pipeline_ = nullptr;
+  fused_impostor_pipeline_ = nullptr;
+  impostor_bake_pipeline_ = nullptr;
+  impostor_bake_render_pass_ = nullptr;
+  fused_skybox_pipeline_ = nullptr;
+  fused_lighting_pipeline_ = nullptr;
+  hiz_compute_pipeline_ = nullptr;
   geometry_render_pass_ = nullptr;
+  geometry_lighting_render_pass_ = nullptr;
 }
 
 void Renderer::CleanupPresentGraphics() {
   present_pipeline_ = nullptr;
+  present_composite_pipeline_ = nullptr;
   present_color_image_ = nullptr;
   present_depth_stencil_ = nullptr;
   swap_chain_texture_ = nullptr;
   present_render_pass_ = nullptr;
   present_framebuffers_.clear();
-  present_framebuffers_.clear();
   vkDestroySwapchainKHR(logical_device_, swap_chain_, nullptr);
+  swap_chain_ = VK_NULL_HANDLE;
+}
+
+void Renderer::DestroyRetiredResources(bool force) {
+  PROFILE_ZONE_SCOPED();
+  destroying_retired_ = true;
+  std::erase_if(retired_swap_chains_, [&](RetiredSwapChain& retired) {
+    if (!force &&
+        frame_index_ < retired.retired_frame + WIESEL_SWAP_CHAIN_RETIRE_FRAMES) {
+      return false;
+    }
+    retired.framebuffers.clear();
+    retired.texture = nullptr;
+    retired.color_image = nullptr;
+    retired.depth_stencil = nullptr;
+    vkDestroySwapchainKHR(logical_device_, retired.swap_chain, nullptr);
+    return true;
+  });
+  // Whatever the live resources still share is kept alive by them
+  std::erase_if(retired_camera_resources_,
+                [&](const RetiredCameraResources& retired) {
+                  return force || frame_index_ >= retired.retired_frame +
+                                                      WIESEL_SWAP_CHAIN_RETIRE_FRAMES;
+                });
+  destroying_retired_ = false;
 }
 
 void Renderer::CreateGlobalUniformBuffers() {
-  lights_uniform_buffer_ = CreateUniformBuffer(sizeof(LightsUniformData));
-  camera_uniform_buffer_ = CreateUniformBuffer(sizeof(CameraUniformData));
-  shadow_camera_uniform_buffer_ =
-      CreateUniformBuffer(sizeof(ShadowMapMatricesUniformData));
+  impostor_instance_buffer_ =
+      CreateStorageBuffer(sizeof(ImpostorInstance) * WIESEL_MAX_IMPOSTOR_INSTANCES,
+                          VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+  queued_impostors_.reserve(WIESEL_MAX_IMPOSTOR_INSTANCES);
+#ifdef ID_BUFFER_PASS
+  pick_readback_buffer_ = CreateReadbackBuffer(
+      sizeof(uint32_t) * WIESEL_PICK_REGION_SIZE * WIESEL_PICK_REGION_SIZE);
+#endif
+  point_lights_.reserve(WIESEL_MAX_POINT_LIGHTS);
+  visible_point_lights_.reserve(WIESEL_MAX_POINT_LIGHTS);
 }
 
 void Renderer::CleanupGlobalUniformBuffers() {
-  lights_uniform_buffer_ = nullptr;
-  camera_uniform_buffer_ = nullptr;
+  impostor_instance_buffer_ = nullptr;
+#ifdef ID_BUFFER_PASS
+  pick_readback_buffer_ = nullptr;
+#endif
 }
 
 void Renderer::RecreateSwapChain() {
   PROFILE_ZONE_SCOPED();
-  LOG_INFO("Recreating swap chains...");
   WindowSize size{};
   window_->GetWindowFramebufferSize(size);
-  while (size.width == 0 || size.height == 0) {
-    window_->GetWindowFramebufferSize(size);
-    window_->OnUpdate();
+  if (size.width == 0 || size.height == 0) {
+    // Minimized, try again once the window has a size
+    recreate_swap_chain_ = true;
+    return;
   }
+  LOG_INFO("Recreating swap chains...");
 
-  vkDeviceWaitIdle(logical_device_);
+  // Render passes and pipelines only depend on the format and samples, a
+  // plain resize keeps them and doesn't have to wait for the device.
+  VkSurfaceFormatKHR surfaceFormat = ChooseSwapSurfaceFormat(
+      QuerySwapChainSupport(physical_device_).formats);
+  bool rebuildPipelines = surfaceFormat.format != swap_chain_image_format_ ||
+                          present_color_image_->msaa_samples_ != msaa_samples_;
+
+  // The old swap chain stays alive while frames that used it may still be
+  // in flight or queued for presentation, see DestroyRetiredResources.
+  RetiredSwapChain retired{};
+  retired.swap_chain = swap_chain_;
+  retired.texture = std::move(swap_chain_texture_);
+  retired.color_image = std::move(present_color_image_);
+  retired.depth_stencil = std::move(present_depth_stencil_);
+  retired.framebuffers = std::move(present_framebuffers_);
+  retired.retired_frame = frame_index_;
+  present_framebuffers_.clear();
+  retired_swap_chains_.push_back(std::move(retired));
 
-  CleanupPresentGraphics();
-  CleanupGeometryGraphics();
-  CreateSwapChain();
-  CreatePresentGraphicsPipelines();
-  CreateGeometryRenderPass();
-  CreateGeometryGraphicsPipelines();
+  if (rebuildPipelines) {
+    vkDeviceWaitIdle(logical_device_);
+    present_pipeline_ = nullptr;
+    present_composite_pipeline_ = nullptr;
+    present_render_pass_ = nullptr;
+    CleanupGeometryGraphics();
+  }
+  CreateSwapChain(retired_swap_chains_.back().swap_chain);
+  if (rebuildPipelines) {
+    CreatePresentGraphicsPipelines();
+    CreateGeometryRenderPass();
+    CreateGeometryGraphicsPipelines();
+    InvalidateStaticPasses();
+  }
 }
 
 void Renderer::SetViewport(VkExtent2D extent) {
@@ -2873,11 +4066,76 @@ void Renderer::SetViewport(glm::vec2 extent) {
   vkCmdSetScissor(command_buffer_->handle_, 0, 1, &scissor);
 }
 
+VkExtent2D Renderer::GetRenderExtent(uint32_t divisor) const {
+  return VkExtent2D{
+      std::max(static_cast<uint32_t>(render_size_.x) / divisor, 1u),
+      std::max(static_cast<uint32_t>(render_size_.y) / divisor, 1u)};
+}
+
+VkExtent2D Renderer::GetHiZExtent() const {
+  VkExtent2D extent = GetRenderExtent();
+  return VkExtent2D{
+      std::min((extent.width + WIESEL_HIZ_DOWNSAMPLE - 1) / WIESEL_HIZ_DOWNSAMPLE,
+               camera_->resources->hiz_image->width_),
+      std::min((extent.height + WIESEL_HIZ_DOWNSAMPLE - 1) / WIESEL_HIZ_DOWNSAMPLE,
+               camera_->resources->hiz_image->height_)};
+}
+
 void Renderer::BeginRender() {
   PROFILE_ZONE_SCOPED();
   vkResetFences(logical_device_, 1, &fence_);
+  frame_index_++;
+  composite_in_present_ = false;
+  impostor_instance_count_ = 0;
+#ifdef ID_BUFFER_PASS
+  if (pick_in_flight_) {
+    // Last frame was never presented so the copy never ran, draw it again
+    pick_in_flight_ = false;
+    pick_requested_ = true;
+  }
+#endif
+  if (compute_timeline_value_ > 0) {
+    // Hi-Z readback of the last frame is read while recording this one
+    PROFILE_ZONE_SCOPED_N("Renderer::BeginRender: Wait for compute");
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &compute_timeline_semaphore_;
+    waitInfo.pValues = &compute_timeline_value_;
+    WIESEL_CHECK_VKRESULT(
+        vkWaitSemaphores(logical_device_, &waitInfo, UINT64_MAX));
+    graphics_wait_compute_value_ = compute_timeline_value_;
+  }
+  compute_command_buffers_.clear();
+  frame_command_buffer_index_ = 0;
+  command_buffer_ = frame_command_buffers_[0];
   command_buffer_->Reset();
   command_buffer_->Begin();
+  for (const auto& image : hiz_acquire_images_) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    barrier.srcQueueFamilyIndex = *queue_family_indices_.computeFamily;
+    barrier.dstQueueFamilyIndex = GetGraphicsQueueFamilyIndex();
+    barrier.image = image->images_[0];
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT |
+                            VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    vkCmdPipelineBarrier(command_buffer_->handle_,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                         VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0, 0,
+                         nullptr, 0, nullptr, 1, &barrier);
+  }
+  hiz_acquire_images_.clear();
+  DestroyRetiredResources(false);
+  if (timestamp_query_pool_ != VK_NULL_HANDLE) {
+    vkCmdResetQueryPool(command_buffer_->handle_, timestamp_query_pool_, 0, 2);
+    vkCmdWriteTimestamp(command_buffer_->handle_,
+                        VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        timestamp_query_pool_, 0);
+  }
   if (previous_msaa_samples_ != msaa_samples_) {
     LOG_INFO("Msaa samples changed to {} from {}!",
              std::to_string(msaa_samples_),
@@ -2888,9 +4146,8 @@ void Renderer::BeginRender() {
   // Reloading stuff
   if (recreate_swap_chain_) {
     PROFILE_ZONE_SCOPED_N("Renderer::BeginRender: Recreate swap chain");
-    RecreateSwapChain();
     recreate_swap_chain_ = false;
-    recreate_pipeline_ = false;
+    RecreateSwapChain();
   }
   if (recreate_pipeline_) {
     PROFILE_ZONE_SCOPED_N("Renderer::BeginRender: Recreate Pipeline");
@@ -2899,7 +4156,35 @@ void Renderer::BeginRender() {
     geometry_pipeline_->properties_.enable_wireframe =
         enable_wireframe_;  // Update wireframe mode
     RecreatePipeline(geometry_pipeline_);
+    if (fused_geometry_pipeline_) {
+      fused_geometry_pipeline_->properties_.enable_wireframe = enable_wireframe_;
+      RecreatePipeline(fused_geometry_pipeline_);
+    }
     recreate_pipeline_ = false;
+    InvalidateStaticPasses();
+  }
+  if (enable_shader_hot_reload_ != (shader_reloader_ != nullptr)) {
+    if (enable_shader_hot_reload_) {
+      shader_reloader_ =
+          CreateReference<ShaderReloader>(WIESEL_SHADER_SOURCE_DIR);
+      for (const auto& item : shaders_) {
+        if (Ref<Shader> shader = item.lock()) {
+          shader_reloader_->Track(shader);
+        }
+      }
+    } else {
+      shader_reloader_ = nullptr;
+    }
+  }
+  if (shader_reloader_ && shader_reloader_->Apply()) {
+    InvalidateStaticPasses();
+  }
+  if (static_pass_ssao_temporal_ != enable_ssao_temporal_ ||
+      static_pass_only_ssao_ != only_ssao_) {
+    // Changes which SSAO output lighting and composite read
+    static_pass_ssao_temporal_ = enable_ssao_temporal_;
+    static_pass_only_ssao_ = only_ssao_;
+    InvalidateStaticPasses();
   }
 }
 
@@ -2929,9 +4214,21 @@ bool Renderer::BeginPresent() {
                           m_CommandBuffer->m_Handle);
   }*/
 
-  if (camera_) {
-    TransitionImageLayout(camera_->composite_color_resolve_image->images_[0],
-                          camera_->composite_color_resolve_image->format_,
+  if (camera_ && composite_in_present_) {
+    TransitionImageLayout(GetSceneColorImage()->images_[0],
+                          GetSceneColorImage()->format_,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+    TransitionImageLayout(camera_->resources->sprite_color_image->images_[0],
+                          camera_->resources->sprite_color_image->format_,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+    composite_pipeline_push_constant_->uv_scale = render_size_ / viewport_size_;
+  } else if (camera_) {
+    TransitionImageLayout(camera_->resources->composite_color_resolve_image->images_[0],
+                          camera_->resources->composite_color_resolve_image->format_,
                           VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                           command_buffer_->handle_, 0, 1);
@@ -2948,9 +4245,20 @@ void Renderer::EndPresent() {
   present_render_pass_->End();
   // This was done here to prevent some errors caused by doing it inside the pass
   // I'm not sure if this is a correct solution, find out and move this to the present image if not required
-  if (camera_) {
-    TransitionImageLayout(camera_->composite_color_resolve_image->images_[0],
-                          camera_->composite_color_resolve_image->format_,
+  if (camera_ && composite_in_present_) {
+    TransitionImageLayout(GetSceneColorImage()->images_[0],
+                          GetSceneColorImage()->format_,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+    TransitionImageLayout(camera_->resources->sprite_color_image->images_[0],
+                          camera_->resources->sprite_color_image->format_,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+  } else if (camera_) {
+    TransitionImageLayout(camera_->resources->composite_color_resolve_image->images_[0],
+                          camera_->resources->composite_color_resolve_image->format_,
                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                           VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                           command_buffer_->handle_, 0, 1);
@@ -2963,6 +4271,11 @@ void Renderer::EndPresent() {
                           m_CommandBuffer->m_Handle);
   }*/
 
+  if (timestamp_query_pool_ != VK_NULL_HANDLE) {
+    vkCmdWriteTimestamp(command_buffer_->handle_,
+                        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        timestamp_query_pool_, 1);
+  }
   command_buffer_->End();
 
   // Presentation
@@ -2971,12 +4284,24 @@ void Renderer::EndPresent() {
   submitInfo.commandBufferCount = 1;
   submitInfo.pCommandBuffers = &command_buffer_->handle_;
 
-  VkSemaphore waitSemaphores[] = {image_available_semaphore_};
+  VkSemaphore waitSemaphores[] = {image_available_semaphore_,
+                                  compute_timeline_semaphore_};
   VkPipelineStageFlags waitStages[] = {
+      VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
       VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-  submitInfo.waitSemaphoreCount = 1;
+  // Value is ignored for the binary semaphore
+  uint64_t waitValues[] = {0, graphics_wait_compute_value_};
+  submitInfo.waitSemaphoreCount = graphics_wait_compute_value_ > 0 ? 2 : 1;
   submitInfo.pWaitSemaphores = waitSemaphores;
   submitInfo.pWaitDstStageMask = waitStages;
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.waitSemaphoreValueCount = submitInfo.waitSemaphoreCount;
+  timelineInfo.pWaitSemaphoreValues = waitValues;
+  if (graphics_wait_compute_value_ > 0) {
+    submitInfo.pNext = &timelineInfo;
+    graphics_wait_compute_value_ = 0;
+  }
 
   VkSemaphore signalSemaphores[] = {render_finished_semaphore_};
   submitInfo.signalSemaphoreCount = 1;
@@ -3000,31 +4325,73 @@ void Renderer::EndPresent() {
   presentInfo.pResults = nullptr;  // Optional
 
   VkResult result = vkQueuePresentKHR(present_queue_, &presentInfo);
-  if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-    RecreateSwapChain();
-  } else if (result != VK_SUCCESS) {
+  if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+    // Recreated at the start of the next frame instead of in the middle of
+    // this one. Suboptimal still presents fine, resizes go through the
+    // debounced path in Application.
+    recreate_swap_chain_ = true;
+  } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
     throw std::runtime_error("failed to present swap chain image!");
   }
 
   vkWaitForFences(logical_device_, 1, &fence_, VK_TRUE, UINT64_MAX);
+  ReadTimestampQueries();
+#ifdef ID_BUFFER_PASS
+  ReadPickResult();
+#endif
 }
 
 void Renderer::UpdateUniformData() {
   PROFILE_ZONE_SCOPED();
-  memcpy(lights_uniform_buffer_->data_, &lights_uniform_data_,
-         sizeof(lights_uniform_data_));
-  memcpy(camera_uniform_buffer_->data_, &camera_uniform_data_,
+  // Lights are shared by all cameras but culling and clusters depend on the
+  // camera, so only skip the work if neither of them changed since this
+  // camera's last upload.
+  CameraResources& resources = *camera_->resources;
+  glm::mat4 viewProjection = camera_->projection * camera_->view_matrix;
+  if (resources.uploaded_lights_version != lights_version_ ||
+      resources.uploaded_view_projection != viewProjection) {
+    PROFILE_ZONE_SCOPED_N("Renderer::UpdateUniformData: Lights");
+    visible_point_lights_.clear();
+    for (const auto& light : point_lights_) {
+      if (light.radius <= 0.0f ||
+          !camera_->planes.IntersectsSphere(light.base.position,
+                                            light.radius)) {
+        continue;
+      }
+      visible_point_lights_.push_back(light);
+    }
+    lights_uniform_data_.point_light_count = visible_point_lights_.size();
+    memcpy(resources.lights_uniform_buffer->data_, &lights_uniform_data_,
+           sizeof(lights_uniform_data_));
+    memcpy(resources.point_lights_storage_buffer->data_,
+           visible_point_lights_.data(),
+           sizeof(LightPoint) * visible_point_lights_.size());
+
+    light_cluster_grid_.Build(visible_point_lights_, camera_->view_matrix,
+                              camera_->projection, camera_->near_plane,
+                              camera_->far_plane);
+    const auto& clusters = light_cluster_grid_.GetClusters();
+    const auto& indices = light_cluster_grid_.GetLightIndices();
+    memcpy(resources.light_clusters_storage_buffer->data_, clusters.data(),
+           sizeof(LightCluster) * clusters.size());
+    memcpy(resources.light_indices_storage_buffer->data_, indices.data(),
+           sizeof(uint32_t) * indices.size());
+    resources.uploaded_lights_version = lights_version_;
+    resources.uploaded_view_projection = viewProjection;
+  }
+  memcpy(resources.camera_uniform_buffer->data_, &camera_uniform_data_,
          sizeof(camera_uniform_data_));
 }
 
 void Renderer::BeginShadowPass(uint32_t cascade) {
   PROFILE_ZONE_SCOPED();
-  memcpy(shadow_camera_uniform_buffer_->data_, &shadow_camera_uniform_data_,
+  memcpy(camera_->resources->shadow_camera_uniform_buffer->data_,
+         &shadow_camera_uniform_data_,
          sizeof(shadow_camera_uniform_data_));
   shadow_pipeline_push_constant_->cascade_index = cascade;
 
   shadow_pipeline_->Bind(PipelineBindPointGraphics);
-  shadow_render_pass_->Begin(camera_->shadow_framebuffers[cascade],
+  shadow_render_pass_->Begin(camera_->resources->shadow_framebuffers[cascade],
                             {0, 0, 0, 1});
   SetViewport(glm::vec2{WIESEL_SHADOWMAP_DIM, WIESEL_SHADOWMAP_DIM});
 }
@@ -3037,8 +4404,9 @@ void Renderer::EndShadowPass() {
 void Renderer::BeginGeometryPass() {
   PROFILE_ZONE_SCOPED();
   geometry_pipeline_->Bind(PipelineBindPointGraphics);
-  geometry_render_pass_->Begin(camera_->geometry_framebuffer, {0, 0, 0, 0});
-  SetViewport(viewport_size_);
+  geometry_render_pass_->Begin(camera_->resources->geometry_framebuffer, {0, 0, 0, 0},
+                               GetRenderExtent());
+  SetViewport(GetRenderExtent());
 }
 
 void Renderer::EndGeometryPass() {
@@ -3046,58 +4414,431 @@ void Renderer::EndGeometryPass() {
   geometry_render_pass_->End();
 }
 
+#ifdef ID_BUFFER_PASS
+void Renderer::RequestPick(const CameraResources* camera, glm::vec2 uv) {
+  pick_camera_ = camera;
+  pick_uv_ = glm::clamp(uv, glm::vec2{0.0f}, glm::vec2{1.0f});
+  pick_requested_ = true;
+}
+
+bool Renderer::TakePickResult(uint32_t& id) {
+  if (!pick_ready_) {
+    return false;
+  }
+  pick_ready_ = false;
+  id = pick_result_;
+  return true;
+}
+
+void Renderer::BeginIDPass() {
+  PROFILE_ZONE_SCOPED();
+  id_pipeline_->Bind(PipelineBindPointGraphics);
+  id_render_pass_->Begin(camera_->resources->id_framebuffer, {0, 0, 0, 0});
+  // The camera's viewport is moved so the picked pixel lands in the middle
+  // of the id image, everything outside of the region is clipped away
+  glm::vec2 pixel = glm::min(glm::floor(pick_uv_ * render_size_),
+                             render_size_ - 1.0f);
+  VkViewport viewport{};
+  viewport.x = static_cast<float>(WIESEL_PICK_REGION_SIZE / 2) - pixel.x;
+  viewport.y = static_cast<float>(WIESEL_PICK_REGION_SIZE / 2) - pixel.y;
+  viewport.width = render_size_.x;
+  viewport.height = render_size_.y;
+  viewport.minDepth = 0.0f;
+  viewport.maxDepth = 1.0f;
+  vkCmdSetViewport(command_buffer_->handle_, 0, 1, &viewport);
+
+  VkRect2D scissor{};
+  scissor.offset = {0, 0};
+  scissor.extent = {WIESEL_PICK_REGION_SIZE, WIESEL_PICK_REGION_SIZE};
+  vkCmdSetScissor(command_buffer_->handle_, 0, 1, &scissor);
+}
+
+void Renderer::DrawMeshID(MeshHandle handle, const glm::mat4& transform_matrix,
+                          const glm::mat3& normal_matrix, uint32_t id) {
+  PROFILE_ZONE_SCOPED();
+  const MeshDrawData* mesh = mesh_pool_.Get(handle);
+  if (!mesh) {
+    return;
+  }
+  // Culled meshes weren't drawn by the geometry pass this frame
+  MatricesUniformData matrices{};
+  matrices.ModelMatrix = transform_matrix;
+  matrices.NormalMatrix = normal_matrix;
+  memcpy(mesh->uniform_data, &matrices, sizeof(MatricesUniformData));
+
+  VkBuffer vertexBuffers[] = {mesh->vertex_buffer};
+  VkDeviceSize offsets[] = {0};
+  static_assert(std::size(vertexBuffers) == std::size(offsets));
+  vkCmdBindVertexBuffers(command_buffer_->handle_, 0, std::size(vertexBuffers),
+                         vertexBuffers, offsets);
+  vkCmdBindIndexBuffer(command_buffer_->handle_, mesh->index_buffer, 0,
+                       mesh->index_type);
+
+  VkDescriptorSet sets[2] = {
+      mesh->geometry_descriptor,
+      camera_->resources->global_descriptor->descriptor_set_};
+  vkCmdBindDescriptorSets(command_buffer_->handle_,
+                          VK_PIPELINE_BIND_POINT_GRAPHICS, id_pipeline_->layout_,
+                          0, 2, sets, 0, nullptr);
+
+  id_pipeline_push_constant_->id = id;
+  id_pipeline_push_constant_->material_flags = mesh->material_flags;
+  vkCmdPushConstants(command_buffer_->handle_, id_pipeline_->layout_,
+                     VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                     sizeof(IDPipelinePushConstant),
+                     id_pipeline_push_constant_.get());
+
+  vkCmdDrawIndexed(command_buffer_->handle_, mesh->lods[0].index_count, 1, 0,
+                   0, 0);
+}
+
+void Renderer::EndIDPass() {
+  PROFILE_ZONE_SCOPED();
+  id_render_pass_->End();
+  TransitionImageLayout(camera_->resources->id_image->images_[0],
+                        camera_->resources->id_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  CopyImageToReadback(command_buffer_->handle_, *camera_->resources->id_image,
+                      *pick_readback_buffer_);
+  TransitionImageLayout(camera_->resources->id_image->images_[0],
+                        camera_->resources->id_image->format_,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  pick_requested_ = false;
+  pick_in_flight_ = true;
+  SetViewport(GetRenderExtent());
+}
+
+void Renderer::ReadPickResult() {
+  if (!pick_in_flight_) {
+    return;
+  }
+  // Frame fence was already waited, the copy is done
+  pick_in_flight_ = false;
+  const auto* ids = static_cast<const uint32_t*>(pick_readback_buffer_->data_);
+  // Closest hit to the center so thin objects don't need a pixel perfect click
+  int32_t center = WIESEL_PICK_REGION_SIZE / 2;
+  int32_t closestDistance = std::numeric_limits<int32_t>::max();
+  pick_result_ = 0;
+  for (int32_t y = 0; y < WIESEL_PICK_REGION_SIZE; y++) {
+    for (int32_t x = 0; x < WIESEL_PICK_REGION_SIZE; x++) {
+      uint32_t id = ids[y * WIESEL_PICK_REGION_SIZE + x];
+      int32_t distance = (x - center) * (x - center) + (y - center) * (y - center);
+      if (id != 0 && distance < closestDistance) {
+        closestDistance = distance;
+        pick_result_ = id;
+      }
+    }
+  }
+  pick_ready_ = true;
+}
+#endif
+
+void Renderer::BeginHiZPass() {
+  PROFILE_ZONE_SCOPED();
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  hiz_render_pass_->Begin(camera_->resources->hiz_framebuffer, {0, 0, 0, 0},
+                          GetHiZExtent());
+  SetViewport(GetHiZExtent());
+}
+
+void Renderer::EndHiZPass() {
+  PROFILE_ZONE_SCOPED();
+  hiz_render_pass_->End();
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+
+  // Copy to the readback buffer, it will be read while recording the next frame
+  TransitionImageLayout(camera_->resources->hiz_image->images_[0],
+                        camera_->resources->hiz_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  CopyHiZToReadback(command_buffer_->handle_);
+  TransitionImageLayout(camera_->resources->hiz_image->images_[0],
+                        camera_->resources->hiz_image->format_,
+                        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  // Lighting pass doesn't set the viewport itself
+  SetViewport(GetRenderExtent());
+}
+
+void Renderer::CopyHiZToReadback(VkCommandBuffer command_buffer) {
+  CopyImageToReadback(command_buffer, *camera_->resources->hiz_image,
+                      *camera_->resources->hiz_readback_buffer);
+}
+
+void Renderer::CopyImageToReadback(VkCommandBuffer command_buffer,
+                                   const AttachmentTexture& image,
+                                   const ReadbackBuffer& buffer) {
+  VkBufferImageCopy region{};
+  region.bufferOffset = 0;
+  region.bufferRowLength = 0;
+  region.bufferImageHeight = 0;
+  region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+  region.imageSubresource.mipLevel = 0;
+  region.imageSubresource.baseArrayLayer = 0;
+  region.imageSubresource.layerCount = 1;
+  region.imageOffset = {0, 0, 0};
+  region.imageExtent = {image.width_, image.height_, 1};
+  vkCmdCopyImageToBuffer(command_buffer, image.images_[0],
+                         VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                         buffer.buffer_handle_, 1, &region);
+
+  VkBufferMemoryBarrier barrier{};
+  barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+  barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+  barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  barrier.buffer = buffer.buffer_handle_;
+  barrier.offset = 0;
+  barrier.size = VK_WHOLE_SIZE;
+  vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                       VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier,
+                       0, nullptr);
+}
+
+uint64_t Renderer::SubmitGraphicsCommands() {
+  PROFILE_ZONE_SCOPED();
+  command_buffer_->End();
+  uint64_t signalValue = ++graphics_timeline_value_;
+
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.waitSemaphoreValueCount = graphics_wait_compute_value_ > 0 ? 1 : 0;
+  timelineInfo.pWaitSemaphoreValues = &graphics_wait_compute_value_;
+  timelineInfo.signalSemaphoreValueCount = 1;
+  timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext = &timelineInfo;
+  submitInfo.waitSemaphoreCount = timelineInfo.waitSemaphoreValueCount;
+  submitInfo.pWaitSemaphores = &compute_timeline_semaphore_;
+  submitInfo.pWaitDstStageMask = &waitStage;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &command_buffer_->handle_;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &graphics_timeline_semaphore_;
+  WIESEL_CHECK_VKRESULT(
+      vkQueueSubmit(graphics_queue_, 1, &submitInfo, VK_NULL_HANDLE));
+  graphics_wait_compute_value_ = 0;
+
+  // Continue in the frame's next primary. Its last submit was in an earlier
+  // frame, which the frame fence already waited for.
+  if (++frame_command_buffer_index_ == frame_command_buffers_.size()) {
+    frame_command_buffers_.push_back(command_pool_->CreateBuffer());
+  }
+  command_buffer_ = frame_command_buffers_[frame_command_buffer_index_];
+  command_buffer_->Reset();
+  command_buffer_->Begin();
+  return signalValue;
+}
+
+void Renderer::SubmitHiZCompute() {
+  PROFILE_ZONE_SCOPED();
+  uint32_t graphicsFamily = GetGraphicsQueueFamilyIndex();
+  uint32_t computeFamily = *queue_family_indices_.computeFamily;
+  bool transferOwnership = graphicsFamily != computeFamily;
+  Ref<AttachmentTexture> depthImage = camera_->resources->geometry_depth_resolve_image;
+  Ref<AttachmentTexture> hizImage = camera_->resources->hiz_image;
+  auto imageBarrier = [](VkCommandBuffer commandBuffer, VkImage image,
+                         VkImageLayout oldLayout, VkImageLayout newLayout,
+                         VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+                         VkPipelineStageFlags srcStage,
+                         VkPipelineStageFlags dstStage, uint32_t srcFamily,
+                         uint32_t dstFamily) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = newLayout;
+    barrier.srcQueueFamilyIndex = srcFamily;
+    barrier.dstQueueFamilyIndex = dstFamily;
+    barrier.image = image;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.srcAccessMask = srcAccess;
+    barrier.dstAccessMask = dstAccess;
+    vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0,
+                         nullptr, 1, &barrier);
+  };
+  uint32_t releaseSrc = transferOwnership ? graphicsFamily : VK_QUEUE_FAMILY_IGNORED;
+  uint32_t releaseDst = transferOwnership ? computeFamily : VK_QUEUE_FAMILY_IGNORED;
+
+  // Linear depth isn't touched by graphics again until the next frame's
+  // geometry pass, hand it over to the compute queue
+  imageBarrier(command_buffer_->handle_, depthImage->images_[0],
+               VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+               VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, 0,
+               VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, releaseSrc, releaseDst);
+  uint64_t graphicsValue = SubmitGraphicsCommands();
+
+  Ref<CommandBuffer> computeBuffer = compute_command_pool_->CreateBuffer();
+  compute_command_buffers_.push_back(computeBuffer);
+  computeBuffer->Begin();
+  VkCommandBuffer commandBuffer = computeBuffer->handle_;
+  if (transferOwnership) {
+    imageBarrier(commandBuffer, depthImage->images_[0],
+                 VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                 VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 0,
+                 VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+                 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, graphicsFamily,
+                 computeFamily);
+  }
+  imageBarrier(commandBuffer, hizImage->images_[0], VK_IMAGE_LAYOUT_UNDEFINED,
+               VK_IMAGE_LAYOUT_GENERAL, 0, VK_ACCESS_SHADER_WRITE_BIT,
+               VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_QUEUE_FAMILY_IGNORED,
+               VK_QUEUE_FAMILY_IGNORED);
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                    hiz_compute_pipeline_->pipeline_);
+  vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+                          hiz_compute_pipeline_->layout_, 0, 1,
+                          &camera_->resources->hiz_compute_descriptor->descriptor_set_, 0,
+                          nullptr);
+  // Matches local_size in hiz_shader.comp
+  VkExtent2D extent = GetHiZExtent();
+  vkCmdDispatch(commandBuffer, (extent.width + 7) / 8, (extent.height + 7) / 8, 1);
+
+  imageBarrier(commandBuffer, hizImage->images_[0], VK_IMAGE_LAYOUT_GENERAL,
+               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_SHADER_WRITE_BIT,
+               VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+               VK_PIPELINE_STAGE_TRANSFER_BIT, VK_QUEUE_FAMILY_IGNORED,
+               VK_QUEUE_FAMILY_IGNORED);
+  CopyHiZToReadback(commandBuffer);
+  // Same layout the fragment path leaves it in
+  imageBarrier(commandBuffer, hizImage->images_[0],
+               VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+               VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 0, 0,
+               VK_PIPELINE_STAGE_TRANSFER_BIT,
+               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_QUEUE_FAMILY_IGNORED,
+               VK_QUEUE_FAMILY_IGNORED);
+  // Give the depth back, BeginRender acquires it on the graphics side
+  imageBarrier(commandBuffer, depthImage->images_[0],
+               VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+               VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 0, 0,
+               VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+               VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, releaseDst, releaseSrc);
+  if (transferOwnership) {
+    hiz_acquire_images_.push_back(depthImage);
+  }
+  computeBuffer->End();
+
+  uint64_t signalValue = ++compute_timeline_value_;
+  VkTimelineSemaphoreSubmitInfo timelineInfo{};
+  timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+  timelineInfo.waitSemaphoreValueCount = 1;
+  timelineInfo.pWaitSemaphoreValues = &graphicsValue;
+  timelineInfo.signalSemaphoreValueCount = 1;
+  timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+  VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  VkSubmitInfo submitInfo{};
+  submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+  submitInfo.pNext = &timelineInfo;
+  submitInfo.waitSemaphoreCount = 1;
+  submitInfo.pWaitSemaphores = &graphics_timeline_semaphore_;
+  submitInfo.pWaitDstStageMask = &waitStage;
+  submitInfo.commandBufferCount = 1;
+  submitInfo.pCommandBuffers = &commandBuffer;
+  submitInfo.signalSemaphoreCount = 1;
+  submitInfo.pSignalSemaphores = &compute_timeline_semaphore_;
+  WIESEL_CHECK_VKRESULT(
+      vkQueueSubmit(compute_queue_, 1, &submitInfo, VK_NULL_HANDLE));
+}
+
 void Renderer::DrawModel(ModelComponent& model, const TransformComponent& transform, bool shadowPass) {
   PROFILE_ZONE_SCOPED();
   for (int i = 0; i < model.data.meshes.size(); i++) {
     const auto& mesh = model.data.meshes[i];
-    DrawMesh(mesh, transform, shadowPass);
+    DrawMesh(mesh->handle, transform.transform_matrix, transform.normal_matrix,
+             shadowPass);
   }
 }
 
-void Renderer::DrawMesh(Ref<Mesh> mesh, const TransformComponent& transform, bool shadowPass) {
+void Renderer::DrawMesh(Mesh& mesh, const glm::mat4& transform_matrix,
+                        const glm::mat3& normal_matrix, bool shadowPass,
+                        uint32_t lod) {
+  DrawMesh(mesh.handle, transform_matrix, normal_matrix, shadowPass, lod);
+}
+
+void Renderer::DrawMesh(MeshHandle handle, const glm::mat4& transform_matrix,
+                        const glm::mat3& normal_matrix, bool shadowPass,
+                        uint32_t lod) {
   PROFILE_ZONE_SCOPED();
-  if (!mesh->allocated_) {
+  const MeshDrawData* mesh = mesh_pool_.Get(handle);
+  if (!mesh) {
     return;
   }
-  mesh->UpdateTransform(transform.transform_matrix, transform.normal_matrix);
+  MatricesUniformData matrices{};
+  matrices.ModelMatrix = transform_matrix;
+  matrices.NormalMatrix = normal_matrix;
+  memcpy(mesh->uniform_data, &matrices, sizeof(MatricesUniformData));
 
-  VkBuffer vertexBuffers[] = {mesh->vertex_buffer->buffer_handle_};
+  VkBuffer vertexBuffers[] = {shadowPass ? mesh->shadow_vertex_buffer
+                                         : mesh->vertex_buffer};
   VkDeviceSize offsets[] = {0};
   static_assert(std::size(vertexBuffers) == std::size(offsets));
   vkCmdBindVertexBuffers(command_buffer_->handle_, 0, std::size(vertexBuffers),
                          vertexBuffers, offsets);
-  // Todo get the index type from index buffer instead of hardcoding it.
-  vkCmdBindIndexBuffer(command_buffer_->handle_, mesh->index_buffer->buffer_handle_,
-                       0, mesh->index_buffer->index_type_);
+  vkCmdBindIndexBuffer(command_buffer_->handle_, mesh->index_buffer, 0,
+                       mesh->index_type);
 
   VkPipelineLayout layout =
       shadowPass ? shadow_pipeline_->layout_ : geometry_pipeline_->layout_;
 
   VkDescriptorSet sets[2] = {
-      shadowPass ? mesh->shadow_descriptors->descriptor_set_
-                 : mesh->geometry_descriptors->descriptor_set_,
-      shadowPass ? camera_->shadow_descriptor->descriptor_set_
-                 : camera_->global_descriptor->descriptor_set_};
+      shadowPass ? mesh->shadow_descriptor : mesh->geometry_descriptor,
+      shadowPass ? camera_->resources->shadow_descriptor->descriptor_set_
+                 : camera_->resources->global_descriptor->descriptor_set_};
 
   vkCmdBindDescriptorSets(command_buffer_->handle_,
                           VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 2, sets,
                           0, nullptr);
 
-  vkCmdDrawIndexed(command_buffer_->handle_,
-                   static_cast<uint32_t>(mesh->indices.size()), 1, 0, 0, 0);
+  if (shadowPass) {
+    shadow_pipeline_push_constant_->material_flags = mesh->material_flags;
+    vkCmdPushConstants(command_buffer_->handle_, layout,
+                       VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                       0, sizeof(ShadowPipelinePushConstant),
+                       shadow_pipeline_push_constant_.get());
+  } else {
+    geometry_pipeline_push_constant_->material_flags = mesh->material_flags;
+    vkCmdPushConstants(command_buffer_->handle_, layout,
+                       VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                       sizeof(GeometryPipelinePushConstant),
+                       geometry_pipeline_push_constant_.get());
+  }
+
+  const MeshLodRange& range = mesh->lods[std::min(lod, mesh->lod_count - 1)];
+  vkCmdDrawIndexed(command_buffer_->handle_, range.index_count, 1,
+                   range.first_index, 0, 0);
 }
 
-void Renderer::DrawSprite(SpriteComponent& sprite, const TransformComponent& transform) {
+void Renderer::DrawSprite(SpriteAsset& sprite, uint32_t frame_index,
+                          const glm::mat4& transform_matrix) {
   PROFILE_ZONE_SCOPED();
-  if (!sprite.asset_handle_->is_allocated_) {
+  if (!sprite.is_allocated_) {
     return;
   }
-  sprite.asset_handle_->UpdateTransform(transform.transform_matrix);
+  sprite.UpdateTransform(transform_matrix);
   // TODO: In the feature, we can use instanced sprites for atlas sprites
-  const SpriteAsset::Frame& frame =
-      sprite.asset_handle_->frames_[sprite.current_frame_];
+  const SpriteAsset::Frame& frame = sprite.frames_[frame_index];
 
-  Ref<MemoryBuffer> vertexBuffer = Engine::GetRenderer()->GetQuadVertexBuffer();
   VkBuffer buffers[] = {frame.vertex_buffer->buffer_handle_};
   VkDeviceSize offsets[] = {0};
   static_assert(std::size(buffers) == std::size(offsets));
@@ -3105,7 +4846,7 @@ void Renderer::DrawSprite(SpriteComponent& sprite, const TransformComponent& tra
                          buffers, offsets);
 
   VkDescriptorSet sets[] = {frame.descriptor->descriptor_set_,
-                             camera_->global_descriptor->descriptor_set_};
+                             camera_->resources->global_descriptor->descriptor_set_};
 
   vkCmdBindDescriptorSets(
       command_buffer_->handle_, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -3114,25 +4855,100 @@ void Renderer::DrawSprite(SpriteComponent& sprite, const TransformComponent& tra
   vkCmdDraw(command_buffer_->handle_, 6, 1, 0, 0);
 }
 
+uint32_t Renderer::SelectLod(float screen_size, uint32_t current_lod) const {
+  // Screen size below which level is drawn, level > 0
+  auto switchSize = [this](uint32_t level) {
+    return lod_screen_size_ / static_cast<float>(1u << (level - 1));
+  };
+  uint32_t lod = 0;
+  while (lod + 1 < WIESEL_MAX_MESH_LODS && screen_size < switchSize(lod + 1)) {
+    lod++;
+  }
+  if (lod > current_lod) {
+    while (lod > current_lod &&
+           screen_size >= switchSize(lod) * (1.0f - WIESEL_LOD_HYSTERESIS)) {
+      lod--;
+    }
+  } else if (lod < current_lod) {
+    while (lod < current_lod &&
+           screen_size < switchSize(lod + 1) * (1.0f + WIESEL_LOD_HYSTERESIS)) {
+      lod++;
+    }
+  }
+  return lod;
+}
+
+void Renderer::QueueImpostor(Impostor& impostor,
+                             const glm::mat4& transform_matrix) {
+  queued_impostors_.emplace_back(&impostor, transform_matrix);
+}
+
+void Renderer::DrawImpostors() {
+  PROFILE_ZONE_SCOPED();
+  if (queued_impostors_.empty()) {
+    return;
+  }
+  // Instances sharing an atlas have to be next to each other
+  std::sort(queued_impostors_.begin(), queued_impostors_.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  Ref<Pipeline> pipeline =
+      IsFusedLightingActive() ? fused_impostor_pipeline_ : impostor_pipeline_;
+  pipeline->Bind(PipelineBindPointGraphics);
+  VkBuffer buffers[] = {impostor_instance_buffer_->buffer_handle_};
+  VkDeviceSize offsets[] = {0};
+  static_assert(std::size(buffers) == std::size(offsets));
+  vkCmdBindVertexBuffers(command_buffer_->handle_, 0, std::size(buffers),
+                         buffers, offsets);
+
+  // Anything over WIESEL_MAX_IMPOSTOR_INSTANCES for the frame is dropped
+  auto* instances =
+      static_cast<ImpostorInstance*>(impostor_instance_buffer_->data_);
+  size_t i = 0;
+  while (i < queued_impostors_.size() &&
+         impostor_instance_count_ < WIESEL_MAX_IMPOSTOR_INSTANCES) {
+    Impostor* impostor = queued_impostors_[i].first;
+    uint32_t firstInstance = impostor_instance_count_;
+    for (; i < queued_impostors_.size() &&
+           queued_impostors_[i].first == impostor &&
+           impostor_instance_count_ < WIESEL_MAX_IMPOSTOR_INSTANCES;
+         i++) {
+      instances[impostor_instance_count_++] = {
+          queued_impostors_[i].second,
+          glm::vec4(impostor->center, impostor->radius)};
+    }
+
+    VkDescriptorSet sets[] = {
+        impostor->descriptor->descriptor_set_,
+        camera_->resources->global_descriptor->descriptor_set_};
+    vkCmdBindDescriptorSets(command_buffer_->handle_,
+                            VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout_,
+                            0, std::size(sets), sets, 0, nullptr);
+    vkCmdDraw(command_buffer_->handle_, 6,
+              impostor_instance_count_ - firstInstance, 0, firstInstance);
+  }
+  queued_impostors_.clear();
+}
+
 void Renderer::BeginSSAOGenPass() {
   PROFILE_ZONE_SCOPED();
-  TransitionImageLayout(camera_->geometry_view_pos_resolve_image->images_[0],
-                        camera_->geometry_view_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_view_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_view_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_world_pos_resolve_image->images_[0],
-                        camera_->geometry_world_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_world_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_world_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_depth_resolve_image->images_[0],
-                        camera_->geometry_depth_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_normal_resolve_image->images_[0],
-                        camera_->geometry_normal_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_normal_resolve_image->images_[0],
+                        camera_->resources->geometry_normal_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
@@ -3140,29 +4956,29 @@ void Renderer::BeginSSAOGenPass() {
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  ssao_gen_render_pass_->Begin(camera_->ssao_gen_framebuffer, {0, 0, 0, 0});
-  SetViewport(glm::vec2{viewport_size_.x / 2, viewport_size_.y / 2});
+  BeginStaticPass(ssao_gen_render_pass_, camera_->resources->ssao_gen_framebuffer,
+                  {0, 0, 0, 0}, GetRenderExtent(2), GetRenderExtent(2));
 }
 
 void Renderer::EndSSAOGenPass() {
   ssao_gen_render_pass_->End();
-  TransitionImageLayout(camera_->geometry_view_pos_resolve_image->images_[0],
-                        camera_->geometry_view_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_view_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_view_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_world_pos_resolve_image->images_[0],
-                        camera_->geometry_world_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_world_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_world_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_depth_resolve_image->images_[0],
-                        camera_->geometry_depth_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_normal_resolve_image->images_[0],
-                        camera_->geometry_normal_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_normal_resolve_image->images_[0],
+                        camera_->resources->geometry_normal_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
@@ -3173,149 +4989,324 @@ void Renderer::EndSSAOGenPass() {
 }
 
 void Renderer::BeginSSAOBlurHorzPass() {
-  TransitionImageLayout(camera_->ssao_color_image->images_[0],
-                        camera_->ssao_color_image->format_,
+  TransitionImageLayout(camera_->resources->ssao_color_image->images_[0],
+                        camera_->resources->ssao_color_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_depth_resolve_image->images_[0],
-                        camera_->geometry_depth_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  ssao_blur_horz_render_pass_->Begin(camera_->ssao_blur_horz_framebuffer, {0, 0, 0, 0});
-  SetViewport(viewport_size_);
+  BeginStaticPass(ssao_blur_horz_render_pass_,
+                  camera_->resources->ssao_blur_horz_framebuffer, {0, 0, 0, 0},
+                  GetRenderExtent(), GetRenderExtent());
 }
 
 void Renderer::EndSSAOBlurHorzPass() {
   ssao_blur_horz_render_pass_->End();
-  TransitionImageLayout(camera_->ssao_color_image->images_[0],
-                        camera_->ssao_color_image->format_,
+  TransitionImageLayout(camera_->resources->ssao_color_image->images_[0],
+                        camera_->resources->ssao_color_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_depth_resolve_image->images_[0],
-                        camera_->geometry_depth_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
 }
 
 void Renderer::BeginSSAOBlurVertPass() {
-  TransitionImageLayout(camera_->ssao_blur_horz_color_image->images_[0],
-                        camera_->ssao_blur_horz_color_image->format_,
+  TransitionImageLayout(camera_->resources->ssao_blur_horz_color_image->images_[0],
+                        camera_->resources->ssao_blur_horz_color_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_depth_resolve_image->images_[0],
-                        camera_->geometry_depth_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  ssao_blur_vert_render_pass_->Begin(camera_->ssao_blur_vert_framebuffer, {0, 0, 0, 0});
-  SetViewport(viewport_size_);
+  ssao_blur_vert_render_pass_->Begin(camera_->resources->ssao_blur_vert_framebuffer, {0, 0, 0, 0},
+                                     GetRenderExtent());
+  SetViewport(GetRenderExtent());
 }
 
 void Renderer::EndSSAOBlurVertPass() {
   ssao_blur_vert_render_pass_->End();
-  TransitionImageLayout(camera_->ssao_blur_horz_color_image->images_[0],
-                        camera_->ssao_blur_horz_color_image->format_,
+  TransitionImageLayout(camera_->resources->ssao_blur_horz_color_image->images_[0],
+                        camera_->resources->ssao_blur_horz_color_image->format_,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+}
+
+void Renderer::BeginSSAOTemporalPass() {
+  PROFILE_ZONE_SCOPED();
+  const auto& history = camera_->resources->ssao_history_images[
+      (camera_->resources->ssao_history_index + 1) % camera_->resources->ssao_history_images.size()];
+  TransitionImageLayout(camera_->resources->ssao_color_image->images_[0],
+                        camera_->resources->ssao_color_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(history->images_[0], history->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(camera_->resources->geometry_world_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_world_pos_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  BeginStaticPass(
+      ssao_temporal_render_pass_,
+      camera_->resources->ssao_history_framebuffers[camera_->resources->ssao_history_index],
+      {0, 0, 0, 0}, GetRenderExtent(2), GetRenderExtent(2));
+}
+
+void Renderer::EndSSAOTemporalPass() {
+  ssao_temporal_render_pass_->End();
+  const auto& history = camera_->resources->ssao_history_images[
+      (camera_->resources->ssao_history_index + 1) % camera_->resources->ssao_history_images.size()];
+  TransitionImageLayout(camera_->resources->ssao_color_image->images_[0],
+                        camera_->resources->ssao_color_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_depth_resolve_image->images_[0],
-                        camera_->geometry_depth_resolve_image->format_,
+  TransitionImageLayout(history->images_[0], history->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(camera_->resources->geometry_world_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_world_pos_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionImageLayout(camera_->resources->geometry_depth_resolve_image->images_[0],
+                        camera_->resources->geometry_depth_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  SetViewport(GetRenderExtent());
+}
+
+Ref<AttachmentTexture> Renderer::GetSSAOResultImage() {
+  if (enable_ssao_temporal_) {
+    return camera_->resources->ssao_history_images[camera_->resources->ssao_history_index];
+  }
+  return camera_->resources->ssao_blur_vert_color_image;
+}
+
+Ref<DescriptorSet> Renderer::GetSSAOResultDescriptor() {
+  if (enable_ssao_temporal_) {
+    return camera_->resources->ssao_history_output_descriptors[camera_->resources->ssao_history_index];
+  }
+  return camera_->resources->ssao_blur_vert_output_descriptor;
 }
 
 void Renderer::BeginLightingPass() {
-  TransitionImageLayout(camera_->geometry_view_pos_resolve_image->images_[0],
-                        camera_->geometry_view_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_view_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_view_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_world_pos_resolve_image->images_[0],
-                        camera_->geometry_world_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_world_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_world_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_normal_resolve_image->images_[0],
-                        camera_->geometry_normal_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_normal_resolve_image->images_[0],
+                        camera_->resources->geometry_normal_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_albedo_resolve_image->images_[0],
-                        camera_->geometry_albedo_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_albedo_resolve_image->images_[0],
+                        camera_->resources->geometry_albedo_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_material_resolve_image->images_[0],
-                        camera_->geometry_material_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_material_resolve_image->images_[0],
+                        camera_->resources->geometry_material_resolve_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->ssao_blur_vert_color_image->images_[0],
-                        camera_->ssao_blur_vert_color_image->format_,
+  Ref<AttachmentTexture> ssaoImage = GetSSAOResultImage();
+  TransitionImageLayout(ssaoImage->images_[0], ssaoImage->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  if (camera_->shadow_depth_stencil) {
-    TransitionImageLayout(camera_->shadow_depth_stencil->images_[0],
-                          camera_->shadow_depth_stencil->format_,
-                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
-                          command_buffer_->handle_, 0,
-                          WIESEL_SHADOW_CASCADE_COUNT);
-  }
-  lighting_render_pass_->Begin(camera_->lighting_framebuffer, clear_color_);
+  TransitionBoundShadowMap(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  BeginStaticPass(lighting_render_pass_, camera_->resources->lighting_framebuffer,
+                  clear_color_, GetRenderExtent(), GetRenderExtent());
 }
 
 void Renderer::EndLightingPass() {
   lighting_render_pass_->End();
-  TransitionImageLayout(camera_->geometry_view_pos_resolve_image->images_[0],
-                        camera_->geometry_view_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_view_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_view_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_world_pos_resolve_image->images_[0],
-                        camera_->geometry_world_pos_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_world_pos_resolve_image->images_[0],
+                        camera_->resources->geometry_world_pos_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_normal_resolve_image->images_[0],
-                        camera_->geometry_normal_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_normal_resolve_image->images_[0],
+                        camera_->resources->geometry_normal_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_albedo_resolve_image->images_[0],
-                        camera_->geometry_albedo_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_albedo_resolve_image->images_[0],
+                        camera_->resources->geometry_albedo_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->geometry_material_resolve_image->images_[0],
-                        camera_->geometry_material_resolve_image->format_,
+  TransitionImageLayout(camera_->resources->geometry_material_resolve_image->images_[0],
+                        camera_->resources->geometry_material_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->ssao_blur_vert_color_image->images_[0],
-                        camera_->ssao_blur_vert_color_image->format_,
+  Ref<AttachmentTexture> ssaoImage = GetSSAOResultImage();
+  TransitionImageLayout(ssaoImage->images_[0], ssaoImage->format_,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  TransitionBoundShadowMap(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+}
+
+void Renderer::TransitionBoundShadowMap(VkImageLayout old_layout,
+                                        VkImageLayout new_layout) {
+  // The map binding 3 samples, another camera's when sharing. The blank one
+  // never leaves VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+  const Ref<AttachmentTexture>& image = camera_->resources->bound_shadow_image;
+  if (!image || image == blank_shadow_map_) {
+    return;
+  }
+  TransitionImageLayout(image->images_[0], image->format_, old_layout,
+                        new_layout, 1, command_buffer_->handle_, 0,
+                        WIESEL_SHADOW_CASCADE_COUNT);
+}
+
+void Renderer::BeginGeometryLightingPass() {
+  PROFILE_ZONE_SCOPED();
+  TransitionBoundShadowMap(VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  fused_geometry_pipeline_->Bind(PipelineBindPointGraphics);
+  // G-buffer clears to zero so lighting discards the empty pixels
+  std::vector<Colorf> clearColors(
+      geometry_lighting_render_pass_->GetColorAttachmentCount(0),
+      Colorf{0, 0, 0, 0});
+  clearColors.push_back(clear_color_);
+  geometry_lighting_render_pass_->Begin(camera_->resources->geometry_lighting_framebuffer,
+                                        clearColors, GetRenderExtent());
+  SetViewport(GetRenderExtent());
+}
+
+void Renderer::NextLightingSubpass() {
+  PROFILE_ZONE_SCOPED();
+  geometry_lighting_render_pass_->NextSubpass();
+}
+
+void Renderer::EndGeometryLightingPass() {
+  PROFILE_ZONE_SCOPED();
+  geometry_lighting_render_pass_->End();
+  TransitionBoundShadowMap(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+}
+
+void Renderer::BeginAntiAliasingPass() {
+  PROFILE_ZONE_SCOPED();
+  CameraResources& resources = *camera_->resources;
+  TransitionImageLayout(resources.lighting_color_resolve_image->images_[0],
+                        resources.lighting_color_resolve_image->format_,
+                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                        command_buffer_->handle_, 0, 1);
+  if (anti_aliasing_ == AntiAliasing::TAA) {
+    const auto& history = resources.taa_history_images[
+        (resources.taa_history_index + 1) % resources.taa_history_images.size()];
+    TransitionImageLayout(history->images_[0], history->format_,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+    TransitionImageLayout(resources.geometry_depth_resolve_image->images_[0],
+                          resources.geometry_depth_resolve_image->format_,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+    BeginStaticPass(anti_aliasing_render_pass_,
+                    resources.taa_history_framebuffers[resources.taa_history_index],
+                    {0, 0, 0, 0}, GetRenderExtent(), GetRenderExtent());
+  } else {
+    BeginStaticPass(anti_aliasing_render_pass_, resources.fxaa_framebuffer,
+                    {0, 0, 0, 0}, GetRenderExtent(), GetRenderExtent());
+  }
+}
+
+void Renderer::EndAntiAliasingPass() {
+  anti_aliasing_render_pass_->End();
+  CameraResources& resources = *camera_->resources;
+  TransitionImageLayout(resources.lighting_color_resolve_image->images_[0],
+                        resources.lighting_color_resolve_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  if (camera_->shadow_depth_stencil) {
-    TransitionImageLayout(camera_->shadow_depth_stencil->images_[0],
-                          camera_->shadow_depth_stencil->format_,
+  if (anti_aliasing_ == AntiAliasing::TAA) {
+    const auto& history = resources.taa_history_images[
+        (resources.taa_history_index + 1) % resources.taa_history_images.size()];
+    TransitionImageLayout(history->images_[0], history->format_,
+                          VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+    TransitionImageLayout(resources.geometry_depth_resolve_image->images_[0],
+                          resources.geometry_depth_resolve_image->format_,
                           VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
-                          VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1,
-                          command_buffer_->handle_, 0,
-                          WIESEL_SHADOW_CASCADE_COUNT);
+                          VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
+                          command_buffer_->handle_, 0, 1);
+  }
+}
+
+Ref<AttachmentTexture> Renderer::GetSceneColorImage() {
+  switch (anti_aliasing_) {
+    case AntiAliasing::FXAA:
+      return camera_->resources->fxaa_color_image;
+    case AntiAliasing::TAA:
+      return camera_->resources->taa_history_images[camera_->resources->taa_history_index];
+    default:
+      return camera_->resources->lighting_color_resolve_image;
+  }
+}
+
+Ref<DescriptorSet> Renderer::GetSceneColorDescriptor() {
+  switch (anti_aliasing_) {
+    case AntiAliasing::FXAA:
+      return camera_->resources->fxaa_output_descriptor;
+    case AntiAliasing::TAA:
+      return camera_->resources->taa_history_output_descriptors[camera_->resources->taa_history_index];
+    default:
+      return camera_->resources->lighting_output_descriptor;
   }
 }
 
 void Renderer::BeginSpritePass() {
-  sprite_render_pass_->Begin(camera_->sprite_framebuffer, {0, 0, 0, 0});
+  sprite_render_pass_->Begin(camera_->resources->sprite_framebuffer, {0, 0, 0, 0},
+                             GetRenderExtent());
 }
 
 void Renderer::EndSpritePass() {
@@ -3323,37 +5314,46 @@ void Renderer::EndSpritePass() {
 }
 
 void Renderer::BeginCompositePass() {
-  TransitionImageLayout(camera_->lighting_color_resolve_image->images_[0],
-                        camera_->lighting_color_resolve_image->format_,
+  Ref<AttachmentTexture> sceneColor = GetSceneColorImage();
+  TransitionImageLayout(sceneColor->images_[0],
+                        sceneColor->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->sprite_color_image->images_[0],
-                        camera_->sprite_color_image->format_,
+  TransitionImageLayout(camera_->resources->sprite_color_image->images_[0],
+                        camera_->resources->sprite_color_image->format_,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  composite_render_pass_->Begin(camera_->composite_framebuffer, clear_color_);
+  // Upscales the deferred output to the full viewport
+  composite_pipeline_push_constant_->uv_scale = render_size_ / viewport_size_;
+  BeginStaticPass(composite_render_pass_, camera_->resources->composite_framebuffer,
+                  clear_color_,
+                  VkExtent2D{static_cast<uint32_t>(camera_->resources->composite_framebuffer->extent_.x),
+                             static_cast<uint32_t>(camera_->resources->composite_framebuffer->extent_.y)},
+                  VkExtent2D{static_cast<uint32_t>(viewport_size_.x),
+                             static_cast<uint32_t>(viewport_size_.y)});
 }
 
 void Renderer::EndCompositePass() {
+  Ref<AttachmentTexture> sceneColor = GetSceneColorImage();
   composite_render_pass_->End();
-  TransitionImageLayout(camera_->lighting_color_resolve_image->images_[0],
-                        camera_->lighting_color_resolve_image->format_,
+  TransitionImageLayout(sceneColor->images_[0],
+                        sceneColor->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
-  TransitionImageLayout(camera_->sprite_color_image->images_[0],
-                        camera_->sprite_color_image->format_,
+  TransitionImageLayout(camera_->resources->sprite_color_image->images_[0],
+                        camera_->resources->sprite_color_image->format_,
                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
                         VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, 1,
                         command_buffer_->handle_, 0, 1);
 }
 
-void Renderer::DrawSkybox(Ref<Skybox> skybox) {
+void Renderer::DrawSkybox(Skybox& skybox) {
   std::array<VkDescriptorSet, 2> sets{
-      skybox->descriptors_->descriptor_set_,
-      camera_->global_descriptor->descriptor_set_};
+      skybox.descriptors_->descriptor_set_,
+      camera_->resources->global_descriptor->descriptor_set_};
 
   vkCmdBindDescriptorSets(
       command_buffer_->handle_, VK_PIPELINE_BIND_POINT_GRAPHICS,
@@ -3373,31 +5373,121 @@ void Renderer::DrawFullscreen(
                           VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->m_Layout,
                           0, 1, &texture->m_Descriptors->m_DescriptorSet, 0,
                           nullptr);*/
-  std::vector<VkDescriptorSet> sets;
+  std::array<VkDescriptorSet, WIESEL_MAX_FULLSCREEN_DESCRIPTOR_SETS> sets;
+  uint32_t setCount = 0;
   for (const auto& item : descriptors) {
     if (!item) {
       continue;
     }
-    sets.push_back(item->descriptor_set_);
+    assert(setCount < sets.size());
+    sets[setCount++] = item->descriptor_set_;
   }
   vkCmdBindDescriptorSets(command_buffer_->handle_,
                           VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->layout_,
-                          0, sets.size(), sets.data(), 0, nullptr);
+                          0, setCount, sets.data(), 0, nullptr);
 
   // Draw the quad.
   vkCmdDraw(command_buffer_->handle_, 3, 1, 0, 0);
 }
 
-void Renderer::SetCameraData(Ref<CameraData> cameraData) {
-  camera_ = cameraData;
+void Renderer::BeginStaticPass(Ref<RenderPass> pass,
+                               Ref<Framebuffer> framebuffer,
+                               const Colorf& clear_color,
+                               VkExtent2D render_area, VkExtent2D viewport) {
+  pass->Begin(framebuffer, clear_color, render_area,
+              enable_static_passes_
+                  ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS
+                  : VK_SUBPASS_CONTENTS_INLINE);
+  static_pass_render_pass_ = pass->GetVulkanHandle();
+  static_pass_framebuffer_ = framebuffer->handle_;
+  static_pass_viewport_ = viewport;
+}
+
+void Renderer::ExecuteStaticPass(StaticPassCommands& commands,
+                                 const std::function<void()>& record) {
+  PROFILE_ZONE_SCOPED();
+  if (!enable_static_passes_) {
+    SetViewport(static_pass_viewport_);
+    record();
+    return;
+  }
+  // Viewport and push constants are baked into the recorded commands
+  if (!commands.buffer || commands.version != static_pass_version_ ||
+      commands.extent.width != static_pass_viewport_.width ||
+      commands.extent.height != static_pass_viewport_.height ||
+      commands.render_size != render_size_) {
+    PROFILE_ZONE_SCOPED_N("Renderer::ExecuteStaticPass: Record");
+    if (!commands.buffer) {
+      commands.buffer =
+          command_pool_->CreateBuffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+    }
+    commands.buffer->Begin(static_pass_render_pass_, 0,
+                           static_pass_framebuffer_);
+    // Everything recorded through the renderer goes to command_buffer_
+    Ref<CommandBuffer> primary = command_buffer_;
+    command_buffer_ = commands.buffer;
+    SetViewport(static_pass_viewport_);
+    record();
+    command_buffer_ = primary;
+    commands.buffer->End();
+    commands.version = static_pass_version_;
+    commands.extent = static_pass_viewport_;
+    commands.render_size = render_size_;
+  }
+  vkCmdExecuteCommands(command_buffer_->handle_, 1, &commands.buffer->handle_);
+}
+
+// Radical inverse of index in the given base, low discrepancy in [0, 1)
+static float Halton(uint32_t index, uint32_t base) {
+  float result = 0.0f;
+  float fraction = 1.0f;
+  while (index > 0) {
+    fraction /= static_cast<float>(base);
+    result += fraction * static_cast<float>(index % base);
+    index /= base;
+  }
+  return result;
+}
+
+void Renderer::SetCameraData(const CameraData* cameraData) {
+  if (!cameraData) {
+    camera_ = nullptr;
+    return;
+  }
+  // Copied so it outlives the render packet it came from
+  camera_data_ = *cameraData;
+  camera_ = &camera_data_;
   viewport_size_ = cameraData->viewport_size;
+  render_size_ = glm::max(glm::floor(viewport_size_ * cameraData->render_scale),
+                          glm::vec2{1.0f});
+  camera_uniform_data_.RenderScale = render_size_ / viewport_size_;
   camera_uniform_data_.Position = cameraData->position;
   camera_uniform_data_.ViewMatrix = cameraData->view_matrix;
   camera_uniform_data_.Projection = cameraData->projection;
   camera_uniform_data_.InvProjection = cameraData->inv_projection;
+  if (anti_aliasing_ == AntiAliasing::TAA) {
+    // Sub-pixel offset that changes every frame so TAA accumulates different
+    // samples. Only the uniform is jittered, culling and reprojection use the
+    // camera's own projection.
+    uint32_t sample = frame_index_ % WIESEL_TAA_JITTER_SAMPLES + 1;
+    glm::vec2 jitter{Halton(sample, 2) - 0.5f, Halton(sample, 3) - 0.5f};
+    camera_uniform_data_.Projection[2][0] += jitter.x * 2.0f / render_size_.x;
+    camera_uniform_data_.Projection[2][1] += jitter.y * 2.0f / render_size_.y;
+    camera_uniform_data_.InvProjection =
+        glm::inverse(camera_uniform_data_.Projection);
+  }
   camera_uniform_data_.NearPlane = cameraData->near_plane;
   camera_uniform_data_.FarPlane = cameraData->far_plane;
-  shadow_camera_uniform_data_.EnableShadows = cameraData->does_shadow_pass;
+  shadow_camera_uniform_data_.EnableShadows =
+      cameraData->shadow_source != nullptr;
+  if (cameraData->shadow_source) {
+    BindShadowMap(*cameraData->resources,
+                  cameraData->shadow_source->shadow_depth_stencil,
+                  cameraData->shadow_source->shadow_depth_view_array);
+  } else {
+    BindShadowMap(*cameraData->resources, blank_shadow_map_,
+                  blank_shadow_view_);
+  }
   for (int i = 0; i < WIESEL_SHADOW_CASCADE_COUNT; ++i) {
     shadow_camera_uniform_data_.ViewProjectionMatrix[i] =
         cameraData->shadow_map_cascades[i].ViewProjMatrix;
@@ -3405,7 +5495,41 @@ void Renderer::SetCameraData(Ref<CameraData> cameraData) {
         cameraData->shadow_map_cascades[i].SplitDepth;
   }
   // Todo move this to another ubo for options maybe
-  camera_uniform_data_.EnableSSAO = enable_ssao_;
+  if (!enable_ssao_ || !cameraData->enable_ssao) {
+    camera_uniform_data_.EnableSSAO = 0;
+  } else {
+    camera_uniform_data_.EnableSSAO = enable_ssao_temporal_ ? 2 : 1;
+  }
+  camera_uniform_data_.FrameIndex = frame_index_;
+  camera_uniform_data_.PreviousViewProjection =
+      cameraData->resources->previous_view_projection;
+}
+
+void Renderer::BindShadowMap(CameraResources& camera,
+                             const Ref<AttachmentTexture>& image,
+                             const Ref<ImageView>& view) {
+  if (camera.bound_shadow_view == view) {
+    return;
+  }
+  VkDescriptorImageInfo imageInfo{};
+  imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+  imageInfo.imageView = view->handle_;
+  imageInfo.sampler = shadow_compare_sampler_->sampler_;
+
+  VkWriteDescriptorSet set{};
+  set.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+  set.dstSet = camera.global_descriptor->descriptor_set_;
+  set.dstBinding = 3;
+  set.dstArrayElement = 0;
+  set.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+  set.descriptorCount = 1;
+  set.pImageInfo = &imageInfo;
+  // The last frame using the descriptor was waited for in EndPresent
+  vkUpdateDescriptorSets(logical_device_, 1, &set, 0, nullptr);
+  camera.bound_shadow_image = image;
+  camera.bound_shadow_view = view;
+  // Recorded passes captured the descriptor with the old image
+  InvalidateStaticPasses();
 }
 
 std::vector<const char*> Renderer::GetRequiredExtensions() {
@@ -3594,6 +5718,21 @@ QueueFamilyIndices Renderer::FindQueueFamilies(VkPhysicalDevice device) {
 
     i++;
   }
+
+  // A compute only family runs next to graphics on most desktop gpus
+  for (uint32_t family = 0; family < queueFamilyCount; family++) {
+    VkQueueFlags flags = queueFamilies[family].queueFlags;
+    if ((flags & VK_QUEUE_COMPUTE_BIT) && !(flags & VK_QUEUE_GRAPHICS_BIT)) {
+      indices.computeFamily = family;
+      indices.computeQueueIndex = 0;
+      break;
+    }
+  }
+  if (!indices.computeFamily.has_value() && indices.graphicsFamily.has_value() &&
+      queueFamilies[*indices.graphicsFamily].queueCount > 1) {
+    indices.computeFamily = indices.graphicsFamily;
+    indices.computeQueueIndex = 1;
+  }
   return indices;
 }
 
@@ -3640,6 +5779,19 @@ uint32_t Renderer::FindMemoryType(uint32_t typeFilter,
   throw std::runtime_error("failed to find suitable memory type!");
 }
 
+bool Renderer::HasMemoryType(uint32_t typeFilter,
+                             VkMemoryPropertyFlags properties) {
+  VkPhysicalDeviceMemoryProperties memProperties;
+  vkGetPhysicalDeviceMemoryProperties(physical_device_, &memProperties);
+  for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+    if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags &
+                                    properties) == properties) {
+      return true;
+    }
+  }
+  return false;
+}
+
 #ifdef VULKAN_VALIDATION
 
 void Renderer::SetupDebugMessenger() {
@@ -58,6 +58,7 @@ void RenderPass::Bake() {
   std::vector<VkAttachmentReference> colorAttachmentRefs;
   std::vector<VkAttachmentReference> resolveAttachmentRefs;
   std::vector<VkAttachmentReference> depthAttachmentRefs; // can only be one
+  std::vector<VkAttachmentReference> inputAttachmentRefs;
 
   uint32_t index = 0;
   for (const auto& item : attachments_) {
@@ -66,7 +67,7 @@ void RenderPass::Bake() {
           .format = item.format,
           .samples = item.msaa_samples,
           .loadOp = pass_type_ == PassType::Lighting ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
-          .storeOp = pass_type_ == PassType::Geometry || pass_type_ == PassType::Shadow ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE,
+          .storeOp = !item.transient && (pass_type_ == PassType::Geometry || pass_type_ == PassType::Shadow) ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE,
           .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
           .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
           .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
@@ -82,16 +83,22 @@ void RenderPass::Bake() {
           .format = item.format,
           .samples = item.msaa_samples,
           .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-          .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+          .storeOp = item.transient ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE,
           .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
           .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-          .initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+          .initialLayout = item.transient ? VK_IMAGE_LAYOUT_UNDEFINED : VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
           .finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
       });
       colorAttachmentRefs.push_back({
           .attachment = index,
           .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
       });
+      if (item.input) {
+        inputAttachmentRefs.push_back({
+            .attachment = index,
+            .layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        });
+      }
       index++;
     } else if (item.type == AttachmentTextureType::Resolve || item.type == AttachmentTextureType::SwapChain) {
       descriptions.push_back({
@@ -112,6 +119,12 @@ void RenderPass::Bake() {
     }
   }
 
+  VkAttachmentReference lightingAttachmentRef{};
+  if (pass_type_ == PassType::GeometryLighting) {
+    lightingAttachmentRef = colorAttachmentRefs.back();
+    colorAttachmentRefs.pop_back();
+  }
+
   VkSubpassDescription subpass{};
   subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
   subpass.colorAttachmentCount = colorAttachmentRefs.size();
@@ -126,6 +139,16 @@ void RenderPass::Bake() {
   } else {
     subpass.pDepthStencilAttachment = nullptr;
   }
+  std::vector<VkSubpassDescription> subpasses{subpass};
+  if (pass_type_ == PassType::GeometryLighting) {
+    VkSubpassDescription lightingSubpass{};
+    lightingSubpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    lightingSubpass.inputAttachmentCount = inputAttachmentRefs.size();
+    lightingSubpass.pInputAttachments = inputAttachmentRefs.data();
+    lightingSubpass.colorAttachmentCount = 1;
+    lightingSubpass.pColorAttachments = &lightingAttachmentRef;
+    subpasses.push_back(lightingSubpass);
+  }
 
   std::vector<VkSubpassDependency> dependencies{};
   /*if (m_PassType == PassType::Geometry || m_PassType == PassType::PostProcess) {
@@ -200,12 +223,24 @@ void RenderPass::Bake() {
                          VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
     });
   }
+  if (pass_type_ == PassType::GeometryLighting) {
+    // Lighting only reads the pixel it shades, so this stays within the tile
+    dependencies.push_back({
+        .srcSubpass = 0,
+        .dstSubpass = 1,
+        .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+        .dstStageMask = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INPUT_ATTACHMENT_READ_BIT,
+        .dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT
+    });
+  }
   VkRenderPassCreateInfo renderPassInfo{};
   renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
   renderPassInfo.attachmentCount = static_cast<uint32_t>(descriptions.size());
   renderPassInfo.pAttachments = descriptions.data();
-  renderPassInfo.subpassCount = 1;
-  renderPassInfo.pSubpasses = &subpass;
+  renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+  renderPassInfo.pSubpasses = subpasses.data();
   renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
   renderPassInfo.pDependencies = dependencies.data();
 
@@ -216,20 +251,40 @@ void RenderPass::Bake() {
 }
 
 void RenderPass::Begin(Ref<Framebuffer> framebuffer, const Colorf& clear_color) {
+  Begin(framebuffer, clear_color,
+        VkExtent2D{static_cast<uint32_t>(framebuffer->extent_.x),
+                   static_cast<uint32_t>(framebuffer->extent_.y)});
+}
+
+void RenderPass::Begin(Ref<Framebuffer> framebuffer, const Colorf& clear_color,
+                       VkExtent2D render_area, VkSubpassContents contents) {
+  std::vector<Colorf> clearColors;
+  for (const auto& item : attachments_) {
+    if (item.type == AttachmentTextureType::Offscreen || item.type == AttachmentTextureType::Color) {
+      clearColors.push_back(clear_color);
+    }
+  }
+  Begin(framebuffer, clearColors, render_area, contents);
+}
+
+void RenderPass::Begin(Ref<Framebuffer> framebuffer,
+                       std::span<const Colorf> clear_colors,
+                       VkExtent2D render_area, VkSubpassContents contents) {
   VkRenderPassBeginInfo renderPassInfo{};
   renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
   renderPassInfo.renderPass = render_pass_;
   renderPassInfo.framebuffer = framebuffer->handle_;
   renderPassInfo.renderArea.offset = {0, 0};
-  renderPassInfo.renderArea.extent.width = framebuffer->extent_.x;
-  renderPassInfo.renderArea.extent.height = framebuffer->extent_.y;
+  renderPassInfo.renderArea.extent = render_area;
 
   std::vector<VkClearValue> clearValues{};
+  uint32_t colorIndex = 0;
   for (const auto& item : attachments_) {
     if (item.type == AttachmentTextureType::Offscreen || item.type == AttachmentTextureType::Color) {
+      const Colorf& clearColor = clear_colors[colorIndex++];
       clearValues.push_back({
-          .color = {clear_color.red, clear_color.green,
-                    clear_color.blue, clear_color.alpha}
+          .color = {clearColor.red, clearColor.green,
+                    clearColor.blue, clearColor.alpha}
       });
     } else if (item.type == AttachmentTextureType::DepthStencil) {
       clearValues.push_back({
@@ -240,13 +295,31 @@ void RenderPass::Begin(Ref<Framebuffer> framebuffer, const Colorf& clear_color)
   renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
   renderPassInfo.pClearValues = clearValues.data();
   vkCmdBeginRenderPass(Engine::GetRenderer()->GetCommandBuffer().handle_, &renderPassInfo,
-                       VK_SUBPASS_CONTENTS_INLINE);
+                       contents);
+}
+
+void RenderPass::NextSubpass() {
+  vkCmdNextSubpass(Engine::GetRenderer()->GetCommandBuffer().handle_,
+                   VK_SUBPASS_CONTENTS_INLINE);
 }
 
 void RenderPass::End() {
   vkCmdEndRenderPass(Engine::GetRenderer()->GetCommandBuffer().handle_);
 }
 
+uint32_t RenderPass::GetColorAttachmentCount(uint32_t subpass) const {
+  uint32_t count = 0;
+  for (const auto& item : attachments_) {
+    if (item.type == AttachmentTextureType::Offscreen || item.type == AttachmentTextureType::Color) {
+      count++;
+    }
+  }
+  if (pass_type_ == PassType::GeometryLighting) {
+    return subpass == 0 ? count - 1 : 1;
+  }
+  return count;
+}
+
 // Change these to take span of Ref<ImageView> instead.
 Ref<Framebuffer> RenderPass::CreateFramebuffer(uint32_t index, std::span<AttachmentTexture*> output_attachments, glm::vec2 extent) {
   bool has_depth = false;
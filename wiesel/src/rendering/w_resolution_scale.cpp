@@ -0,0 +1,63 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_resolution_scale.hpp"
+
+namespace Wiesel {
+
+// Frames to wait after a change before looking at the frame time again
+static constexpr uint32_t kResolutionSettleFrames = 16;
+static constexpr float kResolutionScaleStep = 0.05f;
+static constexpr float kResolutionMaxStep = 0.15f;
+// Only scale back up when comfortably under the target
+static constexpr float kResolutionHeadroom = 0.85f;
+
+void ResolutionScaleController::Update(float gpu_frame_time_ms) {
+  if (gpu_frame_time_ms <= 0.0f) {
+    return;
+  }
+  if (average_frame_time_ms_ <= 0.0f) {
+    average_frame_time_ms_ = gpu_frame_time_ms;
+  } else {
+    average_frame_time_ms_ =
+        average_frame_time_ms_ * 0.9f + gpu_frame_time_ms * 0.1f;
+  }
+  if (++frames_since_change_ < kResolutionSettleFrames) {
+    return;
+  }
+
+  bool overBudget = average_frame_time_ms_ > target_frame_time_ms_;
+  bool underBudget =
+      average_frame_time_ms_ < target_frame_time_ms_ * kResolutionHeadroom;
+  if (!overBudget && !(underBudget && scale_ < 1.0f)) {
+    return;
+  }
+
+  // Cost of the deferred passes is roughly proportional to the pixel count
+  float desired = scale_ * std::sqrt(target_frame_time_ms_ /
+                                     average_frame_time_ms_);
+  desired = std::clamp(desired, scale_ - kResolutionMaxStep,
+                       scale_ + kResolutionMaxStep);
+  desired = std::round(desired / kResolutionScaleStep) * kResolutionScaleStep;
+  desired = std::clamp(desired, min_scale_, 1.0f);
+  if (desired != scale_) {
+    scale_ = desired;
+    frames_since_change_ = 0;
+  }
+}
+
+void ResolutionScaleController::Reset() {
+  scale_ = 1.0f;
+  average_frame_time_ms_ = 0.0f;
+  frames_since_change_ = 0;
+}
+
+}  // namespace Wiesel
@@ -28,8 +28,13 @@ Sampler::Sampler(uint32_t mipLevels, const Wiesel::SamplerProps& props) {
   }
   samplerInfo.borderColor = props.BorderColor;
   samplerInfo.unnormalizedCoordinates = VK_FALSE;
-  samplerInfo.compareEnable = VK_FALSE;
-  samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+  if (props.EnableCompare) {
+    samplerInfo.compareEnable = VK_TRUE;
+    samplerInfo.compareOp = props.CompareOp;
+  } else {
+    samplerInfo.compareEnable = VK_FALSE;
+    samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+  }
 
   samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
   samplerInfo.maxLod = static_cast<float>(mipLevels);
@@ -22,6 +22,8 @@ VkShaderStageFlagBits GetShaderFlagBitsByType(ShaderType type) {
       return VK_SHADER_STAGE_VERTEX_BIT;
     case ShaderTypeFragment:
       return VK_SHADER_STAGE_FRAGMENT_BIT;
+    case ShaderTypeCompute:
+      return VK_SHADER_STAGE_COMPUTE_BIT;
     default:
       // Invalid
       return VK_SHADER_STAGE_FLAG_BITS_MAX_ENUM;
@@ -45,6 +47,12 @@ Shader::Shader(ShaderProperties properties) : properties_(properties) {
       LOG_WARN("Defines for shader was not empty but the shader is precompiled. Defines might not be matching.");
     }
     code = ReadFileUint32(properties_.path);
+  } else if (properties_.source == ShaderSourceLibrary) {
+    if (!Engine::GetRenderer()->GetShaderLibrary().Find(
+            properties_.path, properties_.defines, code)) {
+      throw std::runtime_error("Shader permutation is not in the library: " +
+                               properties_.path);
+    }
   } else {
     throw std::runtime_error("Shader source not implemented!");
   }
@@ -0,0 +1,105 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_shaderlibrary.hpp"
+
+#include "util/w_logger.hpp"
+
+namespace Wiesel {
+
+static constexpr char kShaderLibraryMagic[4] = {'W', 'S', 'H', 'L'};
+static constexpr uint32_t kShaderLibraryVersion = 1;
+
+ShaderLibrary::ShaderLibrary(const std::string& path) {
+  PROFILE_ZONE_SCOPED();
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    LOG_WARN("Shader library {} not found, shaders will be compiled at runtime",
+             path);
+    return;
+  }
+
+  auto readU32 = [&file](uint32_t& value) {
+    return static_cast<bool>(
+        file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+  };
+  char magic[4];
+  uint32_t version = 0;
+  uint32_t count = 0;
+  if (!file.read(magic, sizeof(magic)) ||
+      memcmp(magic, kShaderLibraryMagic, sizeof(magic)) != 0 ||
+      !readU32(version) || version != kShaderLibraryVersion ||
+      !readU32(count)) {
+    LOG_WARN("Shader library {} is not valid, ignoring it", path);
+    return;
+  }
+
+  std::unordered_map<std::string, Entry> entries;
+  entries.reserve(count);
+  uint32_t totalSize = 0;
+  for (uint32_t i = 0; i < count; i++) {
+    uint32_t keyLength = 0;
+    Entry entry{};
+    std::string key;
+    if (!readU32(keyLength)) {
+      break;
+    }
+    key.resize(keyLength);
+    if (!file.read(key.data(), keyLength) || !readU32(entry.offset) ||
+        !readU32(entry.size)) {
+      break;
+    }
+    totalSize = std::max(totalSize, entry.offset + entry.size);
+    entries.emplace(std::move(key), entry);
+  }
+  std::vector<uint32_t> code(totalSize);
+  if (entries.size() != count ||
+      !file.read(reinterpret_cast<char*>(code.data()),
+                 code.size() * sizeof(uint32_t))) {
+    LOG_WARN("Shader library {} is truncated, ignoring it", path);
+    return;
+  }
+
+  entries_ = std::move(entries);
+  code_ = std::move(code);
+  LOG_INFO("Loaded {} shader permutations from {}", entries_.size(), path);
+}
+
+bool ShaderLibrary::Contains(const std::string& path,
+                             const std::vector<std::string>& defines) const {
+  return entries_.contains(MakeKey(path, defines));
+}
+
+bool ShaderLibrary::Find(const std::string& path,
+                         const std::vector<std::string>& defines,
+                         std::vector<uint32_t>& code) const {
+  auto it = entries_.find(MakeKey(path, defines));
+  if (it == entries_.end()) {
+    return false;
+  }
+  auto begin = code_.begin() + it->second.offset;
+  code.assign(begin, begin + it->second.size);
+  return true;
+}
+
+std::string ShaderLibrary::MakeKey(const std::string& path,
+                                   std::vector<std::string> defines) {
+  std::sort(defines.begin(), defines.end());
+  defines.erase(std::unique(defines.begin(), defines.end()), defines.end());
+  std::string key = path;
+  for (const auto& define : defines) {
+    key += '|';
+    key += define;
+  }
+  return key;
+}
+
+}  // namespace Wiesel
@@ -0,0 +1,286 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+#include "rendering/w_shaderreloader.hpp"
+
+#ifdef WIESEL_PLATFORM_LINUX
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "util/w_logger.hpp"
+#include "util/w_spirv.hpp"
+#include "w_engine.hpp"
+
+namespace Wiesel {
+
+ShaderReloader::ShaderReloader(const std::string& directory)
+    : directory_(directory),
+      device_(Engine::GetRenderer()->GetLogicalDevice()) {
+#ifdef WIESEL_PLATFORM_LINUX
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  // Editors either write in place or rename a temporary file over it
+  if (inotify_fd_ < 0 ||
+      inotify_add_watch(inotify_fd_, directory_.string().c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    LOG_ERROR("Failed to watch {}, shader hot reload is disabled",
+              directory_.string());
+    return;
+  }
+#else
+  std::error_code error;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(directory_, error)) {
+    write_times_[entry.path().filename().string()] =
+        entry.last_write_time(error);
+  }
+  if (error) {
+    LOG_ERROR("Failed to watch {}, shader hot reload is disabled",
+              directory_.string());
+    return;
+  }
+#endif
+  LOG_INFO("Watching {} for shader changes", directory_.string());
+  thread_ = std::thread(&ShaderReloader::Run, this);
+}
+
+ShaderReloader::~ShaderReloader() {
+  running_ = false;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+#ifdef WIESEL_PLATFORM_LINUX
+  if (inotify_fd_ >= 0) {
+    close(inotify_fd_);
+  }
+#endif
+  // Nothing was swapped in yet, the renderer doesn't know about these
+  for (const auto& compiled : compiled_) {
+    vkDestroyShaderModule(device_, compiled.module, nullptr);
+  }
+  for (const auto& baked : baked_) {
+    vkDestroyPipeline(device_, baked.handle, nullptr);
+    vkDestroyPipelineLayout(device_, baked.layout, nullptr);
+  }
+  for (const auto& retired : retired_pipelines_) {
+    vkDestroyPipeline(device_, retired.handle, nullptr);
+    vkDestroyPipelineLayout(device_, retired.layout, nullptr);
+  }
+  for (VkShaderModule module : retired_modules_) {
+    vkDestroyShaderModule(device_, module, nullptr);
+  }
+}
+
+void ShaderReloader::Track(const Ref<Shader>& shader) {
+  std::lock_guard lock(mutex_);
+  std::erase_if(shaders_, [](const auto& item) { return item.expired(); });
+  shaders_.push_back(shader);
+}
+
+bool ShaderReloader::Apply() {
+  PROFILE_ZONE_SCOPED();
+  // Swapped out a frame ago, that frame's fence has passed since
+  for (const auto& retired : retired_pipelines_) {
+    vkDestroyPipeline(device_, retired.handle, nullptr);
+    vkDestroyPipelineLayout(device_, retired.layout, nullptr);
+  }
+  retired_pipelines_.clear();
+
+  std::lock_guard lock(mutex_);
+  bool swapped = false;
+  for (const auto& baked : baked_) {
+    Pipeline& pipeline = *baked.pipeline;
+    if (!pipeline.is_allocated_ || pipeline.bake_version_ != baked.bake_version) {
+      // Baked again meanwhile, that already used the new shader modules
+      vkDestroyPipeline(device_, baked.handle, nullptr);
+      vkDestroyPipelineLayout(device_, baked.layout, nullptr);
+      continue;
+    }
+    retired_pipelines_.push_back({pipeline.layout_, pipeline.pipeline_});
+    pipeline.layout_ = baked.layout;
+    pipeline.pipeline_ = baked.handle;
+    swapped = true;
+  }
+  baked_.clear();
+
+  std::set<Pipeline*> queued;
+  for (const auto& compiled : compiled_) {
+    Shader& shader = *compiled.shader;
+    retired_modules_.push_back(shader.shader_module_);
+    shader.shader_module_ = compiled.module;
+    reloaded_.insert(
+        std::filesystem::path(shader.properties_.path).filename().string());
+    LOG_INFO("Reloaded shader {}", shader.properties_.path);
+
+    std::erase_if(shader.pipelines_,
+                  [](const auto& item) { return item.expired(); });
+    for (const auto& item : shader.pipelines_) {
+      Ref<Pipeline> pipeline = item.lock();
+      if (!pipeline || !pipeline->is_allocated_ ||
+          !queued.insert(pipeline.get()).second) {
+        continue;
+      }
+      // Everything is taken now, the main thread may change and bake the
+      // pipeline again while the worker builds it
+      PipelineJob job{pipeline, pipeline->bake_version_,
+                      pipeline->GetCreateState(), {}};
+      for (const auto& info : pipeline->shaders_) {
+        job.modules.push_back(info.shader->shader_module_);
+      }
+      jobs_.push_back(std::move(job));
+    }
+  }
+  compiled_.clear();
+
+  if (jobs_.empty() && !building_) {
+    for (VkShaderModule module : retired_modules_) {
+      vkDestroyShaderModule(device_, module, nullptr);
+    }
+    retired_modules_.clear();
+  }
+  return swapped;
+}
+
+std::string ShaderReloader::GetReloadedPath(const std::string& path) const {
+  std::string name = std::filesystem::path(path).filename().string();
+  if (!reloaded_.contains(name)) {
+    return "";
+  }
+  return (directory_ / name).string();
+}
+
+void ShaderReloader::Run() {
+  while (running_) {
+    std::set<std::string> changed;
+    WaitForChanges(changed);
+    if (!changed.empty()) {
+      Compile(changed);
+    }
+    BuildPipelines();
+  }
+}
+
+void ShaderReloader::WaitForChanges(std::set<std::string>& changed) {
+#ifdef WIESEL_PLATFORM_LINUX
+  pollfd fd{inotify_fd_, POLLIN, 0};
+  if (poll(&fd, 1, 100) <= 0) {
+    return;
+  }
+  alignas(inotify_event) char buffer[4096];
+  ssize_t length;
+  while ((length = read(inotify_fd_, buffer, sizeof(buffer))) > 0) {
+    for (char* ptr = buffer; ptr < buffer + length;) {
+      auto* event = reinterpret_cast<inotify_event*>(ptr);
+      if (event->len > 0) {
+        changed.insert(event->name);
+      }
+      ptr += sizeof(inotify_event) + event->len;
+    }
+  }
+#else
+  std::this_thread::sleep_for(std::chrono::milliseconds(250));
+  std::error_code error;
+  for (const auto& entry :
+       std::filesystem::directory_iterator(directory_, error)) {
+    auto time = entry.last_write_time(error);
+    auto& known = write_times_[entry.path().filename().string()];
+    if (!error && known != time) {
+      known = time;
+      changed.insert(entry.path().filename().string());
+    }
+  }
+#endif
+}
+
+void ShaderReloader::Compile(const std::set<std::string>& changed) {
+  PROFILE_ZONE_SCOPED();
+  std::vector<Ref<Shader>> shaders;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto& item : shaders_) {
+      Ref<Shader> shader = item.lock();
+      if (shader && shader->properties_.source != ShaderSourcePrecompiled &&
+          changed.contains(std::filesystem::path(shader->properties_.path)
+                               .filename()
+                               .string())) {
+        shaders.push_back(shader);
+      }
+    }
+  }
+
+#ifdef DEBUG
+  bool debug = true;
+#else
+  bool debug = false;
+#endif
+  for (const auto& shader : shaders) {
+    const ShaderProperties& properties = shader->properties_;
+    std::filesystem::path source =
+        directory_ / std::filesystem::path(properties.path).filename();
+    std::vector<char> file;
+    try {
+      file = ReadFile(source.string());
+    } catch (const std::exception& e) {
+      LOG_ERROR("Failed to read {}: {}", source.string(), e.what());
+      continue;
+    }
+    std::vector<uint32_t> code;
+    if (!Spirv::ShaderToSPV(properties.type, debug, file, properties.defines,
+                            code)) {
+      LOG_ERROR("Failed to compile {}, keeping the last good version",
+                source.string());
+      continue;
+    }
+
+    VkShaderModuleCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    createInfo.codeSize = code.size() * 4;
+    createInfo.pCode = code.data();
+    VkShaderModule module;
+    if (vkCreateShaderModule(device_, &createInfo, nullptr, &module) !=
+        VK_SUCCESS) {
+      LOG_ERROR("Failed to create shader module for {}", source.string());
+      continue;
+    }
+    std::lock_guard lock(mutex_);
+    compiled_.push_back({shader, module});
+  }
+}
+
+void ShaderReloader::BuildPipelines() {
+  std::vector<PipelineJob> jobs;
+  {
+    std::lock_guard lock(mutex_);
+    jobs.swap(jobs_);
+    building_ = !jobs.empty();
+  }
+  if (jobs.empty()) {
+    return;
+  }
+  PROFILE_ZONE_SCOPED();
+  std::vector<BakedPipeline> baked;
+  baked.reserve(jobs.size());
+  for (auto& job : jobs) {
+    BakedPipeline result{job.pipeline, job.bake_version, VK_NULL_HANDLE,
+                         VK_NULL_HANDLE};
+    Pipeline::CreateHandles(job.state, job.modules, result.layout,
+                            result.handle);
+    baked.push_back(std::move(result));
+  }
+  std::lock_guard lock(mutex_);
+  for (auto& item : baked) {
+    baked_.push_back(std::move(item));
+  }
+  building_ = false;
+}
+
+}  // namespace Wiesel
@@ -77,6 +77,11 @@ void RenderComponentImGui(ModelComponent& component, Entity entity) {
     }
     ImGui::Checkbox("Receive Shadows", &model.data.receive_shadows);
     ImGui::Checkbox("Render", &model.data.enable_rendering);
+    if (ImGui::Checkbox("Impostor", &model.data.enable_impostor) &&
+        model.data.enable_impostor && !model.data.impostor) {
+      model.data.impostor =
+          Engine::GetRenderer()->GetOrCreateImpostor(model.data);
+    }
     ImGui::TreePop();
   }
   if (!visible) {
@@ -88,17 +93,21 @@ void RenderComponentImGui(ModelComponent& component, Entity entity) {
 void RenderComponentImGui(LightDirectComponent& component, Entity entity) {
   static bool visible = true;
   if (ImGui::ClosableTreeNode("Directional Light", &visible)) {
-    ImGui::DragFloat(PrefixLabel("Ambient").c_str(),
-                     &component.light_data.base.ambient, 0.01f);
-    ImGui::DragFloat(PrefixLabel("Diffuse").c_str(),
-                     &component.light_data.base.diffuse, 0.1f);
-    ImGui::DragFloat(PrefixLabel("Specular").c_str(),
-                     &component.light_data.base.specular, 0.1f);
-    ImGui::DragFloat(PrefixLabel("Density").c_str(),
-                     &component.light_data.base.density, 0.1f);
-    ImGui::ColorPicker3(
+    bool changed = false;
+    changed |= ImGui::DragFloat(PrefixLabel("Ambient").c_str(),
+                                &component.light_data.base.ambient, 0.01f);
+    changed |= ImGui::DragFloat(PrefixLabel("Diffuse").c_str(),
+                                &component.light_data.base.diffuse, 0.1f);
+    changed |= ImGui::DragFloat(PrefixLabel("Specular").c_str(),
+                                &component.light_data.base.specular, 0.1f);
+    changed |= ImGui::DragFloat(PrefixLabel("Density").c_str(),
+                                &component.light_data.base.density, 0.1f);
+    changed |= ImGui::ColorPicker3(
         PrefixLabel("Color").c_str(),
         reinterpret_cast<float*>(&component.light_data.base.color));
+    if (changed) {
+      component.is_changed = true;
+    }
     ImGui::TreePop();
   }
   if (!visible) {
@@ -110,25 +119,29 @@ void RenderComponentImGui(LightDirectComponent& component, Entity entity) {
 void RenderComponentImGui(LightPointComponent& component, Entity entity) {
   static bool visible = true;
   if (ImGui::ClosableTreeNode("Point Light", &visible)) {
-    ImGui::DragFloat(PrefixLabel("Ambient").c_str(),
-                     &component.light_data.base.ambient, 0.01f);
-    ImGui::DragFloat(PrefixLabel("Diffuse").c_str(),
-                     &component.light_data.base.diffuse, 0.1f);
-    ImGui::DragFloat(PrefixLabel("Specular").c_str(),
-                     &component.light_data.base.specular, 0.1f);
-    ImGui::DragFloat(PrefixLabel("Density").c_str(),
-                     &component.light_data.base.density, 0.1f);
+    bool changed = false;
+    changed |= ImGui::DragFloat(PrefixLabel("Ambient").c_str(),
+                                &component.light_data.base.ambient, 0.01f);
+    changed |= ImGui::DragFloat(PrefixLabel("Diffuse").c_str(),
+                                &component.light_data.base.diffuse, 0.1f);
+    changed |= ImGui::DragFloat(PrefixLabel("Specular").c_str(),
+                                &component.light_data.base.specular, 0.1f);
+    changed |= ImGui::DragFloat(PrefixLabel("Density").c_str(),
+                                &component.light_data.base.density, 0.1f);
     if (ImGui::TreeNode("Attenuation")) {
-      ImGui::DragFloat(PrefixLabel("Constant").c_str(),
-                       &component.light_data.constant, 0.1f);
-      ImGui::DragFloat(PrefixLabel("Linear").c_str(),
-                       &component.light_data.linear, 0.1f);
-      ImGui::DragFloat(PrefixLabel("Exp").c_str(),
-                       &component.light_data.exp, 0.1f);
+      changed |= ImGui::DragFloat(PrefixLabel("Constant").c_str(),
+                                  &component.light_data.constant, 0.1f);
+      changed |= ImGui::DragFloat(PrefixLabel("Linear").c_str(),
+                                  &component.light_data.linear, 0.1f);
+      changed |= ImGui::DragFloat(PrefixLabel("Exp").c_str(),
+                                  &component.light_data.exp, 0.1f);
       ImGui::TreePop();
     }
-    ImGui::ColorPicker3(
+    changed |= ImGui::ColorPicker3(
         "Color", reinterpret_cast<float*>(&component.light_data.base.color));
+    if (changed) {
+      component.is_changed = true;
+    }
     ImGui::TreePop();
   }
   if (!visible) {
@@ -150,6 +163,23 @@ void RenderComponentImGui(CameraComponent& component, Entity entity) {
     if (changed) {
       component.view_changed = true;
     }
+    if (ImGui::TreeNode("Rendering")) {
+      int interval = static_cast<int>(component.render_interval);
+      if (ImGui::DragInt(PrefixLabel("Interval").c_str(), &interval, 1, 1,
+                         60)) {
+        component.render_interval = std::max(interval, 1);
+      }
+      ImGui::DragFloat(PrefixLabel("Max Rate").c_str(),
+                       &component.max_render_rate, 1.0f, 0.0f, 240.0f);
+      ImGui::DragFloat(PrefixLabel("Scale").c_str(),
+                       &component.render_scale_factor, 0.01f, 0.1f, 1.0f);
+      ImGui::Checkbox(PrefixLabel("SSAO").c_str(), &component.enable_ssao);
+      ImGui::Checkbox(PrefixLabel("Shadows").c_str(),
+                      &component.enable_shadows);
+      ImGui::Checkbox(PrefixLabel("Share Main Shadows").c_str(),
+                      &component.share_main_shadows);
+      ImGui::TreePop();
+    }
 
     ImGui::TreePop();
   }
@@ -22,6 +22,9 @@ glm::vec3 EulerToDirection(glm::vec3 euler) {
 
 void UpdateLight(LightsUniformData& lights, const LightDirect& light,
                  const TransformComponent& transform) {
+  if (lights.direct_light_count >= MAX_LIGHTS) {
+    return;
+  }
   // world position is the 4th column
   glm::vec3 worldPos = glm::vec3(transform.transform_matrix[3]);
 
@@ -38,11 +41,14 @@ void UpdateLight(LightsUniformData& lights, const LightDirect& light,
   dst.base.density                 = light.base.density;
 }
 
-void UpdateLight(LightsUniformData& lights, const LightPoint& light,
+void UpdateLight(std::vector<LightPoint>& lights, const LightPoint& light,
                  const TransformComponent& transform) {
+  if (lights.size() >= WIESEL_MAX_POINT_LIGHTS) {
+    return;
+  }
   glm::vec3 worldPos = glm::vec3(transform.transform_matrix[3]);
 
-  LightPoint& dst = lights.point_lights[lights.point_light_count++];
+  LightPoint& dst = lights.emplace_back();
   dst.base.position = worldPos;
   dst.base.color    = light.base.color;
   dst.base.ambient  = light.base.ambient;
@@ -52,6 +58,31 @@ void UpdateLight(LightsUniformData& lights, const LightPoint& light,
   dst.constant      = light.constant;
   dst.linear        = light.linear;
   dst.exp           = light.exp;
+  dst.radius        = ComputeLightRadius(light);
+}
+
+float ComputeLightRadius(const LightPoint& light) {
+  // Solve for the distance where the light contributes less than 1/256.
+  // Ambient is left out, it only fills in shading and would stretch the range
+  // far past where the light is visibly lighting anything.
+  const float threshold = 256.0f;
+  float intensity = std::max({light.base.color.r, light.base.color.g,
+                              light.base.color.b}) *
+                    light.base.density *
+                    (light.base.diffuse + light.base.specular);
+  float c = light.constant - intensity * threshold;
+  if (c >= 0.0f) {
+    return 0.0f;
+  }
+  if (light.exp > 0.0f) {
+    return (-light.linear +
+            std::sqrt(light.linear * light.linear - 4.0f * light.exp * c)) /
+           (2.0f * light.exp);
+  }
+  if (light.linear > 0.0f) {
+    return -c / light.linear;
+  }
+  return std::numeric_limits<float>::max();
 }
 
 }  // namespace Wiesel
\ No newline at end of file
@@ -13,13 +13,23 @@
 
 #include "behavior/w_behavior.hpp"
 #include "rendering/w_renderer.hpp"
+#include "rendering/w_renderpacket.hpp"
 #include "scene/w_entity.hpp"
+#include "util/w_math.hpp"
 #include "w_engine.hpp"
 
 namespace Wiesel {
 
 Scene::Scene() {
-  current_camera_ = CreateReference<CameraData>();
+  render_packet_ = CreateScope<RenderPacket>();
+  registry_.on_construct<LightDirectComponent>()
+      .connect<&Scene::OnLightComponentChanged>(*this);
+  registry_.on_destroy<LightDirectComponent>()
+      .connect<&Scene::OnLightComponentChanged>(*this);
+  registry_.on_construct<LightPointComponent>()
+      .connect<&Scene::OnLightComponentChanged>(*this);
+  registry_.on_destroy<LightPointComponent>()
+      .connect<&Scene::OnLightComponentChanged>(*this);
 }
 
 Scene::~Scene() {}
@@ -75,21 +85,13 @@ void Scene::OnUpdate(float_t deltaTime) {
         auto& camera = registry_.get<CameraComponent>(entity);
         camera.pos_changed = true;
       }
+      if (registry_.any_of<LightDirectComponent, LightPointComponent>(entity)) {
+        lights_dirty_ = true;
+      }
     }
   }
-  auto& lights = Engine::GetRenderer()->lights_uniform_data_;
-  lights.direct_light_count = 0;
-  lights.point_light_count = 0;
-  for (const auto& entity : registry_.view<LightDirectComponent>()) {
-    auto& light = registry_.get<LightDirectComponent>(entity);
-    auto& transform = registry_.get<TransformComponent>(entity);
-    UpdateLight(lights, light.light_data, transform);
-  }
-  for (const auto& entity : registry_.view<LightPointComponent>()) {
-    auto& light = registry_.get<LightPointComponent>(entity);
-    auto& transform = registry_.get<TransformComponent>(entity);
-    UpdateLight(lights, light.light_data, transform);
-  }
+  UpdateLights();
+  auto& lights = render_packet_->lights;
 
   for (const auto& entity :
        registry_.view<CameraComponent, TransformComponent>()) {
@@ -118,6 +120,47 @@ void Scene::OnUpdate(float_t deltaTime) {
   }
 }
 
+void Scene::UpdateLights() {
+  PROFILE_ZONE_SCOPED();
+  for (const auto& entity : registry_.view<LightDirectComponent>()) {
+    auto& light = registry_.get<LightDirectComponent>(entity);
+    lights_dirty_ |= light.is_changed;
+    light.is_changed = false;
+  }
+  for (const auto& entity : registry_.view<LightPointComponent>()) {
+    auto& light = registry_.get<LightPointComponent>(entity);
+    lights_dirty_ |= light.is_changed;
+    light.is_changed = false;
+  }
+  if (!lights_dirty_) {
+    return;
+  }
+  lights_dirty_ = false;
+
+  auto& lights = render_packet_->lights;
+  auto& pointLights = render_packet_->point_lights;
+  lights.direct_light_count = 0;
+  pointLights.clear();
+  for (const auto& entity :
+       registry_.view<LightDirectComponent, TransformComponent>()) {
+    auto& light = registry_.get<LightDirectComponent>(entity);
+    auto& transform = registry_.get<TransformComponent>(entity);
+    UpdateLight(lights, light.light_data, transform);
+  }
+  for (const auto& entity :
+       registry_.view<LightPointComponent, TransformComponent>()) {
+    auto& light = registry_.get<LightPointComponent>(entity);
+    auto& transform = registry_.get<TransformComponent>(entity);
+    UpdateLight(pointLights, light.light_data, transform);
+  }
+  render_packet_->lights_changed = true;
+}
+
+void Scene::OnLightComponentChanged(entt::registry& registry,
+                                    entt::entity entity) {
+  lights_dirty_ = true;
+}
+
 void Scene::OnEvent(Event& event) {
   EventDispatcher dispatcher{event};
   dispatcher.Dispatch<WindowResizeEvent>(WIESEL_BIND_FN(OnWindowResizeEvent));
@@ -177,6 +220,12 @@ void Scene::UnlinkEntities(entt::entity parent, entt::entity child) {
   child_transform.is_changed = true;
 }
 
+void Scene::SetSkybox(Ref<Skybox> skybox) {
+  skybox_ = skybox;
+  // Skybox is drawn by the recorded lighting pass
+  Engine::GetRenderer()->InvalidateStaticPasses();
+}
+
 void Scene::ProcessDestroyQueue() {
   PROFILE_ZONE_SCOPED();
   for (const auto& item : destroy_queue_) {
@@ -228,135 +277,487 @@ void Scene::UpdateMatrices(entt::entity entity) {
   tc.normal_matrix = glm::inverseTranspose(glm::mat3(tc.transform_matrix));
 }
 
-bool Scene::Render() {
+void Scene::ExtractRenderPacket() {
   PROFILE_ZONE_SCOPED();
-  bool hasCamera = false;
-  Ref<Renderer> renderer = Engine::GetRenderer();
-  // Render models
-  for (const auto& cameraEntity : GetAllEntitiesWith<CameraComponent>()) {
-    auto& camera = registry_.get<CameraComponent>(cameraEntity);
-    auto& camera_transform = registry_.get<TransformComponent>(cameraEntity);
-    if (!camera.enabled) {
+  RenderPacket& packet = *render_packet_;
+  packet.Clear();
+  packet.skybox = skybox_.get();
+
+  // Cameras sharing shadows sample the first one that renders its own
+  CameraComponent* mainCamera = nullptr;
+  for (const auto& entity : registry_.view<CameraComponent>()) {
+    auto& camera = registry_.get<CameraComponent>(entity);
+    if (camera.enabled && camera.resources && camera.enable_shadows &&
+        !camera.share_main_shadows) {
+      mainCamera = &camera;
+      break;
+    }
+  }
+
+  float renderScale = Engine::GetRenderer()->GetRenderScale();
+  float time = Time::GetTime();
+  for (const auto& entity :
+       registry_.view<CameraComponent, TransformComponent>()) {
+    auto& camera = registry_.get<CameraComponent>(entity);
+    auto& transform = registry_.get<TransformComponent>(entity);
+    if (!camera.enabled || !camera.resources) {
+      continue;
+    }
+    if (camera.frames_until_render > 0 ||
+        (camera.max_render_rate > 0.0f && time < camera.next_render_time)) {
+      if (camera.frames_until_render > 0) {
+        camera.frames_until_render--;
+      }
+      packet.skipped_cameras++;
+      continue;
+    }
+    camera.frames_until_render = std::max(camera.render_interval, 1u) - 1;
+    if (camera.max_render_rate > 0.0f) {
+      camera.next_render_time = time + 1.0f / camera.max_render_rate;
+    }
+    float cameraRenderScale =
+        std::clamp(renderScale * camera.render_scale_factor, 0.1f, 1.0f);
+    if (cameraRenderScale != camera.render_scale) {
+      // Everything captured at the old scale covers a different area now
+      camera.render_scale = cameraRenderScale;
+      camera.resources->hiz_pyramid->Invalidate();
+      camera.resources->previous_view_projection = glm::mat4{0.0f};
+    }
+    CameraData& data = packet.cameras.emplace_back();
+    data.position = transform.position;
+    data.view_matrix = camera.view_matrix;
+    data.projection = camera.projection;
+    data.inv_projection = camera.inv_projection;
+    data.viewport_size = camera.viewport_size;
+    data.near_plane = camera.near_plane;
+    data.far_plane = camera.far_plane;
+    data.render_scale = camera.render_scale;
+    data.planes = camera.planes;
+    data.enable_ssao = camera.enable_ssao;
+    data.resources = camera.resources.get();
+    if (camera.enable_shadows && camera.share_main_shadows) {
+      if (mainCamera && mainCamera->does_shadow_pass) {
+        data.shadow_source = mainCamera->resources.get();
+      }
+    } else if (camera.enable_shadows && camera.does_shadow_pass) {
+      data.does_shadow_pass = true;
+      data.shadow_map_cascades = camera.shadow_map_cascades;
+      data.shadow_source = data.resources;
+      camera.resources->shadow_map_cascades = camera.shadow_map_cascades;
+    }
+  }
+  // Cameras rendering shadows go first so the ones sharing their map sample
+  // this frame's, with the cascades it was rendered with. If the main camera
+  // was skipped that is still its last map with matching cascades.
+  std::stable_partition(
+      packet.cameras.begin(), packet.cameras.end(),
+      [](const CameraData& data) { return data.does_shadow_pass; });
+  for (CameraData& data : packet.cameras) {
+    if (data.shadow_source && !data.does_shadow_pass) {
+      data.shadow_map_cascades = data.shadow_source->shadow_map_cascades;
+    }
+  }
+
+  for (const auto& entity :
+       registry_.view<ModelComponent, TransformComponent>()) {
+    auto& model = registry_.get<ModelComponent>(entity);
+    if (!model.data.enable_rendering) {
+      continue;
+    }
+    auto& transform = registry_.get<TransformComponent>(entity);
+    uint32_t transformIndex = packet.transforms.size();
+    packet.transforms.push_back({transform.transform_matrix,
+                                 transform.normal_matrix,
+                                 static_cast<uint32_t>(entity) + 1});
+    uint32_t firstMesh = packet.meshes.size();
+    glm::vec3 boundsMin{std::numeric_limits<float>::max()};
+    glm::vec3 boundsMax{std::numeric_limits<float>::lowest()};
+    for (const auto& mesh : model.data.meshes) {
+      if (!mesh->allocated_) {
+        continue;
+      }
+      packet.meshes.push_back({mesh->handle, mesh->bounds_min,
+                               mesh->bounds_max, transformIndex,
+                               model.data.receive_shadows});
+      boundsMin = glm::min(boundsMin, mesh->bounds_min);
+      boundsMax = glm::max(boundsMax, mesh->bounds_max);
+    }
+    uint32_t meshCount =
+        static_cast<uint32_t>(packet.meshes.size()) - firstMesh;
+    glm::vec3 center{0.0f};
+    float radius = 0.0f;
+    if (meshCount > 0) {
+      center = (boundsMin + boundsMax) * 0.5f;
+      radius = glm::length(boundsMax - boundsMin) * 0.5f;
+    }
+    packet.models.push_back(
+        {model.data.enable_impostor ? model.data.impostor.get() : nullptr,
+         transformIndex, firstMesh, meshCount, center, radius});
+  }
+
+  for (const auto& entity :
+       registry_.view<SpriteComponent, TransformComponent>()) {
+    auto& sprite = registry_.get<SpriteComponent>(entity);
+    if (!sprite.asset_handle_) {
       continue;
     }
-    current_camera_->TransferFrom(camera, camera_transform);
-    renderer->SetCameraData(current_camera_);
+    auto& transform = registry_.get<TransformComponent>(entity);
+    uint32_t transformIndex = packet.transforms.size();
+    packet.transforms.push_back({transform.transform_matrix,
+                                 transform.normal_matrix,
+                                 static_cast<uint32_t>(entity) + 1});
+    packet.sprites.push_back(
+        {sprite.asset_handle_.get(), sprite.current_frame_, transformIndex});
+  }
+}
+
+bool Scene::Render(bool present_directly) {
+  PROFILE_ZONE_SCOPED();
+  const Ref<Renderer>& renderer = Engine::GetRenderer();
+  RenderPacket& packet = *render_packet_;
+  if (packet.lights_changed) {
+    renderer->lights_uniform_data_ = packet.lights;
+    renderer->point_lights_ = packet.point_lights;
+    renderer->MarkLightsChanged();
+    packet.lights_changed = false;
+  }
+  if (present_directly && renderer->IsDirectCompositeEnabled() &&
+      !renderer->IsOnlySSAO()) {
+    // Every other camera would overwrite the composited output of the last
+    // one, and a skipped camera has nothing to composite
+    renderer->SetCompositeInPresent(packet.cameras.size() == 1 &&
+                                    packet.skipped_cameras == 0);
+  } else {
+    renderer->SetCompositeInPresent(false);
+  }
+  if (packet.cameras.empty() && packet.skipped_cameras == 0) {
+    renderer->SetCameraData(nullptr);
+  }
+  // Render models
+  for (const CameraData& camera : packet.cameras) {
+    CameraResources& resources = *camera.resources;
+    renderer->SetCameraData(&camera);
     renderer->UpdateUniformData();
+    glm::mat4 viewProjection = camera.projection * camera.view_matrix;
+    bool occlusionCulling = renderer->IsOcclusionCullingEnabled();
+    if (occlusionCulling) {
+      // Built from the depth of the previous frame, meshes culled there are
+      // tested again against every new pyramid so they come back once visible.
+      resources.hiz_pyramid->Update(
+          static_cast<const float*>(resources.hiz_readback_buffer->data_),
+          resources.hiz_image->width_);
+      occlusionCulling = resources.hiz_pyramid->IsUsableFor(viewProjection);
+    } else {
+      resources.hiz_pyramid->Invalidate();
+    }
+    // Picked per model so all of its meshes switch together, every camera
+    // keeps its own hysteresis state
+    mesh_lods_.assign(packet.meshes.size(), 0);
+    if (renderer->IsMeshLodsEnabled()) {
+      if (resources.model_lods.size() > packet.models.size() * 2) {
+        // Mostly removed entities, the rest only lose one frame of hysteresis
+        resources.model_lods.clear();
+      }
+      for (const RenderModel& model : packet.models) {
+        const RenderTransform& transform =
+            packet.transforms[model.transform_index];
+        float screenSize = Math::GetScreenSize(
+            model.center, model.radius, transform.transform_matrix,
+            camera.position, camera.projection);
+        uint32_t& lod = resources.model_lods[transform.id];
+        lod = renderer->SelectLod(screenSize, lod);
+        std::fill_n(mesh_lods_.begin() + model.first_mesh, model.mesh_count,
+                    lod);
+      }
+    }
     if (camera.does_shadow_pass) {
+      uint32_t shadowLodBias = renderer->IsMeshLodsEnabled()
+                                   ? std::max(renderer->GetShadowLodBias(), 0)
+                                   : 0;
       for (int i = 0; i < WIESEL_SHADOW_CASCADE_COUNT; ++i) {
         PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                          renderer->GetCommandBuffer().handle_,
                          "Shadow Cascade Pass");
         renderer->BeginShadowPass(i);
-        for (const auto& entity :
-             GetAllEntitiesWith<ModelComponent, TransformComponent>()) {
-          auto& model = registry_.get<ModelComponent>(entity);
-          auto& transform = registry_.get<TransformComponent>(entity);
-          if (!model.data.receive_shadows || !model.data.enable_rendering) {
+        for (size_t m = 0; m < packet.meshes.size(); m++) {
+          const RenderMesh& mesh = packet.meshes[m];
+          if (!mesh.casts_shadows) {
             continue;
           }
-          renderer->DrawModel(model, transform, true);
+          const RenderTransform& transform =
+              packet.transforms[mesh.transform_index];
+          renderer->DrawMesh(mesh.mesh, transform.transform_matrix,
+                             transform.normal_matrix, true,
+                             mesh_lods_[m] + shadowLodBias);
         }
         renderer->EndShadowPass();
       }
     }
 
-    {
+    bool impostors = renderer->IsImpostorsEnabled();
+    float impostorScreenSize = renderer->GetImpostorScreenSize();
+    auto drawGeometry = [&]() {
+      for (const RenderModel& model : packet.models) {
+        const RenderTransform& transform =
+            packet.transforms[model.transform_index];
+        if (impostors && model.impostor &&
+            model.impostor->GetScreenSize(transform.transform_matrix,
+                                          camera.position, camera.projection) <
+                impostorScreenSize) {
+          glm::vec3 extent{model.impostor->radius};
+          if (!occlusionCulling ||
+              !resources.hiz_pyramid->IsOccluded(
+                  model.impostor->center - extent,
+                  model.impostor->center + extent,
+                  transform.transform_matrix)) {
+            renderer->QueueImpostor(*model.impostor,
+                                    transform.transform_matrix);
+          }
+          continue;
+        }
+        for (uint32_t i = 0; i < model.mesh_count; i++) {
+          const RenderMesh& mesh = packet.meshes[model.first_mesh + i];
+          if (occlusionCulling &&
+              resources.hiz_pyramid->IsOccluded(mesh.bounds_min,
+                                                mesh.bounds_max,
+                                                transform.transform_matrix)) {
+            continue;
+          }
+          renderer->DrawMesh(mesh.mesh, transform.transform_matrix,
+                             transform.normal_matrix, false,
+                             mesh_lods_[model.first_mesh + i]);
+        }
+      }
+      renderer->DrawImpostors();
+    };
+    bool fusedLighting = renderer->IsFusedLightingActive();
+    if (fusedLighting) {
+      PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
+                       renderer->GetCommandBuffer().handle_,
+                       "Geometry Lighting Pass");
+      renderer->BeginGeometryLightingPass();
+      drawGeometry();
+      renderer->NextLightingSubpass();
+      renderer->GetFusedSkyboxPipeline()->Bind(PipelineBindPointGraphics);
+      if (packet.skybox) {
+        renderer->DrawSkybox(*packet.skybox);
+      }
+      renderer->GetFusedLightingPipeline()->Bind(PipelineBindPointGraphics);
+      renderer->DrawFullscreen(
+          renderer->GetFusedLightingPipeline(),
+          {resources.geometry_input_descriptor,
+           renderer->GetSSAOResultDescriptor(),
+           resources.global_descriptor});
+      renderer->EndGeometryLightingPass();
+    } else {
       PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                        renderer->GetCommandBuffer().handle_, "Geometry Pass");
       renderer->BeginGeometryPass();
-      for (const auto& entity :
-           GetAllEntitiesWith<ModelComponent, TransformComponent>()) {
-        auto& model = registry_.get<ModelComponent>(entity);
-        auto& transform = registry_.get<TransformComponent>(entity);
-        if (!model.data.enable_rendering) {
-          continue;
+      drawGeometry();
+      renderer->EndGeometryPass();
+    }
+#ifdef ID_BUFFER_PASS
+    if (renderer->GetPickCamera() == camera.resources) {
+      PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
+                       renderer->GetCommandBuffer().handle_, "ID Pass");
+      // Full meshes even where impostors were drawn, only the few pixels
+      // around the cursor are shaded
+      renderer->BeginIDPass();
+      for (const RenderModel& model : packet.models) {
+        const RenderTransform& transform =
+            packet.transforms[model.transform_index];
+        for (uint32_t i = 0; i < model.mesh_count; i++) {
+          renderer->DrawMeshID(packet.meshes[model.first_mesh + i].mesh,
+                               transform.transform_matrix,
+                               transform.normal_matrix, transform.id);
         }
-        renderer->DrawModel(model, transform, false);
       }
-      renderer->EndGeometryPass();
+      renderer->EndIDPass();
     }
-    if (renderer->IsSSAOEnabled()) {
+#endif
+    // Built on the compute queue once linear depth is no longer needed
+    bool hizOnCompute = renderer->IsOcclusionCullingEnabled() &&
+                        renderer->IsAsyncComputeActive();
+    if (renderer->IsOcclusionCullingEnabled() && !hizOnCompute) {
+      PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
+                       renderer->GetCommandBuffer().handle_, "HiZ Pass");
+      renderer->BeginHiZPass();
+      renderer->GetHiZPipeline()->Bind(PipelineBindPointGraphics);
+      renderer->DrawFullscreen(renderer->GetHiZPipeline(),
+                               {resources.hiz_input_descriptor});
+      renderer->EndHiZPass();
+      VkExtent2D hizExtent = renderer->GetHiZExtent();
+      resources.hiz_pyramid->OnRecorded(viewProjection, camera.near_plane,
+                                        camera.far_plane, hizExtent.width,
+                                        hizExtent.height);
+    }
+    bool ssao = renderer->IsSSAOEnabled() && camera.enable_ssao;
+    if (ssao) {
       {
         PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                          renderer->GetCommandBuffer().handle_, "SSAO Gen Pass");
         renderer->BeginSSAOGenPass();
-        renderer->GetSSAOGenPipeline()->Bind(PipelineBindPointGraphics);
-        renderer->DrawFullscreen(
-            renderer->GetSSAOGenPipeline(),
-            {renderer->GetCameraData()->ssao_gen_descriptor,
-             renderer->GetCameraData()->global_descriptor});
+        renderer->ExecuteStaticPass(resources.ssao_gen_commands, [&] {
+          renderer->GetSSAOGenPipeline()->Bind(PipelineBindPointGraphics);
+          renderer->DrawFullscreen(
+              renderer->GetSSAOGenPipeline(),
+              {resources.ssao_gen_descriptor,
+               resources.global_descriptor});
+        });
         renderer->EndSSAOGenPass();
       }
-      {
+      if (renderer->IsSSAOTemporalEnabled()) {
+        PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
+                         renderer->GetCommandBuffer().handle_,
+                         "SSAO Temporal Pass");
+        renderer->BeginSSAOTemporalPass();
+        renderer->ExecuteStaticPass(
+            resources.ssao_temporal_commands[resources.ssao_history_index], [&] {
+              renderer->GetSSAOTemporalPipeline()->Bind(
+                  PipelineBindPointGraphics);
+              renderer->DrawFullscreen(
+                  renderer->GetSSAOTemporalPipeline(),
+                  {resources.ssao_temporal_descriptors
+                       [resources.ssao_history_index],
+                   resources.global_descriptor});
+            });
+        renderer->EndSSAOTemporalPass();
+      } else {
         PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                          renderer->GetCommandBuffer().handle_,
                          "SSAO Blur Pass");
         renderer->BeginSSAOBlurHorzPass();
-        renderer->GetSSAOBlurHorzPipeline()->Bind(PipelineBindPointGraphics);
-        renderer->DrawFullscreen(
-            renderer->GetSSAOBlurHorzPipeline(),
-            {renderer->GetCameraData()->ssao_output_descriptor});
+        renderer->ExecuteStaticPass(resources.ssao_blur_horz_commands, [&] {
+          renderer->GetSSAOBlurHorzPipeline()->Bind(PipelineBindPointGraphics);
+          renderer->DrawFullscreen(
+              renderer->GetSSAOBlurHorzPipeline(),
+              {resources.ssao_output_descriptor,
+               resources.global_descriptor});
+        });
         renderer->EndSSAOBlurHorzPass();
         renderer->BeginSSAOBlurVertPass();
-        renderer->GetSSAOBlurVertPipeline()->Bind(PipelineBindPointGraphics);
-        renderer->DrawFullscreen(
-            renderer->GetSSAOBlurVertPipeline(),
-            {renderer->GetCameraData()->ssao_blur_horz_output_descriptor});
+        renderer->ExecuteStaticPass(resources.ssao_blur_vert_commands, [&] {
+          renderer->GetSSAOBlurVertPipeline()->Bind(PipelineBindPointGraphics);
+          renderer->DrawFullscreen(
+              renderer->GetSSAOBlurVertPipeline(),
+              {resources.ssao_blur_horz_output_descriptor,
+               resources.global_descriptor});
+        });
         renderer->EndSSAOBlurVertPass();
       }
     }
-    {
+    if (!fusedLighting) {
       PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                        renderer->GetCommandBuffer().handle_, "Lighting Pass");
       renderer->BeginLightingPass();
-      renderer->GetSkyboxPipeline()->Bind(PipelineBindPointGraphics);
-      if (skybox_) {
-        renderer->DrawSkybox(skybox_);
-      }
-      renderer->GetLightingPipeline()->Bind(PipelineBindPointGraphics);
-      renderer->DrawFullscreen(
-          renderer->GetLightingPipeline(),
-          {renderer->GetCameraData()->geometry_output_descriptor,
-           renderer->GetCameraData()->ssao_blur_vert_output_descriptor,
-           renderer->GetCameraData()->global_descriptor});
+      // Reads a different SSAO history image every frame when temporal
+      uint32_t lightingVariant =
+          renderer->IsSSAOTemporalEnabled() ? resources.ssao_history_index : 0;
+      renderer->ExecuteStaticPass(resources.lighting_commands[lightingVariant], [&] {
+        renderer->GetSkyboxPipeline()->Bind(PipelineBindPointGraphics);
+        if (packet.skybox) {
+          renderer->DrawSkybox(*packet.skybox);
+        }
+        renderer->GetLightingPipeline()->Bind(PipelineBindPointGraphics);
+        renderer->DrawFullscreen(
+            renderer->GetLightingPipeline(),
+            {resources.geometry_output_descriptor,
+             renderer->GetSSAOResultDescriptor(),
+             resources.global_descriptor});
+      });
       renderer->EndLightingPass();
     }
+    bool taa = renderer->GetAntiAliasing() == AntiAliasing::TAA;
+    if (renderer->GetAntiAliasing() != AntiAliasing::None) {
+      PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
+                       renderer->GetCommandBuffer().handle_, "Anti Aliasing Pass");
+      if (taa) {
+        // Advanced before the pass so the rest of the frame, present included,
+        // reads the image written here
+        resources.taa_history_index = (resources.taa_history_index + 1) %
+                                      resources.taa_history_images.size();
+      }
+      renderer->BeginAntiAliasingPass();
+      if (taa) {
+        renderer->ExecuteStaticPass(
+            resources.taa_commands[resources.taa_history_index], [&] {
+              renderer->GetTAAPipeline()->Bind(PipelineBindPointGraphics);
+              renderer->DrawFullscreen(
+                  renderer->GetTAAPipeline(),
+                  {resources.taa_descriptors[resources.taa_history_index],
+                   resources.global_descriptor});
+            });
+      } else {
+        renderer->ExecuteStaticPass(resources.fxaa_commands, [&] {
+          renderer->GetFXAAPipeline()->Bind(PipelineBindPointGraphics);
+          renderer->DrawFullscreen(
+              renderer->GetFXAAPipeline(),
+              {resources.lighting_output_descriptor,
+               resources.global_descriptor});
+        });
+      }
+      renderer->EndAntiAliasingPass();
+    }
     {
       PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                        renderer->GetCommandBuffer().handle_, "Sprite Pass");
       renderer->BeginSpritePass();
       renderer->GetSpritePipeline()->Bind(PipelineBindPointGraphics);
-      for (const auto& entity :
-           GetAllEntitiesWith<SpriteComponent, TransformComponent>()) {
-        auto& sprite = registry_.get<SpriteComponent>(entity);
-        auto& transform = registry_.get<TransformComponent>(entity);
-        renderer->DrawSprite(sprite, transform);
+      for (const RenderSprite& sprite : packet.sprites) {
+        renderer->DrawSprite(
+            *sprite.sprite, sprite.frame_index,
+            packet.transforms[sprite.transform_index].transform_matrix);
       }
       renderer->EndSpritePass();
     }
-    {
+    if (!renderer->IsCompositeInPresent()) {
       PROFILE_GPU_ZONE(renderer->GetTracyCtx(),
                        renderer->GetCommandBuffer().handle_, "Composite Pass");
       renderer->BeginCompositePass();
-      renderer->GetCompositePipeline()->Bind(PipelineBindPointGraphics);
+      uint32_t compositeVariant = 0;
       if (renderer->IsOnlySSAO()) {
-        renderer->DrawFullscreen(
-            renderer->GetCompositePipeline(),
-            {renderer->GetCameraData()->ssao_blur_vert_output_descriptor});
-      } else {
-        renderer->DrawFullscreen(
-            renderer->GetCompositePipeline(),
-            {renderer->GetCameraData()->lighting_output_descriptor});
-        renderer->DrawFullscreen(
-            renderer->GetCompositePipeline(),
-            {renderer->GetCameraData()->sprite_output_descriptor});
+        compositeVariant = renderer->IsSSAOTemporalEnabled()
+                               ? resources.ssao_history_index
+                               : 0;
+      } else if (taa) {
+        compositeVariant = resources.taa_history_index;
       }
+      renderer->ExecuteStaticPass(resources.composite_commands[compositeVariant], [&] {
+        renderer->GetCompositePipeline()->Bind(PipelineBindPointGraphics);
+        if (renderer->IsOnlySSAO()) {
+          renderer->DrawFullscreen(
+              renderer->GetCompositePipeline(),
+              {renderer->GetSSAOResultDescriptor()});
+        } else {
+          renderer->DrawFullscreen(
+              renderer->GetCompositePipeline(),
+              {renderer->GetSceneColorDescriptor()});
+          renderer->DrawFullscreen(
+              renderer->GetCompositePipeline(),
+              {resources.sprite_output_descriptor});
+        }
+      });
       renderer->EndCompositePass();
     }
-    hasCamera = true;
+    if (hizOnCompute) {
+      renderer->SubmitHiZCompute();
+      VkExtent2D hizExtent = renderer->GetHiZExtent();
+      resources.hiz_pyramid->OnRecorded(viewProjection, camera.near_plane,
+                                        camera.far_plane, hizExtent.width,
+                                        hizExtent.height);
+    }
+    if (ssao && renderer->IsSSAOTemporalEnabled()) {
+      resources.ssao_history_index = (resources.ssao_history_index + 1) %
+                                     resources.ssao_history_images.size();
+      resources.previous_view_projection = viewProjection;
+    } else if (taa) {
+      resources.previous_view_projection = viewProjection;
+    } else {
+      // History goes stale while nothing accumulates into it
+      resources.previous_view_projection = glm::mat4{0.0f};
+    }
   }
-  return hasCamera;
+  return !packet.cameras.empty();
 }
 
 }  // namespace Wiesel
\ No newline at end of file
@@ -88,4 +88,22 @@ bool DecomposeTransform(const glm::mat4& transform, glm::vec3& translation,
   return true;
 }
 
+float GetScreenSize(const glm::vec3& center, float radius,
+                    const glm::mat4& transform_matrix,
+                    const glm::vec3& camera_position,
+                    const glm::mat4& projection) {
+  glm::vec3 worldCenter = transform_matrix * glm::vec4(center, 1.0f);
+  float scale = std::max({glm::length(glm::vec3(transform_matrix[0])),
+                          glm::length(glm::vec3(transform_matrix[1])),
+                          glm::length(glm::vec3(transform_matrix[2]))});
+  float worldRadius = radius * scale;
+  float distance = glm::length(worldCenter - camera_position);
+  if (distance <= worldRadius) {
+    // Camera is inside the bounds
+    return std::numeric_limits<float>::max();
+  }
+  // projection[1][1] is negative since y is flipped
+  return worldRadius * std::abs(projection[1][1]) / distance;
+}
+
 }  // namespace Wiesel::Math
\ No newline at end of file
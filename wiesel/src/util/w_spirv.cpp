@@ -137,6 +137,9 @@ EShLanguage FindLanguage(ShaderType type) {
     case ShaderTypeFragment: {
       return EShLangFragment;
     }
+    case ShaderTypeCompute: {
+      return EShLangCompute;
+    }
     default: {
       throw std::runtime_error("Shader stage is not implemented yet");
     }
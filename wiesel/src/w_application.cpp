@@ -25,6 +25,7 @@ Application::Application(const WindowProperties&& window_props, const RendererPr
   layer_counter_ = 0;
   is_running_ = true;
   is_minimized_ = false;
+  window_resized_ = false;
 
   Engine::InitWindow(std::move(window_props));
   window_ = Engine::GetWindow();
@@ -56,6 +57,10 @@ void Application::OnEvent(Event& event) {
   dispatcher.Dispatch<WindowResizeEvent>(WIESEL_BIND_FN(OnWindowResize));
 
   InputManager::OnEvent(event);
+  DispatchToLayers(event);
+}
+
+void Application::DispatchToLayers(Event& event) {
   if (event.m_Handled) {
     return;
   }
@@ -128,18 +133,34 @@ void Application::Run() {
     window_->OnUpdate();
 
     if (window_resized_) {
-      window_->GetWindowFramebufferSize(window_size_);
-      if (window_size_.width == 0 || window_size_.height == 0) {
-        is_minimized_ = true;
-      } else {
-        is_minimized_ = false;
-        renderer->RecreateSwapChain();
-      }
-      window_resized_ = false;
+      UpdatePendingResize(renderer);
     }
   }
 }
 
+void Application::UpdatePendingResize(const Ref<Renderer>& renderer) {
+  window_->GetWindowFramebufferSize(window_size_);
+  if (window_size_.width == 0 || window_size_.height == 0) {
+    is_minimized_ = true;
+    return;
+  }
+  // Keep presenting at the old size while the window is being dragged, the
+  // swap chain is only recreated once the size stopped changing. Restoring
+  // from minimized has nothing on screen to keep, so it doesn't wait.
+  resize_settle_timer_ += delta_time_;
+  if (!is_minimized_ && resize_settle_timer_ < WIESEL_RESIZE_DEBOUNCE_TIME) {
+    return;
+  }
+  is_minimized_ = false;
+  window_resized_ = false;
+  renderer->RecreateSwapChain();
+
+  WindowResizeEvent event(
+      pending_resize_size_,
+      pending_resize_size_.width / (float)pending_resize_size_.height);
+  DispatchToLayers(event);
+}
+
 void Application::Close() {
   LOG_INFO("Closing the application!");
   is_running_ = false;
@@ -151,8 +172,11 @@ bool Application::OnWindowClose(WindowCloseEvent& event) {
 }
 
 bool Application::OnWindowResize(WindowResizeEvent& event) {
+  // Layers get the event once the resize settled, see UpdatePendingResize
   window_resized_ = true;
-  return false;
+  pending_resize_size_ = event.window_size();
+  resize_settle_timer_ = 0.0f;
+  return true;
 }
 
 Ref<AppWindow> Application::GetWindow() {
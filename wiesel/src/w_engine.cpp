@@ -12,6 +12,7 @@
 #include "w_engine.hpp"
 
 #include "input/w_input.hpp"
+#include "rendering/w_meshoptimizer.hpp"
 #include "scene/w_componentutil.hpp"
 #include "scene/w_lights.hpp"
 #include "util/w_dialogs.hpp"
@@ -33,6 +34,8 @@ void EnableAnsiColors() {
 namespace Wiesel {
 Ref<Renderer> Engine::kRenderer;
 Ref<AppWindow> Engine::kWindow;
+bool Engine::kMeshOptimization = true;
+bool Engine::kLodGeneration = true;
 
 void Engine::InitEngine() {
   LOG_INFO("Current work directory: {}", std::filesystem::current_path().string());
@@ -76,14 +79,14 @@ void Engine::CleanupEngine() {
   //CleanupComponents();
 }
 
-std::shared_ptr<Renderer> Engine::GetRenderer() {
+const std::shared_ptr<Renderer>& Engine::GetRenderer() {
   if (kRenderer == nullptr) {
     throw std::runtime_error("Renderer is not initialized!");
   }
   return kRenderer;
 }
 
-std::shared_ptr<AppWindow> Engine::GetWindow() {
+const std::shared_ptr<AppWindow>& Engine::GetWindow() {
   return kWindow;
 }
 
@@ -140,6 +143,11 @@ void Engine::LoadModel(aiScene* scene, Wiesel::TransformComponent& transform,
     item->Allocate();
     vertices += item->vertices.size();
   }
+  modelComponent.data.impostor = nullptr;
+  if (modelComponent.data.enable_impostor) {
+    modelComponent.data.impostor =
+        GetRenderer()->GetOrCreateImpostor(modelComponent.data);
+  }
   LOG_INFO("Loaded {} meshes!", modelComponent.data.meshes.size());
   LOG_INFO("Loaded {} textures!", modelComponent.data.textures.size());
   LOG_INFO("Loaded {} vertices!", vertices);
@@ -280,19 +288,13 @@ std::shared_ptr<Mesh> Engine::ProcessMesh(Model& model, aiMesh* aiMesh,
 
   std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
   // todo handle materials properly within another class
-  uint32_t flags = 0;
-  flags |= VertexFlagHasTexture *
-           LoadTexture(model, mesh, material, aiTextureType_DIFFUSE, aiScene);
-  flags |= VertexFlagHasNormalMap *
-           LoadTexture(model, mesh, material, aiTextureType_NORMALS, aiScene);
-  flags |= VertexFlagHasSpecularMap *
-           LoadTexture(model, mesh, material, aiTextureType_SPECULAR, aiScene);
-  flags |= VertexFlagHasAlbedoMap *
-           LoadTexture(model, mesh, material, aiTextureType_BASE_COLOR, aiScene);
-  flags |= VertexFlagHasRoughnessMap *
-           LoadTexture(model, mesh, material, aiTextureType_DIFFUSE_ROUGHNESS, aiScene);
-  flags |= VertexFlagHasMetallicMap *
-           LoadTexture(model, mesh, material, aiTextureType_METALNESS, aiScene);
+  // Material::Set keeps the material flags in sync with what gets loaded
+  LoadTexture(model, mesh, material, aiTextureType_DIFFUSE, aiScene);
+  LoadTexture(model, mesh, material, aiTextureType_NORMALS, aiScene);
+  LoadTexture(model, mesh, material, aiTextureType_SPECULAR, aiScene);
+  LoadTexture(model, mesh, material, aiTextureType_BASE_COLOR, aiScene);
+  LoadTexture(model, mesh, material, aiTextureType_DIFFUSE_ROUGHNESS, aiScene);
+  LoadTexture(model, mesh, material, aiTextureType_METALNESS, aiScene);
 
   bool has_unsupported_textures = false;
   for (size_t type = aiTextureType_NONE; type < AI_TEXTURE_TYPE_MAX; type++) {
@@ -334,7 +336,6 @@ std::shared_ptr<Mesh> Engine::ProcessMesh(Model& model, aiMesh* aiMesh,
     } else {
       vertex.UV = glm::vec2(0.0f, 0.0f);
     }
-    vertex.Flags = flags;
 
     vertex.Color = {1.0f, 1.0f, 1.0f};
 
@@ -368,6 +369,14 @@ std::shared_ptr<Mesh> Engine::ProcessMesh(Model& model, aiMesh* aiMesh,
     }
   }
 
+  if (kMeshOptimization) {
+    MeshOptimizer::Optimize(mesh->vertices, mesh->indices);
+  }
+  if (kLodGeneration) {
+    MeshOptimizer::GenerateLods(mesh->vertices, mesh->indices,
+                                mesh->lod_indices);
+  }
+
   return mesh;
 }
 void Engine::ProcessNode(Model& model, aiNode* node, const aiScene& scene,
@@ -0,0 +1,106 @@
+
+//
+//    Copyright 2023 Metehan Gezer
+//
+//     Licensed under the Apache License, Version 2.0 (the "License");
+//     you may not use this file except in compliance with the License.
+//     You may obtain a copy of the License at
+//
+//         http://www.apache.org/licenses/LICENSE-2.0
+//
+
+// Packs compiled SPIR-V permutations into the file read by ShaderLibrary.
+// Usage: wiesel-shaderpack <output> <key>=<spv>...
+// Keys sharing a spv file share its code in the library too.
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr char kMagic[4] = {'W', 'S', 'H', 'L'};
+constexpr uint32_t kVersion = 1;
+
+struct Entry {
+  std::string key;
+  uint32_t offset;
+  uint32_t size;
+};
+
+bool ReadWords(const std::string& path, std::vector<uint32_t>& words) {
+  std::ifstream file(path, std::ios::ate | std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  size_t size = file.tellg();
+  if (size % sizeof(uint32_t) != 0) {
+    return false;
+  }
+  words.resize(size / sizeof(uint32_t));
+  file.seekg(0);
+  return static_cast<bool>(
+      file.read(reinterpret_cast<char*>(words.data()), size));
+}
+
+void WriteU32(std::ofstream& file, uint32_t value) {
+  file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <output> <key>=<spv>...\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<Entry> entries;
+  std::vector<uint32_t> code;
+  std::map<std::string, Entry> packed;
+  for (int i = 2; i < argc; i++) {
+    std::string arg = argv[i];
+    size_t split = arg.rfind('=');
+    if (split == std::string::npos) {
+      fprintf(stderr, "invalid argument: %s\n", arg.c_str());
+      return 1;
+    }
+    std::string key = arg.substr(0, split);
+    std::string path = arg.substr(split + 1);
+
+    auto it = packed.find(path);
+    if (it == packed.end()) {
+      std::vector<uint32_t> words;
+      if (!ReadWords(path, words)) {
+        fprintf(stderr, "failed to read spirv: %s\n", path.c_str());
+        return 1;
+      }
+      Entry entry{"", static_cast<uint32_t>(code.size()),
+                  static_cast<uint32_t>(words.size())};
+      code.insert(code.end(), words.begin(), words.end());
+      it = packed.emplace(path, entry).first;
+    }
+    entries.push_back({key, it->second.offset, it->second.size});
+  }
+
+  std::ofstream file(argv[1], std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    fprintf(stderr, "failed to open output: %s\n", argv[1]);
+    return 1;
+  }
+  file.write(kMagic, sizeof(kMagic));
+  WriteU32(file, kVersion);
+  WriteU32(file, static_cast<uint32_t>(entries.size()));
+  for (const auto& entry : entries) {
+    WriteU32(file, static_cast<uint32_t>(entry.key.size()));
+    file.write(entry.key.data(), entry.key.size());
+    WriteU32(file, entry.offset);
+    WriteU32(file, entry.size);
+  }
+  file.write(reinterpret_cast<const char*>(code.data()),
+             code.size() * sizeof(uint32_t));
+  return file ? 0 : 1;
+}